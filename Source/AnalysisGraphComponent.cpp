@@ -19,9 +19,110 @@ AnalysisGraphComponent::AnalysisGraphComponent(
  * @brief リサイズハンドラ
  */
 void AnalysisGraphComponent::resized() {
+    requestDisplayResolution();
+    pathsDirty = true;
     repaint();
 }
 
+/**
+ * @brief 表示スペクトルが更新されている場合のみ再描画
+ */
+void AnalysisGraphComponent::refresh() {
+    // スコープのフレームだけが変わった解析結果では再描画しない
+    const auto snapshot = analysisService.getAnalysisSnapshot();
+    if (shownSnapshot == nullptr || snapshot->display.version != shownSnapshot->display.version)
+        repaint();
+}
+
+/**
+ * @brief 位相グラフの表示状態を設定
+ * @param shouldShowPhase trueの場合は位相、falseの場合は振幅を表示
+ */
+void AnalysisGraphComponent::setShowPhase(bool shouldShowPhase) {
+    showPhase = shouldShowPhase;
+    updateCurves();
+    repaint();
+}
+
+/**
+ * @brief マウスホイールでカーソル位置を中心に周波数軸を拡大・縮小
+ * @param event マウスイベント
+ * @param wheel ホイールの移動量
+ */
+void AnalysisGraphComponent::mouseWheelMove(const juce::MouseEvent& event,
+                                            const juce::MouseWheelDetails& wheel) {
+    const auto width = (float)getWidth();
+    const auto anchor = std::log(getFrequencyForX(event.position.x, width));
+    const auto fullSpan = std::log(20000.0f / 20.0f);
+    auto low = std::log(viewMinFrequency);
+    auto high = std::log(viewMaxFrequency);
+    // 最大で1オクターブまで拡大
+    const auto scale = std::exp(-wheel.deltaY * 2.0f);
+    const auto span = juce::jlimit(std::log(2.0f), fullSpan, (high - low) * scale);
+    const auto ratio = (anchor - low) / (high - low);
+    low = juce::jlimit(std::log(20.0f), std::log(20000.0f) - span, anchor - ratio * span);
+    high = low + span;
+    viewMinFrequency = std::exp(low);
+    viewMaxFrequency = std::exp(high);
+    requestDisplayResolution();
+    pathsDirty = true;
+    repaint();
+}
+
+/**
+ * @brief ダブルクリックで周波数軸の表示範囲を20 Hz〜20 kHzに戻す
+ * @param event マウスイベント
+ */
+void AnalysisGraphComponent::mouseDoubleClick(const juce::MouseEvent&) {
+    viewMinFrequency = 20.0f;
+    viewMaxFrequency = 20000.0f;
+    requestDisplayResolution();
+    pathsDirty = true;
+    repaint();
+}
+
+/**
+ * @brief 表示範囲の1ピクセルに1点以上が入るよう表示スペクトルの点数を要求
+ */
+void AnalysisGraphComponent::requestDisplayResolution() {
+    // 表示スペクトルは解析スレッドが20 Hz〜20 kHzの対数間隔で作成する
+    const auto zoom = std::log(20000.0f / 20.0f) / std::log(viewMaxFrequency / viewMinFrequency);
+    analysisService.setDisplayResolution(juce::jmax(2, juce::roundToInt(getWidth() * zoom)));
+}
+
+/**
+ * @brief 表示中の解析結果から描画する曲線のピラミッドを作成
+ */
+void AnalysisGraphComponent::updateCurves() {
+    curves.clear();
+    pathsDirty = true;
+    if (shownSnapshot == nullptr)
+        return;
+
+    const auto& display = shownSnapshot->display;
+    auto add = [this, &display](const std::vector<float>& data, juce::Colour colour) {
+        if (data.empty() || data.size() != display.frequencies.size())
+            return;
+        curves.emplace_back();
+        curves.back().pyramid.build(data);
+        curves.back().colour = colour;
+    };
+    if (showPhase) {
+        add(display.phaseR, juce::Colour(0xffff6b35));
+        add(display.phaseL, curveColour);
+    }
+    else {
+        // Hammerstein測定のH2..H10（基本波周波数に対する高調波レベル）
+        const auto& harmonics = display.harmonicResponses;
+        for (size_t harmonic = 1; harmonic < harmonics.size(); ++harmonic) {
+            const auto hue = static_cast<float>(harmonic) / static_cast<float>(harmonics.size());
+            add(harmonics[harmonic], juce::Colour::fromHSV(hue, 0.6f, 0.9f, 0.7f));
+        }
+        add(display.magnitudeR, juce::Colour(0xffff6b35));
+        add(display.magnitudeL, curveColour);
+    }
+}
+
 /**
  * @brief グラフ描画
  * @param g グラフィックスコンテキスト
@@ -40,25 +141,18 @@ void AnalysisGraphComponent::paint(juce::Graphics& g) {
     drawGrid(g);
     
 	// 位相/振幅スペクトルを描画
-    const auto snapshot = analysisService.getAnalysisSnapshot();
-    if (showPhase) {
-        const auto& spectrumR = snapshot->phaseSpectrumR;
-        if (!spectrumR.empty())
-            drawCurve(g, spectrumR, juce::Colour(0xffff6b35), -juce::MathConstants<float>::pi, juce::MathConstants<float>::pi, snapshot->sampleRate);
-
-        const auto& spectrumL = snapshot->phaseSpectrumL;
-        if (!spectrumL.empty())
-            drawCurve(g, spectrumL, curveColour, -juce::MathConstants<float>::pi, juce::MathConstants<float>::pi, snapshot->sampleRate);
+    auto snapshot = analysisService.getAnalysisSnapshot();
+    if (shownSnapshot == nullptr || snapshot->display.version != shownSnapshot->display.version) {
+        shownSnapshot = std::move(snapshot);
+        updateCurves();
     }
-    else {
-        const auto& spectrumR = snapshot->magnitudeSpectrumR;
-        if (!spectrumR.empty())
-            drawCurve(g, spectrumR, juce::Colour(0xffff6b35), -100.0f, 20.0f, snapshot->sampleRate);
-
-        const auto& spectrumL = snapshot->magnitudeSpectrumL;
-        if (!spectrumL.empty())
-            drawCurve(g, spectrumL, curveColour, -100.0f, 20.0f, snapshot->sampleRate);
+    if (pathsDirty) {
+        for (auto& curve : curves)
+            buildPath(curve);
+        pathsDirty = false;
     }
+    for (const auto& curve : curves)
+        drawCurve(g, curve);
     
 	// プラグイン未ロード時のメッセージ表示
     if (analysisService.getPluginDisplayName() == "No Plugin Loaded") {
@@ -146,71 +240,73 @@ void AnalysisGraphComponent::drawGrid(juce::Graphics& g) {
 }
 
 /**
- * @brief スペクトル曲線描画
- * @param g グラフィックスコンテキスト
- * @param data スペクトルデータ配列
- * @param colour 曲線色
- * @param minVal Y軸最小値
- * @param maxVal Y軸最大値
+ * @brief 曲線のパスを作成
+ *
+ * 表示範囲の点数が幅を超える場合は、1ピクセルあたり1要素以下になる
+ * ピラミッドのレベルを選び、各要素の最小値と最大値を頂点にする。
+ * @param curve 対象の曲線
  */
-void AnalysisGraphComponent::drawCurve(juce::Graphics& g, const std::vector<float>& data,
-                                       juce::Colour colour, float minVal, float maxVal,
-                                       double sampleRate) {
-    if (data.empty())
+void AnalysisGraphComponent::buildPath(Curve& curve) {
+    curve.path.clear();
+    const auto& frequencies = shownSnapshot->display.frequencies;
+    const auto numPoints = (int)curve.pyramid.getNumPoints();
+    if (numPoints < 2)
         return;
 
-    // 平滑化
-    std::vector<float> smoothed = data;
-    int smoothSize = 8;
-    
-    if (!showPhase) {
-        for (size_t i = 0; i < smoothed.size(); ++i) {
-            float sum = 0.0f;
-            int count = 0;
-            for (int k = -smoothSize; k <= smoothSize; ++k) {
-                int idx = (int)i + k;
-                if (idx >= 0 && idx < (int)data.size()) {
-                    sum += data[idx];
-                    count++;
-                }
-            }
-            if (count > 0)
-                smoothed[i] = sum / count;
-        }
-    }
-
-    juce::Path p;
     auto w = (float)getWidth();
     auto h = (float)getHeight();
-    float nyquist = static_cast<float>(sampleRate * 0.5);
-    int numBins = (int)smoothed.size();
-    bool started = false;
-
-    for (int i = 1; i < numBins; ++i) {
-        float freq = (float)i / (float)numBins * nyquist;
-        float x = getXForFrequency(freq, w);
-        float val = smoothed[i];
-        float y = juce::jmap(val, minVal, maxVal, h, 0.0f);
+    const auto minVal = showPhase ? -juce::MathConstants<float>::pi : -100.0f;
+    const auto maxVal = showPhase ? juce::MathConstants<float>::pi : 20.0f;
 
-        if (y > h) 
-            y = h;
+    // 表示点は20 Hz〜20 kHzの対数間隔
+    const auto span = std::log(frequencies.back() / frequencies.front());
+    auto indexFor = [&](float freq) {
+        return (float)(numPoints - 1) * std::log(freq / frequencies.front()) / span;
+    };
+    const auto first = juce::jlimit(0, numPoints - 1, (int)std::floor(indexFor(viewMinFrequency)));
+    const auto last = juce::jlimit(0, numPoints - 1, (int)std::ceil(indexFor(viewMaxFrequency)));
+    const auto level = curve.pyramid.chooseLevel((double)(last - first + 1) / juce::jmax(1.0f, w));
+    const auto& entries = curve.pyramid.getLevel(level);
+    const auto step = 1 << level;
 
-        if (y < 0)
-            y = 0;
+    bool started = false;
+    float previous = 0.0f;
+    auto addVertex = [&](float x, float val) {
+        const auto y = juce::jlimit(0.0f, h, juce::jmap(val, minVal, maxVal, h, 0.0f));
+        if (!started || (showPhase && std::abs(val - previous) > juce::MathConstants<float>::pi))
+            curve.path.startNewSubPath(x, y);
+        else
+            curve.path.lineTo(x, y);
+        started = true;
+        previous = val;
+    };
 
-        if (!started) {
-            p.startNewSubPath(x, y);
-            started = true;
+    for (int entry = first / step; entry <= last / step; ++entry) {
+        const auto centre = juce::jmin(numPoints - 1, entry * step + step / 2);
+        const auto x = getXForFrequency(frequencies[(size_t)centre], w);
+        const auto& value = entries[(size_t)entry];
+        if (value.minimum == value.maximum) {
+            addVertex(x, value.minimum);
+        }
+        else if (std::abs(value.minimum - previous) < std::abs(value.maximum - previous)) {
+            addVertex(x, value.minimum);
+            addVertex(x, value.maximum);
         }
         else {
-            if (showPhase && i > 0 && std::abs(val - smoothed[i-1]) > juce::MathConstants<float>::pi) {
-                 p.startNewSubPath(x, y);
-            }
-            else {
-                p.lineTo(x, y);
-            }
+            addVertex(x, value.maximum);
+            addVertex(x, value.minimum);
         }
     }
+}
+
+/**
+ * @brief キャッシュ済みの曲線を描画
+ * @param g グラフィックスコンテキスト
+ * @param curve 描画する曲線
+ */
+void AnalysisGraphComponent::drawCurve(juce::Graphics& g, const Curve& curve) {
+    const auto& p = curve.path;
+    const auto colour = curve.colour;
 
     // グロー
     g.setColour(colour.withAlpha(0.15f));
@@ -233,18 +329,21 @@ void AnalysisGraphComponent::drawCurve(juce::Graphics& g, const std::vector<floa
  * @brief 周波数からX座標を取得（対数スケール）
  * @param freq 周波数
  * @param width コンポーネント幅
- * @return X座標
+ * @return X座標。表示範囲外の周波数は0未満または幅を超える
  */
 float AnalysisGraphComponent::getXForFrequency(float freq, float width) const {
 	// 対数スケール変換
-    float minF = 20.0f;
-    float maxF = 20000.0f;
-    
-    if (freq < minF) 
-        return -1.0f;
-    if (freq > maxF) 
-        return width + 1.0f;
-    
-    float norm = (std::log10(freq) - std::log10(minF)) / (std::log10(maxF) - std::log10(minF));
+    float norm = std::log(freq / viewMinFrequency) / std::log(viewMaxFrequency / viewMinFrequency);
     return norm * width;
 }
+
+/**
+ * @brief X座標から周波数を取得（対数スケール）
+ * @param x X座標
+ * @param width コンポーネント幅
+ * @return 周波数
+ */
+float AnalysisGraphComponent::getFrequencyForX(float x, float width) const {
+    const auto norm = juce::jlimit(0.0f, 1.0f, x / juce::jmax(1.0f, width));
+    return viewMinFrequency * std::pow(viewMaxFrequency / viewMinFrequency, norm);
+}
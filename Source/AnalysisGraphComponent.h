@@ -2,6 +2,7 @@
 
 #include <JuceHeader.h>
 #include "Application/AnalysisService.h"
+#include "CurvePyramid.h"
 
 class AnalysisGraphComponent : public juce::Component
 {
@@ -14,19 +15,44 @@ public:
 
     void paint(juce::Graphics& g) override;
     void resized() override;
+    void mouseWheelMove(const juce::MouseEvent& event, const juce::MouseWheelDetails& wheel) override;
+    void mouseDoubleClick(const juce::MouseEvent& event) override;
+
+    /**
+     * @brief 新しい解析結果が公開されている場合のみ再描画
+     */
+    void refresh();
 
     /**
      * @brief 位相グラフの表示状態を設定
      * @param shouldShowPhase trueの場合は位相、falseの場合は振幅を表示
      */
-    void setShowPhase(bool shouldShowPhase) { showPhase = shouldShowPhase; repaint(); }
+    void setShowPhase(bool shouldShowPhase);
 
 private:
+    // Paths are rebuilt only when a new snapshot arrives or the view changes;
+    // repaints in between stroke the cached paths.
+    struct Curve
+    {
+        CurvePyramid pyramid;
+        juce::Colour colour;
+        juce::Path path;
+    };
+
     plugin_analyzer::application::AnalysisService& analysisService;
     bool showPhase = false;
+    std::shared_ptr<const plugin_analyzer::domain::AnalysisSnapshot> shownSnapshot;
+    std::vector<Curve> curves;
+    bool pathsDirty = true;
+    float viewMinFrequency = 20.0f;
+    float viewMaxFrequency = 20000.0f;
 
     // ヘルパ
     float getXForFrequency(float freq, float width) const;
+    float getFrequencyForX(float x, float width) const;
+    void requestDisplayResolution();
+    void updateCurves();
+    void buildPath(Curve& curve);
     
     // 色
     const juce::Colour backgroundColour = juce::Colour(0xff0d0d0d);
@@ -36,8 +62,7 @@ private:
 
     void drawGrid(juce::Graphics& g);
     void drawResponse(juce::Graphics& g);
-    void drawCurve(juce::Graphics& g, const std::vector<float>& data, juce::Colour colour,
-                   float minVal, float maxVal, double sampleRate);
+    void drawCurve(juce::Graphics& g, const Curve& curve);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AnalysisGraphComponent)
 };
@@ -1,11 +1,28 @@
 #include "AnalyzerEngine.h"
+#include "BlockTimer.h"
+#include "SpectrumKernels.h"
 #include <algorithm>
 #include <complex>
 
 namespace
 {
+using plugin_analyzer::domain::MultitonePlanner;
+
 constexpr double imdLowFrequency = 250.0;
 constexpr double imdHighFrequency = 8000.0;
+constexpr double hammersteinStartFrequency = 20.0;
+constexpr double hammersteinSweepSeconds = 5.0;
+constexpr double hammersteinTailSeconds = 0.25;
+
+/**
+ * @brief Hammerstein測定のスイープ終了周波数を取得
+ * @param sampleRate サンプリング周波数
+ * @return ナイキスト周波数より低い終了周波数
+ */
+double hammersteinEndFrequency(double sampleRate)
+{
+    return juce::jmin(20000.0, 0.45 * sampleRate);
+}
 
 /**
  * @brief 
@@ -14,7 +31,9 @@ constexpr double imdHighFrequency = 8000.0;
  */
 bool modeRunsContinuously(AnalyzerEngine::AnalysisMode mode)
 {
-    return mode != AnalyzerEngine::AnalysisMode::Linear;
+    return mode != AnalyzerEngine::AnalysisMode::Linear
+        && mode != AnalyzerEngine::AnalysisMode::Hammerstein
+        && mode != AnalyzerEngine::AnalysisMode::THDSweep;
 }
 
 /**
@@ -42,22 +61,6 @@ double quantiseToFFTBin(double frequency, double sampleRate, int fftSize)
     return bin * sampleRate / fftSize;
 }
 
-/**
- * @brief 
- * @param sortedValues
- * @param proportion
- * @return 
- */
-float percentile(const std::vector<float>& sortedValues, double proportion)
-{
-    if (sortedValues.empty())
-        return 0.0f;
-    const auto position = proportion * static_cast<double>(sortedValues.size() - 1);
-    const auto lower = static_cast<size_t>(std::floor(position));
-    const auto upper = juce::jmin(lower + 1, sortedValues.size() - 1);
-    const auto fraction = static_cast<float>(position - static_cast<double>(lower));
-    return sortedValues[lower] + fraction * (sortedValues[upper] - sortedValues[lower]);
-}
 }
 
 AnalyzerEngine::AnalyzerEngine()
@@ -76,9 +79,13 @@ AnalyzerEngine::AnalyzerEngine()
     formatManager.addFormat(std::make_unique<juce::LV2PluginFormat>());
 #endif
 
-    analysisQueue.resize(analysisFifoSize);
-    scopeData.resize(scopeFifoSize, 0.0f);
+    analysisInput.resize(analysisFifoSize);
+    analysisOutputL.resize(analysisFifoSize);
+    analysisOutputR.resize(analysisFifoSize);
     workerResult.harmonicLevels.resize(10, 0.0f);
+    markSnapshotChanged();
+    // Builds every multitone table now; the audio thread must not allocate.
+    juce::ignoreUnused(MultitonePlanner::forOrder(workerFFTOrder));
     configureWorkerFFT(workerFFTOrder);
     publishSnapshot();
     startThread(juce::Thread::Priority::normal);
@@ -98,26 +105,34 @@ AnalyzerEngine::~AnalyzerEngine()
  */
 void AnalyzerEngine::configureWorkerFFT(int order)
 {
-    workerFFTOrder = juce::jlimit(8, 15, order);
+    workerFFTOrder = juce::jlimit(minFFTOrder, maxFFTOrder, order);
     workerFFTSize = 1 << workerFFTOrder;
-    forwardFFT = std::make_unique<juce::dsp::FFT>(workerFFTOrder);
-    window = std::make_unique<juce::dsp::WindowingFunction<float>>(
-        workerFFTSize, juce::dsp::WindowingFunction<float>::hann);
+    const auto& plan = fftPlans.get(workerFFTOrder);
+    forwardFFT = plan.fft.get();
+    window = &plan.window;
     complexDataL.assign(static_cast<size_t>(workerFFTSize * 2), 0.0f);
     complexDataR.assign(static_cast<size_t>(workerFFTSize * 2), 0.0f);
     complexInput.assign(static_cast<size_t>(workerFFTSize * 2), 0.0f);
-    accumulationBufferInput.assign(static_cast<size_t>(workerFFTSize), 0.0f);
-    accumulationBufferL.assign(static_cast<size_t>(workerFFTSize), 0.0f);
-    accumulationBufferR.assign(static_cast<size_t>(workerFFTSize), 0.0f);
+    displaySpectrumL.assign(static_cast<size_t>(workerFFTSize), 0.0f);
+    displaySpectrumR.assign(static_cast<size_t>(workerFFTSize), 0.0f);
+    powerPrefixSumL.assign(static_cast<size_t>(workerFFTSize / 2 + 1), 0.0);
+    latencyRotation.assign(static_cast<size_t>(workerFFTSize), 0.0f);
+    latencyRotationSamples = -1;
     averagedInputPower.assign(static_cast<size_t>(workerFFTSize / 2), 0.0);
     averagedOutputPowerL.assign(static_cast<size_t>(workerFFTSize / 2), 0.0);
     averagedOutputPowerR.assign(static_cast<size_t>(workerFFTSize / 2), 0.0);
-    workerResult.magnitudeSpectrumL.assign(static_cast<size_t>(workerFFTSize / 2), -120.0f);
-    workerResult.magnitudeSpectrumR.assign(static_cast<size_t>(workerFFTSize / 2), -120.0f);
-    workerResult.phaseSpectrumL.assign(static_cast<size_t>(workerFFTSize / 2), 0.0f);
-    workerResult.phaseSpectrumR.assign(static_cast<size_t>(workerFFTSize / 2), 0.0f);
+    multitoneToneBins.assign(static_cast<size_t>(workerFFTSize / 2), false);
+    workerResult.spectrumDecimation = juce::jmax(1, workerFFTSize / 2 / maxPublishedBins);
+    const auto published = static_cast<size_t>(workerFFTSize / 2 / workerResult.spectrumDecimation);
+    decimatedSpectrum.assign(published * 2, 0.0f);
+    workerResult.magnitudeSpectrumL.assign(published, -120.0f);
+    workerResult.magnitudeSpectrumR.assign(published, -120.0f);
+    workerResult.phaseSpectrumL.assign(published, 0.0f);
+    workerResult.phaseSpectrumR.assign(published, 0.0f);
     accumulationIndex = 0;
     spectralAverageCount = 0;
+    updateDisplaySpectra();
+    markSnapshotChanged(SnapshotSection::Spectrum);
 }
 
 /**
@@ -187,7 +202,7 @@ void AnalyzerEngine::setBlockSize(int newBlockSize)
  */
 void AnalyzerEngine::setFFTOrder(int order)
 {
-    if (order < 8 || order > 15)
+    if (order < minFFTOrder || order > maxFFTOrder)
         return;
     requestedFFTOrder.store(order, std::memory_order_release);
     requestedGeneration.fetch_add(1, std::memory_order_acq_rel);
@@ -270,7 +285,7 @@ bool AnalyzerEngine::loadProcessor(std::unique_ptr<juce::AudioProcessor> candida
         return false;
     }
 
-    candidate->setNonRealtime(false);
+    candidate->setNonRealtime(nonRealtime.load(std::memory_order_acquire));
     candidate->setRateAndBufferSizeDetails(sampleRate, blockSize);
     candidate->prepareToPlay(sampleRate, blockSize);
     juce::AudioBuffer<float> newBuffer(juce::jmax(inputs, outputs), blockSize);
@@ -348,6 +363,164 @@ void AnalyzerEngine::triggerImpulseAnalysis()
     requestedGeneration.fetch_add(1, std::memory_order_acq_rel);
 }
 
+/**
+ * @brief オフラインレンダリングの有効状態を設定
+ * @param shouldRenderOffline trueの場合はFIFOが空くまで待機し、サンプルを破棄しない
+ */
+void AnalyzerEngine::setNonRealtime(bool shouldRenderOffline)
+{
+    const juce::ScopedLock lock(pluginLock);
+    nonRealtime.store(shouldRenderOffline, std::memory_order_release);
+    if (pluginInstance)
+        pluginInstance->setNonRealtime(shouldRenderOffline);
+}
+
+/**
+ * @brief 呼び出し元スレッドで指定サンプル数をレンダリングし、解析完了まで待機
+ * @param numSamples レンダリングするサンプル数
+ * @return 解析まで完了したサンプル数。ワーカーが停止している場合は0
+ */
+int AnalyzerEngine::renderOffline(int numSamples)
+{
+    jassert(isNonRealtime());
+    const auto blockSize = activeBlockSize.load(std::memory_order_acquire);
+    int rendered = 0;
+    // Without the worker nothing frees FIFO space, so every wait would hang.
+    while (rendered < numSamples && isThreadRunning())
+    {
+        const auto count = juce::jmin(blockSize, numSamples - rendered);
+        offlineBuffer.setSize(2, count, false, false, true);
+        offlineBuffer.clear();
+        processAudio(offlineBuffer);
+        rendered += count;
+    }
+    return waitForAnalysisIdle() ? rendered : 0;
+}
+
+/**
+ * @brief ワーカーがキュー済みの解析データをすべて処理するまで待機
+ * @param timeoutMs 最大待機時間（ミリ秒）。負の値の場合は無制限
+ * @return キューが空になった場合はtrue。ワーカーが停止している場合はfalse
+ */
+bool AnalyzerEngine::waitForAnalysisIdle(int timeoutMs)
+{
+    const auto deadline = juce::Time::getMillisecondCounterHiRes() + timeoutMs;
+    // The worker only calls finishedRead() after a block has been analysed, so
+    // empty FIFOs mean every queued sample has reached the snapshot. Samples
+    // left without a tag would never drain.
+    while (analysisTagFifo.getNumReady() > 0 || analysisFifo.getNumReady() > 0
+           || performanceFifo.getNumReady() > 0)
+    {
+        if (!isThreadRunning()
+            || (timeoutMs >= 0 && juce::Time::getMillisecondCounterHiRes() >= deadline))
+            return false;
+        notify();
+        fifoSpaceAvailable.wait(5);
+    }
+    return true;
+}
+
+/**
+ * @brief ワーカースレッドを停止
+ */
+void AnalyzerEngine::suspendAnalysis()
+{
+    signalThreadShouldExit();
+    notify();
+    stopThread(3000);
+}
+
+/**
+ * @brief 停止したワーカースレッドを再開し、キュー済みのデータを解析
+ */
+void AnalyzerEngine::resumeAnalysis()
+{
+    if (!isThreadRunning())
+        startThread(juce::Thread::Priority::normal);
+}
+
+/**
+ * @brief オフライン時にFIFOへ書き込めるまで待機
+ * @param fifo 対象のFIFO
+ * @param numSamples 書き込みたい要素数
+ * @return 空きができた場合はtrue。ワーカーが停止している場合はfalse
+ */
+bool AnalyzerEngine::waitForFifoSpace(const juce::AbstractFifo& fifo, int numSamples)
+{
+    const auto required = juce::jmin(numSamples, fifo.getTotalSize() - 1);
+    while (fifo.getFreeSpace() < required)
+    {
+        if (!isThreadRunning() || threadShouldExit())
+            return false;
+        notify();
+        fifoSpaceAvailable.wait(5);
+    }
+    return true;
+}
+
+/**
+ * @brief Performanceモードのパーセンタイルを集計するブロック数を設定
+ * @param numBlocks 直近のブロック数。0の場合は測定開始からの全ブロック
+ */
+void AnalyzerEngine::setPerformanceWindow(size_t numBlocks)
+{
+    requestedPerformanceWindow.store(numBlocks, std::memory_order_relaxed);
+}
+
+/**
+ * @brief 表示用スペクトルの点数を設定
+ * @param numPoints 20 Hz〜20 kHzに対数間隔で並べる点の数
+ */
+void AnalyzerEngine::setDisplayResolution(int numPoints)
+{
+    requestedDisplayPoints.store(juce::jlimit(2, maxDisplayPoints, numPoints), std::memory_order_relaxed);
+    notify();
+}
+
+/**
+ * @brief 表示用スペクトルの平滑化幅を設定
+ * @param octaveFraction 1/Nオクターブ平滑化のN。0の場合は平滑化しない
+ */
+void AnalyzerEngine::setSpectrumSmoothing(int octaveFraction)
+{
+    requestedSmoothing.store(juce::jlimit(0, plugin_analyzer::domain::LogSpectrumResampler::maxOctaveFraction,
+                                          octaveFraction),
+                             std::memory_order_relaxed);
+    notify();
+}
+
+/**
+ * @brief オシロスコープのトリガーと表示範囲を設定
+ * @param settings 取り込み設定。次のブロックから適用する
+ */
+void AnalyzerEngine::setScopeSettings(const ScopeSettings& settings)
+{
+    {
+        const juce::SpinLock::ScopedLockType lock(scopeSettingsLock);
+        requestedScopeSettings = settings;
+    }
+    scopeSettingsVersion.fetch_add(1, std::memory_order_release);
+}
+
+/**
+ * @brief オシロスコープの取り込み設定を取得
+ * @return 最後に設定された取り込み設定
+ */
+AnalyzerEngine::ScopeSettings AnalyzerEngine::getScopeSettings() const
+{
+    const juce::SpinLock::ScopedLockType lock(scopeSettingsLock);
+    return requestedScopeSettings;
+}
+
+/**
+ * @brief Harmonicモードで歪み率を公開する間隔を設定
+ * @param milliseconds 間隔（ミリ秒）。0の場合はFFTフレームごと
+ */
+void AnalyzerEngine::setHarmonicTrackingInterval(double milliseconds)
+{
+    requestedTrackingInterval.store(juce::jmax(0.0, milliseconds), std::memory_order_relaxed);
+}
+
 /**
  * @brief
  * @param mode
@@ -387,6 +560,36 @@ std::shared_ptr<const AnalyzerEngine::AnalysisSnapshot> AnalyzerEngine::getAnaly
     return std::atomic_load_explicit(&publishedSnapshot, std::memory_order_acquire);
 }
 
+/**
+ * @brief 解析結果の公開通知を登録
+ * @param listener 登録するリスナ
+ */
+void AnalyzerEngine::addSnapshotListener(plugin_analyzer::application::SnapshotListener* listener)
+{
+    snapshotListeners.add(listener);
+}
+
+/**
+ * @brief 解析結果の公開通知を解除
+ * @param listener 解除するリスナ
+ */
+void AnalyzerEngine::removeSnapshotListener(plugin_analyzer::application::SnapshotListener* listener)
+{
+    snapshotListeners.remove(listener);
+}
+
+/**
+ * @brief 公開済みの解析結果をメッセージスレッドでリスナへ通知
+ */
+void AnalyzerEngine::handleAsyncUpdate()
+{
+    const auto sequence = getSnapshotSequence();
+    snapshotListeners.call([sequence](plugin_analyzer::application::SnapshotListener& listener)
+    {
+        listener.snapshotPublished(sequence);
+    });
+}
+
 /**
  * @brief
  * @param buffer
@@ -405,12 +608,16 @@ void AnalyzerEngine::processAudio(juce::AudioBuffer<float>& buffer)
         audioGeneration = generation;
         audioIsAnalyzing = true;
         signalGenerator.reset();
-        thdSweepSamplesAtFrequency = 0;
-        thdSweepBin = 0;
+        // The deconvolver is prepared once per generation with the same
+        // parameters, at the sample rate the generation started with.
+        const auto sampleRate = activeSampleRate.load(std::memory_order_relaxed);
+        signalGenerator.setSynchronizedSweepParameters(hammersteinStartFrequency,
+                                                       hammersteinEndFrequency(sampleRate),
+                                                       hammersteinSweepSeconds);
     }
     if (modeRunsContinuously(mode))
         audioIsAnalyzing = true;
-    else if (completedLinearGeneration.load(std::memory_order_acquire) == generation)
+    else if (completedMeasurementGeneration.load(std::memory_order_acquire) == generation)
         audioIsAnalyzing = false;
     if (!audioIsAnalyzing)
         return;
@@ -422,21 +629,24 @@ void AnalyzerEngine::processAudio(juce::AudioBuffer<float>& buffer)
 
     if (mode == AnalysisMode::Harmonic)
         measurementFrequency = quantiseToFFTBin(measurementFrequency, sampleRate, fftSize);
-    else if (mode == AnalysisMode::THDSweep)
-    {
-        const auto progress = static_cast<double>(thdSweepBin)
-                            / static_cast<double>(thdSweepSteps - 1);
-        measurementFrequency = 20.0 * std::pow(1000.0, progress);
-        measurementFrequency = quantiseToFFTBin(measurementFrequency, sampleRate, fftSize);
-    }
     signalGenerator.setFrequency(measurementFrequency);
 
     TestSignalGenerator::SignalType signalType = TestSignalGenerator::SignalType::Impulse;
     switch (mode)
     {
         case AnalysisMode::Harmonic:
-        case AnalysisMode::THDSweep:
         case AnalysisMode::Performance: signalType = TestSignalGenerator::SignalType::Sine; break;
+        case AnalysisMode::THDSweep:
+        {
+            // Plans stop at maxOrder; larger frames repeat the same period,
+            // so each set is held for proportionally more periods.
+            const auto order = requestedFFTOrder.load(std::memory_order_relaxed);
+            signalGenerator.setMultitone(
+                &MultitonePlanner::forOrder(order),
+                MultitonePlanner::framesPerSet << juce::jmax(0, order - MultitonePlanner::maxOrder));
+            signalType = TestSignalGenerator::SignalType::Multitone;
+            break;
+        }
         case AnalysisMode::IMD:
             signalGenerator.setIMDFrequencies(
                 quantiseToFFTBin(imdLowFrequency, sampleRate, fftSize),
@@ -447,7 +657,7 @@ void AnalyzerEngine::processAudio(juce::AudioBuffer<float>& buffer)
         case AnalysisMode::WhiteNoise: signalType = TestSignalGenerator::SignalType::WhiteNoise; break;
         case AnalysisMode::SineSweep: signalType = TestSignalGenerator::SignalType::SineSweep; break;
         case AnalysisMode::Dynamics: signalType = TestSignalGenerator::SignalType::Ramp; break;
-        case AnalysisMode::Hammerstein: signalType = TestSignalGenerator::SignalType::SineSweep; break;
+        case AnalysisMode::Hammerstein: signalType = TestSignalGenerator::SignalType::SynchronizedSweep; break;
         case AnalysisMode::Linear: break;
     }
 
@@ -455,28 +665,37 @@ void AnalyzerEngine::processAudio(juce::AudioBuffer<float>& buffer)
     for (int channel = 1; channel < numChannels; ++channel)
         buffer.copyFrom(channel, 0, buffer, 0, 0, numSamples);
 
-    // Reserve the FIFO space before processing so the original input can be
-    // copied directly into its final, preallocated location.
-    int write1 = 0, size1 = 0, write2 = 0, size2 = 0;
-    analysisFifo.prepareToWrite(numSamples, write1, size1, write2, size2);
-    auto captureInput = [&](int start, int count, int sourceOffset)
+    // Offline renders apply backpressure instead of dropping analysis data.
+    // Without a worker the block falls through to the counted drop below.
+    const auto offline = nonRealtime.load(std::memory_order_relaxed);
+    if (offline)
     {
-        const auto* input = buffer.getReadPointer(0) + sourceOffset;
-        for (int i = 0; i < count; ++i)
-        {
-            auto& sample = analysisQueue[static_cast<size_t>(start + i)];
-            sample.input = input[i];
-            sample.mode = mode;
-            sample.generation = generation;
-            sample.measurementFrequency = static_cast<float>(measurementFrequency);
-        }
-    };
-    captureInput(write1, size1, 0);
-    captureInput(write2, size2, size1);
+        waitForFifoSpace(analysisTagFifo, 1);
+        waitForFifoSpace(analysisFifo, numSamples);
+    }
 
-    double processingTimeMs = 0.0;
+    // Reserve the FIFO space before processing so the original input can be
+    // copied directly into its final, preallocated location. A block without
+    // a free tag slot is dropped whole, because its samples could not be
+    // attributed to a measurement.
+    int tagWrite = 0, tagSize = 0, unusedStart = 0, unusedSize = 0;
+    analysisTagFifo.prepareToWrite(1, tagWrite, tagSize, unusedStart, unusedSize);
+    int write1 = 0, size1 = 0, write2 = 0, size2 = 0;
+    if (tagSize == 1)
+        analysisFifo.prepareToWrite(numSamples, write1, size1, write2, size2);
+    const auto* source = buffer.getReadPointer(0);
+    juce::FloatVectorOperations::copy(analysisInput.data() + write1, source, size1);
+    juce::FloatVectorOperations::copy(analysisInput.data() + write2, source + size1, size2);
+
+    // Thread counters cost a system call each, so they are only read while
+    // Performance mode consumes them.
+    const auto readTimer = mode == AnalysisMode::Performance ? &BlockTimer::readThread
+                                                             : &BlockTimer::readWallClock;
+    BlockTimer::Reading blockStart, blockEnd;
     bool processedPlugin = false;
-    if (pluginLock.tryEnter())
+    if (offline)
+        pluginLock.enter();
+    if (offline || pluginLock.tryEnter())
     {
         if (pluginInstance && pluginIsPrepared
             && numSamples <= activeBlockSize.load(std::memory_order_relaxed))
@@ -488,10 +707,10 @@ void AnalyzerEngine::processAudio(juce::AudioBuffer<float>& buffer)
                 pluginProcessingBuffer.copyFrom(channel, 0, buffer,
                     juce::jmin(channel, numChannels - 1), 0, numSamples);
 
-            const auto start = juce::Time::getMillisecondCounterHiRes();
             juce::MidiBuffer midi;
+            blockStart = readTimer();
             pluginInstance->processBlock(pluginProcessingBuffer, midi);
-            processingTimeMs = juce::Time::getMillisecondCounterHiRes() - start;
+            blockEnd = readTimer();
             processedPlugin = true;
 
             buffer.clear();
@@ -502,32 +721,41 @@ void AnalyzerEngine::processAudio(juce::AudioBuffer<float>& buffer)
         pluginLock.exit();
     }
 
-    auto captureOutput = [&](int start, int count, int sourceOffset)
+    const auto* left = buffer.getReadPointer(0);
+    const auto* right = buffer.getReadPointer(juce::jmin(1, numChannels - 1));
+    juce::FloatVectorOperations::copy(analysisOutputL.data() + write1, left, size1);
+    juce::FloatVectorOperations::copy(analysisOutputL.data() + write2, left + size1, size2);
+    juce::FloatVectorOperations::copy(analysisOutputR.data() + write1, right, size1);
+    juce::FloatVectorOperations::copy(analysisOutputR.data() + write2, right + size1, size2);
+
+    // The samples are published before their tag, so a worker that sees the
+    // tag always finds the whole block in the rings.
+    if (size1 + size2 > 0)
     {
-        const auto* left = buffer.getReadPointer(0) + sourceOffset;
-        const auto* right = buffer.getReadPointer(juce::jmin(1, numChannels - 1)) + sourceOffset;
-        for (int i = 0; i < count; ++i)
-        {
-            auto& sample = analysisQueue[static_cast<size_t>(start + i)];
-            sample.outputL = left[i];
-            sample.outputR = right[i];
-        }
-    };
-    captureOutput(write1, size1, 0);
-    captureOutput(write2, size2, size1);
-    analysisFifo.finishedWrite(size1 + size2);
+        analysisFifo.finishedWrite(size1 + size2);
+        analysisTags[static_cast<size_t>(tagWrite)] =
+            { mode, generation, static_cast<float>(measurementFrequency), size1 + size2 };
+        analysisTagFifo.finishedWrite(1);
+    }
     if (size1 + size2 < numSamples)
         droppedAnalysisSamples.fetch_add(static_cast<uint64_t>(numSamples - size1 - size2),
                                          std::memory_order_relaxed);
 
     if (mode == AnalysisMode::Performance && processedPlugin)
     {
+        if (offline)
+            waitForFifoSpace(performanceFifo, 1);
         int p1 = 0, n1 = 0, p2 = 0, n2 = 0;
         performanceFifo.prepareToWrite(1, p1, n1, p2, n2);
         if (n1 == 1)
         {
-            performanceQueue[static_cast<size_t>(p1)] =
-                { static_cast<float>(processingTimeMs), numSamples };
+            performanceQueue[static_cast<size_t>(p1)] = {
+                blockEnd.wallNanoseconds - blockStart.wallNanoseconds,
+                blockEnd.cpuNanoseconds - blockStart.cpuNanoseconds,
+                static_cast<uint32_t>(blockEnd.voluntarySwitches - blockStart.voluntarySwitches),
+                static_cast<uint32_t>(blockEnd.involuntarySwitches - blockStart.involuntarySwitches),
+                numSamples
+            };
             performanceFifo.finishedWrite(1);
         }
         else
@@ -536,17 +764,6 @@ void AnalyzerEngine::processAudio(juce::AudioBuffer<float>& buffer)
         }
     }
 
-    if (mode == AnalysisMode::THDSweep)
-    {
-        thdSweepSamplesAtFrequency += numSamples;
-        if (thdSweepSamplesAtFrequency >= fftSize)
-        {
-            thdSweepSamplesAtFrequency -= fftSize;
-            thdSweepBin = (thdSweepBin + 1) % thdSweepSteps;
-        }
-    }
-
-    addToScopeFifo(buffer.getReadPointer(0), numSamples);
     notify();
 }
 
@@ -559,7 +776,17 @@ void AnalyzerEngine::run()
     {
         drainAnalysisFifo();
         drainPerformanceFifo();
-        wait(20);
+        // A new display size or smoothing redraws the last result even when
+        // the measurement has already completed.
+        if (requestedDisplayPoints.load(std::memory_order_relaxed) != displayResampler.getNumPoints()
+            || requestedSmoothing.load(std::memory_order_relaxed) != displayResampler.getOctaveFraction())
+        {
+            updateDisplaySpectra();
+            publishSnapshot();
+        }
+        // Every producer and setter that gives the worker something to do
+        // calls notify(), so an idle engine sleeps until then.
+        wait(-1);
     }
     drainAnalysisFifo();
     drainPerformanceFifo();
@@ -572,54 +799,149 @@ void AnalyzerEngine::drainAnalysisFifo()
 {
     for (;;)
     {
-        int start1 = 0, size1 = 0, start2 = 0, size2 = 0;
-        analysisFifo.prepareToRead(4096, start1, size1, start2, size2);
-        if (size1 + size2 == 0)
+        int tagStart = 0, tagSize = 0, unusedStart = 0, unusedSize = 0;
+        analysisTagFifo.prepareToRead(1, tagStart, tagSize, unusedStart, unusedSize);
+        if (tagSize == 0)
             break;
-        processAnalysisSamples(analysisQueue.data() + start1, size1);
-        processAnalysisSamples(analysisQueue.data() + start2, size2);
+
+        const auto tag = analysisTags[static_cast<size_t>(tagStart)];
+        int start1 = 0, size1 = 0, start2 = 0, size2 = 0;
+        analysisFifo.prepareToRead(tag.numSamples, start1, size1, start2, size2);
+        jassert(size1 + size2 == tag.numSamples);
+        processAnalysisBlock(tag, start1, size1);
+        processAnalysisBlock(tag, start2, size2);
+        // Publishing clears the flag, so a scope frame that arrived with a
+        // spectrum does not publish twice.
+        if (scopeFramePending)
+            publishSnapshot();
         analysisFifo.finishedRead(size1 + size2);
+        analysisTagFifo.finishedRead(1);
+        fifoSpaceAvailable.signal();
     }
 }
 
 /**
- * @brief
- * @param samples
- * @param count
+ * @brief 同じ測定状態に属する連続したサンプルを解析
+ * @param tag ブロックの解析モードと世代
+ * @param start リングバッファ内の開始位置
+ * @param count サンプル数
  */
-void AnalyzerEngine::processAnalysisSamples(const AnalysisSample* samples, int count)
+void AnalyzerEngine::processAnalysisBlock(const AnalysisBlockTag& tag, int start, int count)
 {
-    for (int i = 0; i < count; ++i)
+    if (count <= 0)
+        return;
+
+    captureScope(analysisOutputL.data() + start, analysisOutputR.data() + start, count);
+
+    const auto desiredOrder = requestedFFTOrder.load(std::memory_order_acquire);
+    if (tag.generation != workerGeneration || desiredOrder != workerFFTOrder)
     {
-        const auto& sample = samples[i];
-        const auto desiredOrder = requestedFFTOrder.load(std::memory_order_acquire);
-        if (sample.generation != workerGeneration || desiredOrder != workerFFTOrder)
+        if (desiredOrder != workerFFTOrder)
+            configureWorkerFFT(desiredOrder);
+        resetWorkerAnalysis(tag.generation);
+        // The audio thread restarts the sweep with every generation, so
+        // the capture starts on the sweep's first sample.
+        if (tag.mode == AnalysisMode::Hammerstein)
+        {
+            const auto sampleRate = activeSampleRate.load(std::memory_order_acquire);
+            sweepDeconvolver.prepare(sampleRate, hammersteinStartFrequency,
+                                     hammersteinEndFrequency(sampleRate),
+                                     hammersteinSweepSeconds, hammersteinTailSeconds);
+        }
+    }
+
+    // A producer may enqueue more than one FFT frame before the worker
+    // publishes completion. Only the first frame contains the impulse;
+    // later frames are silence and must not overwrite the valid transfer.
+    auto measurementFinished = [this, &tag]
+    {
+        return !modeRunsContinuously(tag.mode)
+            && completedMeasurementGeneration.load(std::memory_order_acquire) == tag.generation;
+    };
+    if (measurementFinished())
+        return;
+
+    completedFrameFrequency = tag.measurementFrequency;
+    harmonicTracking = false;
+    if (tag.mode == AnalysisMode::Harmonic)
+    {
+        const auto sampleRate = activeSampleRate.load(std::memory_order_acquire);
+        if (harmonicZoom.getFundamental() != static_cast<double>(tag.measurementFrequency)
+            || harmonicZoom.getSampleRate() != sampleRate)
+            harmonicZoom.prepare(sampleRate, tag.measurementFrequency);
+
+        const auto hop = juce::roundToInt(requestedTrackingInterval.load(std::memory_order_relaxed)
+                                          * sampleRate / 1000.0);
+        const auto bin = juce::roundToInt(tag.measurementFrequency * workerFFTSize / sampleRate);
+        harmonicTracking = hop > 0;
+        if (harmonicTracking
+            && (harmonicTracker.getWindowSize() != workerFFTSize
+                || harmonicTracker.getFundamentalBin() != bin || harmonicTracker.getHopSize() != hop))
+            harmonicTracker.prepare(workerFFTSize, bin, hop);
+    }
+    const auto* input = analysisInput.data() + start;
+    const auto* left = analysisOutputL.data() + start;
+    const auto* right = analysisOutputR.data() + start;
+    for (int position = 0; position < count;)
+    {
+        // Spans never cross an FFT frame boundary.
+        auto span = juce::jmin(count - position, workerFFTSize - accumulationIndex);
+        auto sweepCaptured = false;
+        if (tag.mode == AnalysisMode::Dynamics)
+        {
+            for (int i = position; i < position + span; ++i)
+                analyzeDynamicsSample(input[i], left[i]);
+        }
+        else if (tag.mode == AnalysisMode::Harmonic)
+        {
+            harmonicZoom.addSamples(left + position, span);
+            for (int i = position; harmonicTracking && i < position + span; ++i)
+                if (harmonicTracker.push(left[i]))
+                    publishTrackedHarmonics();
+        }
+        else if (tag.mode == AnalysisMode::Hammerstein)
+        {
+            const auto captured = sweepDeconvolver.addSamples(input + position, left + position,
+                                                              right + position, span);
+            for (int i = position; i < position + captured; ++i)
+                analyzeEnvelopeSample(left[i]);
+            // The sample that completes the capture finishes the measurement;
+            // the frame buffers only need what the deconvolver consumed.
+            if (sweepDeconvolver.isCaptureComplete())
+            {
+                sweepCaptured = true;
+                span = captured;
+            }
+        }
+
+        const auto offset = static_cast<size_t>(accumulationIndex);
+        if (modeUsesWindow(tag.mode))
+        {
+            const auto* table = window->data() + offset;
+            juce::FloatVectorOperations::multiply(complexInput.data() + offset, input + position, table, span);
+            juce::FloatVectorOperations::multiply(complexDataL.data() + offset, left + position, table, span);
+            juce::FloatVectorOperations::multiply(complexDataR.data() + offset, right + position, table, span);
+        }
+        else
         {
-            if (desiredOrder != workerFFTOrder)
-                configureWorkerFFT(desiredOrder);
-            resetWorkerAnalysis(sample.generation);
+            juce::FloatVectorOperations::copy(complexInput.data() + offset, input + position, span);
+            juce::FloatVectorOperations::copy(complexDataL.data() + offset, left + position, span);
+            juce::FloatVectorOperations::copy(complexDataR.data() + offset, right + position, span);
         }
+        accumulationIndex += span;
+        position += span;
 
-        // A producer may enqueue more than one FFT frame before the worker
-        // publishes completion. Only the first frame contains the impulse;
-        // later frames are silence and must not overwrite the valid transfer.
-        if (sample.mode == AnalysisMode::Linear
-            && completedLinearGeneration.load(std::memory_order_acquire) == sample.generation)
-            continue;
-
-        if (sample.mode == AnalysisMode::Dynamics)
-            analyzeDynamicsSample(sample.input, sample.outputL);
-        else if (sample.mode == AnalysisMode::Hammerstein)
-            analyzeEnvelopeSample(sample.outputL);
-
-        accumulationBufferInput[static_cast<size_t>(accumulationIndex)] = sample.input;
-        accumulationBufferL[static_cast<size_t>(accumulationIndex)] = sample.outputL;
-        accumulationBufferR[static_cast<size_t>(accumulationIndex)] = sample.outputR;
-        completedFrameFrequency = sample.measurementFrequency;
-        if (++accumulationIndex == workerFFTSize)
+        if (sweepCaptured)
         {
-            processCompletedFFT(sample.mode);
+            completeSweepMeasurement();
+            return;
+        }
+        if (accumulationIndex == workerFFTSize)
+        {
+            processCompletedFFT(tag.mode);
             accumulationIndex = 0;
+            if (measurementFinished())
+                return;
         }
     }
 }
@@ -632,26 +954,48 @@ void AnalyzerEngine::resetWorkerAnalysis(uint32_t generation)
 {
     workerGeneration = generation;
     accumulationIndex = 0;
-    std::fill(accumulationBufferL.begin(), accumulationBufferL.end(), 0.0f);
-    std::fill(accumulationBufferR.begin(), accumulationBufferR.end(), 0.0f);
-    std::fill(accumulationBufferInput.begin(), accumulationBufferInput.end(), 0.0f);
+    std::fill(complexInput.begin(), complexInput.end(), 0.0f);
+    std::fill(complexDataL.begin(), complexDataL.end(), 0.0f);
+    std::fill(complexDataR.begin(), complexDataR.end(), 0.0f);
     std::fill(averagedInputPower.begin(), averagedInputPower.end(), 0.0);
     std::fill(averagedOutputPowerL.begin(), averagedOutputPowerL.end(), 0.0);
     std::fill(averagedOutputPowerR.begin(), averagedOutputPowerR.end(), 0.0);
     spectralAverageCount = 0;
+    multitoneTonePower = multitoneResidualPower = 0.0;
     workerResult.dynamics = {};
     workerResult.envelope = {};
     workerResult.thdSweepFrequencies.clear();
     workerResult.thdSweepValues.clear();
+    workerResult.harmonicResponses.clear();
+    workerResult.display.harmonicResponses.clear();
     workerResult.thd = 0.0f;
     workerResult.thdPlusN = 0.0f;
     workerResult.imd = 0.0f;
+    workerResult.frameCount = 0;
+    workerResult.measurementComplete = false;
     dynamicsDecimationCounter = 0;
     envelopeDecimationCounter = 0;
     dynamicsInputSquared = dynamicsOutputSquared = 0.0;
     dynamicsWindowSamples = 0;
     envelopeTimeSeconds = 0.0;
     envelopePrevious = 0.0f;
+    dynamicsInputLevels.clear();
+    dynamicsOutputLevels.clear();
+    envelopeTracker.reset();
+    harmonicZoom.reset();
+    harmonicTracker.reset();
+    performanceHistogram.reset();
+    performanceWindowRecords.clear();
+    performanceWallTotal = performanceCpuTotal = 0;
+    performanceHistoryWrite = performanceHistoryCount = 0;
+    workerResult.performance.processingTimeHistory.clear();
+    workerResult.performance.voluntaryContextSwitches = 0;
+    workerResult.performance.involuntaryContextSwitches = 0;
+    workerResult.performance.preemptedBlocks = 0;
+    markSnapshotChanged();
+    // Publish the cleared state so readers never attribute an older
+    // measurement's results to the new generation.
+    publishSnapshot();
 }
 
 /**
@@ -660,21 +1004,28 @@ void AnalyzerEngine::resetWorkerAnalysis(uint32_t generation)
  */
 void AnalyzerEngine::processCompletedFFT(AnalysisMode mode)
 {
-    std::fill(complexInput.begin(), complexInput.end(), 0.0f);
-    std::fill(complexDataL.begin(), complexDataL.end(), 0.0f);
-    std::fill(complexDataR.begin(), complexDataR.end(), 0.0f);
-    std::copy(accumulationBufferInput.begin(), accumulationBufferInput.end(), complexInput.begin());
-    std::copy(accumulationBufferL.begin(), accumulationBufferL.end(), complexDataL.begin());
-    std::copy(accumulationBufferR.begin(), accumulationBufferR.end(), complexDataR.begin());
-    if (modeUsesWindow(mode))
+    // The captured frame already sits windowed in the first half of each
+    // transform buffer; only the detection below needs the time domain.
+    int latency = 0;
+    if (mode == AnalysisMode::Linear)
     {
-        window->multiplyWithWindowingTable(complexInput.data(), workerFFTSize);
-        window->multiplyWithWindowingTable(complexDataL.data(), workerFFTSize);
-        window->multiplyWithWindowingTable(complexDataR.data(), workerFFTSize);
+        auto peakOf = [this](const std::vector<float>& frame)
+        {
+            return static_cast<int>(std::distance(frame.begin(), std::max_element(
+                frame.begin(), frame.begin() + workerFFTSize,
+                [](float a, float b) { return std::abs(a) < std::abs(b); })));
+        };
+        const auto detectedLatency = juce::jlimit(0, workerFFTSize - 1,
+                                                  peakOf(complexDataL) - peakOf(complexInput));
+        const auto reportedLatency = juce::jlimit(
+            0, workerFFTSize - 1, pluginLatencySamples.load(std::memory_order_acquire));
+        latency = reportedLatency > 0 ? reportedLatency : detectedLatency;
     }
-    forwardFFT->performRealOnlyForwardTransform(complexInput.data());
-    forwardFFT->performRealOnlyForwardTransform(complexDataL.data());
-    forwardFFT->performRealOnlyForwardTransform(complexDataR.data());
+    workerResult.latencySamples = latency;
+
+    forwardFFT->performRealForward(complexInput.data());
+    forwardFFT->performRealForward(complexDataL.data());
+    forwardFFT->performRealForward(complexDataR.data());
 
     const auto sampleRate = activeSampleRate.load(std::memory_order_acquire);
     workerResult.sampleRate = sampleRate;
@@ -687,25 +1038,6 @@ void AnalyzerEngine::processCompletedFFT(AnalysisMode mode)
             bin == 0 ? 0.0 : data[static_cast<size_t>(2 * bin + 1)]);
     };
 
-    int latency = 0;
-    if (mode == AnalysisMode::Linear)
-    {
-        const auto inputPeak = static_cast<int>(std::distance(
-            accumulationBufferInput.begin(),
-            std::max_element(accumulationBufferInput.begin(), accumulationBufferInput.end(),
-                [](float a, float b) { return std::abs(a) < std::abs(b); })));
-        const auto outputPeak = static_cast<int>(std::distance(
-            accumulationBufferL.begin(),
-            std::max_element(accumulationBufferL.begin(), accumulationBufferL.end(),
-                [](float a, float b) { return std::abs(a) < std::abs(b); })));
-        const auto detectedLatency = juce::jlimit(0, workerFFTSize - 1,
-                                                  outputPeak - inputPeak);
-        const auto reportedLatency = juce::jlimit(
-            0, workerFFTSize - 1, pluginLatencySamples.load(std::memory_order_acquire));
-        latency = reportedLatency > 0 ? reportedLatency : detectedLatency;
-    }
-    workerResult.latencySamples = latency;
-
     const auto isTransferMeasurement = mode == AnalysisMode::Linear
                                     || mode == AnalysisMode::WhiteNoise
                                     || mode == AnalysisMode::SineSweep
@@ -713,112 +1045,279 @@ void AnalyzerEngine::processCompletedFFT(AnalysisMode mode)
     if (mode == AnalysisMode::WhiteNoise)
         ++spectralAverageCount;
 
-    for (int bin = 0; bin < workerFFTSize / 2; ++bin)
+    // Real input leaves the DC bin's imaginary part at zero; state it
+    // explicitly because the kernels read every bin as a complex pair.
+    const auto bins = workerFFTSize / 2;
+    complexInput[1] = complexDataL[1] = complexDataR[1] = 0.0f;
+    constexpr auto transferPowerThreshold = 1.0e-20f;
+    const auto scale = static_cast<float>(amplitudeScale);
+    if (isTransferMeasurement)
     {
-        const auto input = component(complexInput, bin);
-        const auto left = component(complexDataL, bin);
-        const auto right = component(complexDataR, bin);
-        std::complex<double> displayLeft = left * amplitudeScale;
-        std::complex<double> displayRight = right * amplitudeScale;
-
-        if (isTransferMeasurement && std::norm(input) > 1.0e-20)
+        const float* rotation = nullptr;
+        if (latency > 0)
         {
-            if (mode == AnalysisMode::WhiteNoise)
-            {
-                constexpr double averaging = 0.9;
-                const auto index = static_cast<size_t>(bin);
-                const auto blend = spectralAverageCount == 1 ? 0.0 : averaging;
-                averagedInputPower[index] =
-                    blend * averagedInputPower[index] + (1.0 - blend) * std::norm(input);
-                averagedOutputPowerL[index] =
-                    blend * averagedOutputPowerL[index] + (1.0 - blend) * std::norm(left);
-                averagedOutputPowerR[index] =
-                    blend * averagedOutputPowerR[index] + (1.0 - blend) * std::norm(right);
-                const auto inputPower = juce::jmax(averagedInputPower[index], 1.0e-20);
-                displayLeft = std::polar(std::sqrt(averagedOutputPowerL[index] / inputPower),
-                                         std::arg(left / input));
-                displayRight = std::polar(std::sqrt(averagedOutputPowerR[index] / inputPower),
-                                          std::arg(right / input));
-            }
-            else
+            if (latency != latencyRotationSamples)
             {
-                displayLeft = left / input;
-                displayRight = right / input;
+                SpectrumKernels::createRotation(latencyRotation.data(), bins, latency, workerFFTSize);
+                latencyRotationSamples = latency;
             }
+            rotation = latencyRotation.data();
+        }
+        SpectrumKernels::divide(complexDataL.data(), complexInput.data(), rotation,
+                                displaySpectrumL.data(), bins, transferPowerThreshold, scale);
+        SpectrumKernels::divide(complexDataR.data(), complexInput.data(), rotation,
+                                displaySpectrumR.data(), bins, transferPowerThreshold, scale);
+    }
+    else
+    {
+        juce::FloatVectorOperations::copyWithMultiply(displaySpectrumL.data(), complexDataL.data(),
+                                                      scale, bins * 2);
+        juce::FloatVectorOperations::copyWithMultiply(displaySpectrumR.data(), complexDataR.data(),
+                                                      scale, bins * 2);
+    }
 
-            if (latency > 0)
+    if (mode == AnalysisMode::WhiteNoise)
+    {
+        // The averaged power ratio sets the magnitude; the phase of the
+        // latest frame's transfer is kept.
+        constexpr double averaging = 0.9;
+        const auto blend = spectralAverageCount == 1 ? 0.0 : averaging;
+        for (int bin = 0; bin < bins; ++bin)
+        {
+            const auto input = component(complexInput, bin);
+            if (std::norm(input) <= transferPowerThreshold)
+                continue;
+
+            const auto index = static_cast<size_t>(bin);
+            averagedInputPower[index] = blend * averagedInputPower[index] + (1.0 - blend) * std::norm(input);
+            const auto inputPower = juce::jmax(averagedInputPower[index], 1.0e-20);
+            auto average = [&](const std::vector<float>& output, std::vector<double>& averagedPower,
+                               std::vector<float>& display)
             {
-                const auto correction = juce::MathConstants<double>::twoPi
-                                      * static_cast<double>(bin * latency)
-                                      / static_cast<double>(workerFFTSize);
-                displayLeft *= std::polar(1.0, correction);
-                displayRight *= std::polar(1.0, correction);
-            }
+                averagedPower[index] = blend * averagedPower[index]
+                                     + (1.0 - blend) * std::norm(component(output, bin));
+                const std::complex<double> transfer(display[2 * index], display[2 * index + 1]);
+                const auto value = std::polar(std::sqrt(averagedPower[index] / inputPower),
+                                              std::arg(transfer));
+                display[2 * index] = static_cast<float>(value.real());
+                display[2 * index + 1] = static_cast<float>(value.imag());
+            };
+            average(complexDataL, averagedOutputPowerL, displaySpectrumL);
+            average(complexDataR, averagedOutputPowerR, displaySpectrumR);
         }
+    }
 
-        auto store = [bin](const std::complex<double>& value,
-                           std::vector<float>& magnitudes,
-                           std::vector<float>& phases)
-        {
-            const auto magnitude = std::isfinite(std::abs(value)) ? std::abs(value) : 0.0;
-            magnitudes[static_cast<size_t>(bin)] =
-                juce::Decibels::gainToDecibels(static_cast<float>(magnitude), -160.0f);
-            phases[static_cast<size_t>(bin)] = static_cast<float>(std::arg(value));
-        };
-        store(displayLeft, workerResult.magnitudeSpectrumL, workerResult.phaseSpectrumL);
-        store(displayRight, workerResult.magnitudeSpectrumR, workerResult.phaseSpectrumR);
+    publishSpectra();
+    markSnapshotChanged(SnapshotSection::Spectrum);
+    auto complete = mode == AnalysisMode::Linear;
+    // A tracked Harmonic measurement publishes its own THD between frames.
+    const auto frameTHD = mode == AnalysisMode::Harmonic && !harmonicTracking;
+    if (frameTHD || mode == AnalysisMode::IMD)
+        updatePowerPrefixSums();
+    if (frameTHD)
+    {
+        calculateTHD(workerResult);
+        markSnapshotChanged(SnapshotSection::Harmonics);
     }
+    else if (mode == AnalysisMode::THDSweep)
+    {
+        complete = analyseMultitoneFrame();
+        markSnapshotChanged(SnapshotSection::THDSweep);
+    }
+    else if (mode == AnalysisMode::IMD)
+        calculateIMD(workerResult);
+    ++workerResult.frameCount;
+    workerResult.measurementComplete = complete;
+    publishSnapshot();
+    if (complete)
+        completedMeasurementGeneration.store(workerGeneration, std::memory_order_release);
+}
+
+/**
+ * @brief スイープ録音を逆畳み込みし、H1..H10を1回の測定結果として公開
+ */
+void AnalyzerEngine::completeSweepMeasurement()
+{
+    const auto sampleRate = activeSampleRate.load(std::memory_order_acquire);
+    const auto reportedLatency = juce::jlimit(
+        0, workerFFTSize - 1, pluginLatencySamples.load(std::memory_order_acquire));
+    workerResult.sampleRate = sampleRate;
+    workerResult.latencySamples = sweepDeconvolver.deconvolve(workerFFTOrder, reportedLatency);
 
-    if (mode == AnalysisMode::Hammerstein)
+    const auto bins = workerFFTSize / 2;
+    const auto& linearL = sweepDeconvolver.getHarmonicResponse(1);
+    const auto& linearR = sweepDeconvolver.getLinearResponseRight();
+    auto store = [](const std::complex<double>& value, float* destination)
     {
-        int fundamentalBin = 1;
-        double inputPeakPower = 0.0;
-        for (int bin = 1; bin < workerFFTSize / 2; ++bin)
+        const auto finite = std::isfinite(value.real()) && std::isfinite(value.imag());
+        destination[0] = finite ? static_cast<float>(value.real()) : 0.0f;
+        destination[1] = finite ? static_cast<float>(value.imag()) : 0.0f;
+    };
+    for (int bin = 0; bin < bins; ++bin)
+    {
+        const auto index = static_cast<size_t>(bin);
+        store(linearL[index], displaySpectrumL.data() + 2 * index);
+        store(linearR[index], displaySpectrumR.data() + 2 * index);
+    }
+    publishSpectra();
+
+    // Re-index every H_k by its fundamental: the k-th harmonic of bin b lies at
+    // bin k * b, and is only excited while k * f stays inside the sweep.
+    const auto binWidth = sampleRate / workerFFTSize;
+    const auto sweepEnd = sweepDeconvolver.getEndFrequency();
+    const auto decimation = workerResult.spectrumDecimation;
+    workerResult.harmonicResponses.assign(
+        SweepDeconvolver::maxHarmonics,
+        std::vector<float>(workerResult.magnitudeSpectrumL.size(), -160.0f));
+    auto harmonicGain = [&](int harmonic, int bin)
+    {
+        if (bin * harmonic >= bins || bin * harmonic * binWidth > sweepEnd)
+            return 0.0;
+        return std::abs(sweepDeconvolver.getHarmonicResponse(harmonic)[static_cast<size_t>(bin * harmonic)]);
+    };
+    for (int harmonic = 1; harmonic <= SweepDeconvolver::maxHarmonics; ++harmonic)
+    {
+        auto& levels = workerResult.harmonicResponses[static_cast<size_t>(harmonic - 1)];
+        for (int bin = 1; bin * harmonic < bins && bin * harmonic * binWidth <= sweepEnd; ++bin)
         {
-            const auto power = std::norm(component(complexInput, bin));
-            if (power > inputPeakPower)
-            {
-                inputPeakPower = power;
-                fundamentalBin = bin;
-            }
+            // Decimated points keep the loudest bin of their group.
+            auto& level = levels[static_cast<size_t>(bin / decimation)];
+            level = juce::jmax(level, juce::Decibels::gainToDecibels(
+                                          static_cast<float>(harmonicGain(harmonic, bin)), -160.0f));
         }
+    }
 
-        const auto outputPowerAt = [this, &component](int centre)
-        {
-            double power = 0.0;
-            for (int bin = juce::jmax(1, centre - 1);
-                 bin <= juce::jmin(workerFFTSize / 2 - 1, centre + 1); ++bin)
-                power += std::norm(component(complexDataL, bin));
-            return power;
-        };
-        const auto fundamentalPower = outputPowerAt(fundamentalBin);
-        std::fill(workerResult.harmonicLevels.begin(),
-                  workerResult.harmonicLevels.end(), -160.0f);
-        if (fundamentalPower > 1.0e-20)
+    // Distortion at the test frequency is read from the same capture.
+    const auto fundamental = juce::jlimit(1, bins - 1,
+                                          juce::roundToInt(completedFrameFrequency / binWidth));
+    const auto fundamentalGain = std::abs(linearL[static_cast<size_t>(fundamental)]);
+    double harmonicsSquared = 0.0;
+    std::fill(workerResult.harmonicLevels.begin(), workerResult.harmonicLevels.end(), -160.0f);
+    for (int harmonic = 2; harmonic <= SweepDeconvolver::maxHarmonics && fundamentalGain > 1.0e-10;
+         ++harmonic)
+    {
+        const auto relative = harmonicGain(harmonic, fundamental) / fundamentalGain;
+        harmonicsSquared += relative * relative;
+        workerResult.harmonicLevels[static_cast<size_t>(harmonic - 2)] =
+            juce::Decibels::gainToDecibels(static_cast<float>(relative), -160.0f);
+    }
+    workerResult.thd = static_cast<float>(std::sqrt(harmonicsSquared) * 100.0);
+    workerResult.thdPlusN = 0.0f;
+
+    updateDisplaySpectra();
+    markSnapshotChanged(SnapshotSection::Spectrum);
+    markSnapshotChanged(SnapshotSection::Harmonics);
+    ++workerResult.frameCount;
+    workerResult.measurementComplete = true;
+    publishSnapshot();
+    completedMeasurementGeneration.store(workerGeneration, std::memory_order_release);
+}
+
+/**
+ * @brief 表示用スペクトルをdBと位相に変換して公開
+ *
+ * FFTが公開点数より大きい場合は連続したビンをまとめ、各グループで
+ * パワーが最大のビンを代表値にする。細いピークは間引いても消えない。
+ */
+void AnalyzerEngine::publishSpectra()
+{
+    const auto decimation = workerResult.spectrumDecimation;
+    const auto published = static_cast<int>(workerResult.magnitudeSpectrumL.size());
+    auto convert = [&](const std::vector<float>& spectrum, std::vector<float>& magnitudes,
+                       std::vector<float>& phases)
+    {
+        const auto* source = spectrum.data();
+        if (decimation > 1)
         {
-            for (int harmonic = 2; harmonic <= 10; ++harmonic)
+            for (int point = 0; point < published; ++point)
             {
-                const auto bin = fundamentalBin * harmonic;
-                if (bin >= workerFFTSize / 2)
-                    break;
-                workerResult.harmonicLevels[static_cast<size_t>(harmonic - 2)] =
-                    juce::Decibels::gainToDecibels(static_cast<float>(
-                        std::sqrt(outputPowerAt(bin) / fundamentalPower)), -160.0f);
+                auto loudest = point * decimation;
+                auto loudestPower = -1.0f;
+                for (int bin = point * decimation; bin < (point + 1) * decimation; ++bin)
+                {
+                    const auto re = spectrum[static_cast<size_t>(2 * bin)];
+                    const auto im = spectrum[static_cast<size_t>(2 * bin + 1)];
+                    if (re * re + im * im > loudestPower)
+                    {
+                        loudestPower = re * re + im * im;
+                        loudest = bin;
+                    }
+                }
+                decimatedSpectrum[static_cast<size_t>(2 * point)] = spectrum[static_cast<size_t>(2 * loudest)];
+                decimatedSpectrum[static_cast<size_t>(2 * point + 1)] =
+                    spectrum[static_cast<size_t>(2 * loudest + 1)];
             }
+            source = decimatedSpectrum.data();
         }
-    }
+        SpectrumKernels::toDecibelsAndPhase(source, magnitudes.data(), phases.data(), published, -160.0f);
+    };
+    convert(displaySpectrumL, workerResult.magnitudeSpectrumL, workerResult.phaseSpectrumL);
+    convert(displaySpectrumR, workerResult.magnitudeSpectrumR, workerResult.phaseSpectrumR);
+    updateDisplaySpectra();
+}
+
+/**
+ * @brief 公開するスペクトルを描画用の対数間隔へ変換
+ *
+ * UIは描画のたびに平滑化せず、ここで1スナップショットにつき1回だけ計算する。
+ */
+void AnalyzerEngine::updateDisplaySpectra()
+{
+    const auto points = requestedDisplayPoints.load(std::memory_order_relaxed);
+    const auto smoothing = requestedSmoothing.load(std::memory_order_relaxed);
+    if (points != displayResampler.getNumPoints() || smoothing != displayResampler.getOctaveFraction())
+        displayResampler.prepare(points, smoothing);
+
+    auto& display = workerResult.display;
+    display.frequencies = displayResampler.getFrequencies();
+    display.octaveFraction = smoothing;
+    const auto binWidth = workerResult.sampleRate * workerResult.spectrumDecimation / workerFFTSize;
+    displayResampler.process(workerResult.magnitudeSpectrumL, workerResult.phaseSpectrumL, binWidth,
+                             display.magnitudeL, display.phaseL);
+    displayResampler.process(workerResult.magnitudeSpectrumR, workerResult.phaseSpectrumR, binWidth,
+                             display.magnitudeR, display.phaseR);
+
+    const std::vector<float> noPhases;
+    std::vector<float> unusedPhases;
+    display.harmonicResponses.resize(workerResult.harmonicResponses.size());
+    for (size_t harmonic = 0; harmonic < workerResult.harmonicResponses.size(); ++harmonic)
+        displayResampler.process(workerResult.harmonicResponses[harmonic], noPhases, binWidth,
+                                 display.harmonicResponses[harmonic], unusedPhases);
+    markSnapshotChanged(SnapshotSection::Display);
+}
 
-    if (mode == AnalysisMode::Harmonic || mode == AnalysisMode::THDSweep)
+/**
+ * @brief 左チャンネルの表示スペクトルから線形パワーの累積和を作成
+ *
+ * THDとIMDはdBへ変換した値ではなくこの累積和から帯域パワーを求めるため、
+ * ビンごとのpowや-160 dBの下限による誤差が生じない。
+ */
+void AnalyzerEngine::updatePowerPrefixSums()
+{
+    const auto bins = workerFFTSize / 2;
+    powerPrefixSumL[0] = 0.0;
+    for (int bin = 0; bin < bins; ++bin)
     {
-        calculateTHD(workerResult);
-        if (mode == AnalysisMode::THDSweep)
-            updateTHDSweep(completedFrameFrequency, workerResult.thd);
+        const auto index = static_cast<size_t>(bin);
+        const auto re = static_cast<double>(displaySpectrumL[2 * index]);
+        const auto im = static_cast<double>(displaySpectrumL[2 * index + 1]);
+        powerPrefixSumL[index + 1] = powerPrefixSumL[index] + re * re + im * im;
     }
-    else if (mode == AnalysisMode::IMD)
-        calculateIMD(workerResult);
-    publishSnapshot();
-    if (mode == AnalysisMode::Linear)
-        completedLinearGeneration.store(workerGeneration, std::memory_order_release);
+}
+
+/**
+ * @brief 指定範囲のビンの線形パワーの合計を取得
+ * @param firstBin 最初のビン（1未満は1に制限）
+ * @param lastBin 最後のビン（ナイキスト未満に制限）
+ * @return パワーの合計。範囲が空の場合は0
+ */
+double AnalyzerEngine::bandPower(int firstBin, int lastBin) const
+{
+    const auto first = juce::jmax(1, firstBin);
+    const auto last = juce::jmin(workerFFTSize / 2 - 1, lastBin);
+    if (last < first)
+        return 0.0;
+    return powerPrefixSumL[static_cast<size_t>(last + 1)] - powerPrefixSumL[static_cast<size_t>(first)];
 }
 
 /**
@@ -835,57 +1334,77 @@ void AnalyzerEngine::calculateTHD(AnalysisSnapshot& result)
         return;
     }
 
-    auto bandPower = [&result, this](int centre, int radius)
-    {
-        double power = 0.0;
-        for (int bin = juce::jmax(1, centre - radius);
-             bin <= juce::jmin(workerFFTSize / 2 - 1, centre + radius); ++bin)
-        {
-            const auto gain = juce::Decibels::decibelsToGain(
-                result.magnitudeSpectrumL[static_cast<size_t>(bin)]);
-            power += static_cast<double>(gain) * gain;
-        }
-        return power;
-    };
-
-    const auto fundamentalPower = bandPower(fundamental, 1);
+    const auto fundamentalPower = bandPower(fundamental - 1, fundamental + 1);
     if (fundamentalPower <= 1.0e-20)
     {
         result.thd = result.thdPlusN = 0.0f;
         return;
     }
 
-    double harmonicsSquared = 0.0, noiseSquared = 0.0;
+    // Harmonics come from the zoomed bands once a zoom frame exists; they
+    // resolve a low fundamental that shares its FFT bins with H2 and H3.
+    const auto zoomed = harmonicZoom.hasResult()
+                     && harmonicZoom.getFundamental() == static_cast<double>(completedFrameFrequency)
+                     && harmonicZoom.getHarmonicPower(1) > 1.0e-20;
+    const auto harmonicCount = zoomed ? harmonicZoom.getNumHarmonics()
+                                      : juce::jmin(10, (workerFFTSize / 2 - 1) / fundamental);
+    const auto referencePower = zoomed ? harmonicZoom.getHarmonicPower(1) : fundamentalPower;
+    double harmonicsSquared = 0.0;
     std::fill(result.harmonicLevels.begin(), result.harmonicLevels.end(), -120.0f);
-    for (int harmonic = 2; harmonic <= 10; ++harmonic)
+    for (int harmonic = 2; harmonic <= harmonicCount; ++harmonic)
     {
         const auto bin = fundamental * harmonic;
-        if (bin >= workerFFTSize / 2)
-            break;
-        const auto power = bandPower(bin, 1);
+        const auto power = zoomed ? harmonicZoom.getHarmonicPower(harmonic) : bandPower(bin - 1, bin + 1);
         harmonicsSquared += power;
         result.harmonicLevels[static_cast<size_t>(harmonic - 2)] =
             juce::Decibels::gainToDecibels(
-                static_cast<float>(std::sqrt(power / fundamentalPower)), -160.0f);
+                static_cast<float>(std::sqrt(power / referencePower)), -160.0f);
     }
 
     const auto firstMeasurementBin = juce::jmax(1, juce::roundToInt(20.0 / binWidth));
     const auto lastMeasurementBin = juce::jmin(workerFFTSize / 2 - 1,
                                                juce::roundToInt(20000.0 / binWidth));
-    for (int bin = firstMeasurementBin; bin <= lastMeasurementBin; ++bin)
+    // Everything in the measurement band except the fundamental's three bins.
+    // A Hann window has an equivalent noise bandwidth of 1.5 bins.
+    const auto noiseSquared = juce::jmax(0.0, bandPower(firstMeasurementBin, lastMeasurementBin)
+                                            - bandPower(juce::jmax(firstMeasurementBin, fundamental - 1),
+                                                        juce::jmin(lastMeasurementBin, fundamental + 1)))
+                            / 1.5;
+    result.thd = static_cast<float>(std::sqrt(harmonicsSquared / referencePower) * 100.0);
+    result.thdPlusN = static_cast<float>(
+        std::sqrt(noiseSquared / fundamentalPower) * 100.0);
+}
+
+/**
+ * @brief スライディングDFTの最新値から歪み率を算出して公開
+ *
+ * THD+Nは直流と基本波以外の全帯域のパワーから求める。
+ */
+void AnalyzerEngine::publishTrackedHarmonics()
+{
+    const auto fundamentalPower = harmonicTracker.getHarmonicPower(1);
+    std::fill(workerResult.harmonicLevels.begin(), workerResult.harmonicLevels.end(), -120.0f);
+    if (fundamentalPower <= 1.0e-20)
+    {
+        workerResult.thd = workerResult.thdPlusN = 0.0f;
+    }
+    else
     {
-        if (std::abs(bin - fundamental) > 1)
+        double harmonicsPower = 0.0;
+        for (int harmonic = 2; harmonic <= harmonicTracker.getNumHarmonics(); ++harmonic)
         {
-            const auto gain = juce::Decibels::decibelsToGain(
-                result.magnitudeSpectrumL[static_cast<size_t>(bin)]);
-            noiseSquared += gain * gain;
+            const auto power = harmonicTracker.getHarmonicPower(harmonic);
+            harmonicsPower += power;
+            workerResult.harmonicLevels[static_cast<size_t>(harmonic - 2)] =
+                juce::Decibels::gainToDecibels(
+                    static_cast<float>(std::sqrt(power / fundamentalPower)), -160.0f);
         }
+        workerResult.thd = static_cast<float>(std::sqrt(harmonicsPower / fundamentalPower) * 100.0);
+        workerResult.thdPlusN = static_cast<float>(
+            std::sqrt(harmonicTracker.getResidualPower() / fundamentalPower) * 100.0);
     }
-    // A Hann window has an equivalent noise bandwidth of 1.5 bins.
-    noiseSquared /= 1.5;
-    result.thd = static_cast<float>(std::sqrt(harmonicsSquared / fundamentalPower) * 100.0);
-    result.thdPlusN = static_cast<float>(
-        std::sqrt(noiseSquared / fundamentalPower) * 100.0);
+    markSnapshotChanged(SnapshotSection::Harmonics);
+    publishSnapshot();
 }
 
 /**
@@ -899,18 +1418,7 @@ void AnalyzerEngine::calculateIMD(AnalysisSnapshot& result)
         quantiseToFFTBin(imdLowFrequency, result.sampleRate, workerFFTSize) / binWidth);
     const auto highBin = juce::roundToInt(
         quantiseToFFTBin(imdHighFrequency, result.sampleRate, workerFFTSize) / binWidth);
-    auto powerAt = [&result, this](int centre)
-    {
-        double power = 0.0;
-        for (int bin = juce::jmax(1, centre - 1);
-             bin <= juce::jmin(workerFFTSize / 2 - 1, centre + 1); ++bin)
-        {
-            const auto gain = juce::Decibels::decibelsToGain(
-                result.magnitudeSpectrumL[static_cast<size_t>(bin)]);
-            power += static_cast<double>(gain) * gain;
-        }
-        return power;
-    };
+    auto powerAt = [this](int centre) { return bandPower(centre - 1, centre + 1); };
     const auto carrierPower = powerAt(highBin);
     if (carrierPower <= 1.0e-20)
     {
@@ -944,40 +1452,38 @@ void AnalyzerEngine::analyzeDynamicsSample(float input, float output)
     if (++dynamicsWindowSamples < rmsWindow)
         return;
 
-    auto& dynamics = workerResult.dynamics;
-    if (dynamics.inputLevels.size() == 1000)
-    {
-        dynamics.inputLevels.erase(dynamics.inputLevels.begin());
-        dynamics.outputLevels.erase(dynamics.outputLevels.begin());
-    }
     const auto inputRms = std::sqrt(dynamicsInputSquared / dynamicsWindowSamples);
     const auto outputRms = std::sqrt(dynamicsOutputSquared / dynamicsWindowSamples);
     const auto inputLevel =
         juce::Decibels::gainToDecibels(static_cast<float>(inputRms), -100.0f);
     const auto outputLevel =
         juce::Decibels::gainToDecibels(static_cast<float>(outputRms), -100.0f);
-    if (!dynamics.inputLevels.empty()
-        && inputLevel < dynamics.inputLevels.back() - 6.0f)
+    if (!dynamicsInputLevels.empty()
+        && inputLevel < dynamicsInputLevels.back() - 6.0f)
     {
-        dynamics.inputLevels.clear();
-        dynamics.outputLevels.clear();
+        dynamicsInputLevels.clear();
+        dynamicsOutputLevels.clear();
     }
-    dynamics.inputLevels.push_back(inputLevel);
-    dynamics.outputLevels.push_back(outputLevel);
+    dynamicsInputLevels.push(inputLevel);
+    dynamicsOutputLevels.push(outputLevel);
+    markSnapshotChanged(SnapshotSection::Dynamics);
     dynamicsInputSquared = dynamicsOutputSquared = 0.0;
     dynamicsWindowSamples = 0;
 
-    const auto count = dynamics.inputLevels.size();
+    // The fits run once per RMS window, not per sample, so the linear pass
+    // over at most dynamicsHistorySize points stays cheap.
+    auto& dynamics = workerResult.dynamics;
+    const auto count = dynamicsInputLevels.size();
     if (count >= 12)
     {
-        const auto fit = [&dynamics](size_t first, size_t last)
+        const auto fit = [this](size_t first, size_t last)
         {
             double sumX = 0.0, sumY = 0.0, sumXX = 0.0, sumXY = 0.0;
             const auto n = static_cast<double>(last - first);
             for (auto i = first; i < last; ++i)
             {
-                const auto x = dynamics.inputLevels[i];
-                const auto y = dynamics.outputLevels[i];
+                const auto x = dynamicsInputLevels[i];
+                const auto y = dynamicsOutputLevels[i];
                 sumX += x;
                 sumY += y;
                 sumXX += x * x;
@@ -1013,77 +1519,120 @@ void AnalyzerEngine::analyzeEnvelopeSample(float output)
     if (++envelopeDecimationCounter < decimation)
         return;
     envelopeDecimationCounter = 0;
-    auto& envelope = workerResult.envelope;
-    if (envelope.envelopeValues.size() == 4096)
-    {
-        envelope.envelopeValues.erase(envelope.envelopeValues.begin());
-        envelope.timePoints.erase(envelope.timePoints.begin());
-    }
-    envelope.envelopeValues.push_back(envelopePrevious);
-    envelope.timePoints.push_back(static_cast<float>(envelopeTimeSeconds));
+    envelopeTracker.push(static_cast<float>(envelopeTimeSeconds), envelopePrevious);
+    markSnapshotChanged(SnapshotSection::Envelope);
     envelopePrevious = 0.0f;
+}
 
-    if (envelope.envelopeValues.size() >= 2)
+/**
+ * @brief 出力波形をオシロスコープへ取り込む
+ * @param left 左チャンネルの出力
+ * @param right 右チャンネルの出力
+ * @param count サンプル数
+ */
+void AnalyzerEngine::captureScope(const float* left, const float* right, int count)
+{
+    // Nothing displays the scope while rendering offline.
+    if (nonRealtime.load(std::memory_order_relaxed))
+        return;
+
+    const auto version = scopeSettingsVersion.load(std::memory_order_acquire);
+    const auto sampleRate = activeSampleRate.load(std::memory_order_acquire);
+    if (version != workerScopeSettingsVersion || scopeCapture.getSampleRate() != sampleRate)
     {
-        const auto peak = *std::max_element(envelope.envelopeValues.begin(),
-                                            envelope.envelopeValues.end());
-        if (peak > 1.0e-6f)
-        {
-            auto crossing = [&envelope](float level, bool rising)
-            {
-                if (rising)
-                {
-                    for (size_t i = 0; i < envelope.envelopeValues.size(); ++i)
-                        if (envelope.envelopeValues[i] >= level)
-                            return envelope.timePoints[i];
-                }
-                else
-                {
-                    const auto peakIt = std::max_element(envelope.envelopeValues.begin(),
-                                                         envelope.envelopeValues.end());
-                    for (auto i = static_cast<size_t>(
-                             std::distance(envelope.envelopeValues.begin(), peakIt));
-                         i < envelope.envelopeValues.size(); ++i)
-                        if (envelope.envelopeValues[i] <= level)
-                            return envelope.timePoints[i];
-                }
-                return -1.0f;
-            };
-            const auto attack10 = crossing(peak * 0.1f, true);
-            const auto attack90 = crossing(peak * 0.9f, true);
-            const auto release90 = crossing(peak * 0.9f, false);
-            const auto release10 = crossing(peak * 0.1f, false);
-            if (attack10 >= 0.0f && attack90 >= attack10)
-                envelope.attackTime = attack90 - attack10;
-            if (release90 >= 0.0f && release10 >= release90)
-                envelope.releaseTime = release10 - release90;
-        }
+        scopeCapture.prepare(sampleRate, getScopeSettings(), 1.0 / scopeFrameRate);
+        workerScopeSettingsVersion = version;
+    }
+    if (scopeCapture.push(left, right, count))
+    {
+        markSnapshotChanged(SnapshotSection::Scope);
+        scopeFramePending = true;
     }
 }
 
 /**
- * @brief
- * @param frequency
- * @param thd
+ * @brief マルチトーンの1フレームを平均し、セットの最後のフレームで各トーンのTHDを算出
+ * @return すべてのセットを測定し終えた場合はtrue
  */
-void AnalyzerEngine::updateTHDSweep(float frequency, float thd)
+bool AnalyzerEngine::analyseMultitoneFrame()
 {
+    const auto& plan = MultitonePlanner::forOrder(workerFFTOrder);
+    const auto frame = static_cast<int>(workerResult.frameCount);
+    const auto setIndex = frame / MultitonePlanner::framesPerSet;
+    const auto position = frame % MultitonePlanner::framesPerSet;
+    if (setIndex >= static_cast<int>(plan.sets.size()))
+        return true;
+    if (position < MultitonePlanner::settleFrames)
+        return false;
+
+    // Every tone is periodic in the frame, so plain power averaging removes
+    // noise without smearing the tone or harmonic bins.
+    const auto bins = workerFFTSize / 2;
+    if (position == MultitonePlanner::settleFrames)
+        std::fill(averagedOutputPowerL.begin(), averagedOutputPowerL.end(), 0.0);
+    for (int bin = 1; bin < bins; ++bin)
+        averagedOutputPowerL[static_cast<size_t>(bin)] += std::norm(std::complex<double>(
+            complexDataL[static_cast<size_t>(2 * bin)], complexDataL[static_cast<size_t>(2 * bin + 1)]));
+    if (position != MultitonePlanner::framesPerSet - 1)
+        return false;
+
+    const auto& set = plan.sets[static_cast<size_t>(setIndex)];
+    const auto binScale = workerFFTSize / plan.fftSize;
+    const auto binWidth = workerResult.sampleRate / workerFFTSize;
+    auto power = [this](int bin) { return averagedOutputPowerL[static_cast<size_t>(bin)]; };
     auto& frequencies = workerResult.thdSweepFrequencies;
     auto& values = workerResult.thdSweepValues;
-    const auto existing = std::find_if(frequencies.begin(), frequencies.end(),
-        [frequency](float value)
-        {
-            return std::abs(value - frequency) <= juce::jmax(1.0f, frequency * 0.001f);
-        });
-    if (existing == frequencies.end())
-    {
-        frequencies.push_back(frequency);
-        values.push_back(thd);
-    }
-    else
+
+    double setTonePower = 0.0;
+    auto& isTone = multitoneToneBins;
+    std::fill(isTone.begin(), isTone.end(), false);
+    for (const auto planBin : set.toneBins)
     {
-        values[static_cast<size_t>(std::distance(frequencies.begin(), existing))] = thd;
+        const auto tone = planBin * binScale;
+        // Harmonics above Nyquist alias onto other bins and are not counted,
+        // matching the single-tone THD.
+        double harmonicsPower = 0.0;
+        for (int harmonic = 2; harmonic <= MultitonePlanner::maxHarmonic && tone * harmonic < bins;
+             ++harmonic)
+            harmonicsPower += power(tone * harmonic);
+        const auto fundamentalPower = power(tone);
+        const auto thd = fundamentalPower > 1.0e-20
+            ? static_cast<float>(std::sqrt(harmonicsPower / fundamentalPower) * 100.0)
+            : 0.0f;
+
+        const auto frequency = static_cast<float>(tone * binWidth);
+        const auto insertAt = std::lower_bound(frequencies.begin(), frequencies.end(), frequency);
+        values.insert(values.begin() + std::distance(frequencies.begin(), insertAt), thd);
+        frequencies.insert(insertAt, frequency);
+
+        for (int bin = tone - 1; bin <= tone + 1; ++bin)
+        {
+            isTone[static_cast<size_t>(bin)] = true;
+            setTonePower += power(bin);
+        }
     }
+
+    // Everything outside the tone main lobes is distortion or noise.
+    multitoneTonePower += setTonePower;
+    for (int bin = 2; bin < bins; ++bin)
+        if (!isTone[static_cast<size_t>(bin)])
+            multitoneResidualPower += power(bin);
+
+    if (setIndex + 1 < static_cast<int>(plan.sets.size()))
+        return false;
+
+    const auto nearest = std::min_element(frequencies.begin(), frequencies.end(),
+        [this](float a, float b)
+        {
+            return std::abs(a - completedFrameFrequency) < std::abs(b - completedFrameFrequency);
+        });
+    workerResult.thd = nearest == frequencies.end()
+        ? 0.0f
+        : values[static_cast<size_t>(std::distance(frequencies.begin(), nearest))];
+    workerResult.thdPlusN = multitoneTonePower > 1.0e-20
+        ? static_cast<float>(std::sqrt(multitoneResidualPower / multitoneTonePower) * 100.0)
+        : 0.0f;
+    return true;
 }
 
 /**
@@ -1102,6 +1651,7 @@ void AnalyzerEngine::drainPerformanceFifo()
         for (int i = 0; i < size2; ++i)
             updatePerformanceMetrics(performanceQueue[static_cast<size_t>(start2 + i)]);
         performanceFifo.finishedRead(size1 + size2);
+        fifoSpaceAvailable.signal();
     }
 }
 
@@ -1111,39 +1661,88 @@ void AnalyzerEngine::drainPerformanceFifo()
  */
 void AnalyzerEngine::updatePerformanceMetrics(const PerformanceRecord& record)
 {
-    performanceHistory[static_cast<size_t>(performanceHistoryWrite)] = record.processingTimeMs;
+    performanceHistory[static_cast<size_t>(performanceHistoryWrite)] = record;
     performanceHistoryWrite = (performanceHistoryWrite + 1) % performanceHistorySize;
     performanceHistoryCount = juce::jmin(performanceHistoryCount + 1, performanceHistorySize);
 
+    constexpr auto nanosecondsPerMillisecond = 1.0e6;
+    const auto processingTimeMs = static_cast<double>(record.wallNanoseconds) / nanosecondsPerMillisecond;
     auto& performance = workerResult.performance;
     performance.processingTimeHistory.resize(static_cast<size_t>(performanceHistoryCount));
-    float sum = 0.0f, peak = 0.0f;
     for (int i = 0; i < performanceHistoryCount; ++i)
     {
         const auto index = (performanceHistoryWrite - performanceHistoryCount + i
                             + performanceHistorySize) % performanceHistorySize;
-        const auto value = performanceHistory[static_cast<size_t>(index)];
-        performance.processingTimeHistory[static_cast<size_t>(i)] = value;
-        sum += value;
-        peak = juce::jmax(peak, value);
+        performance.processingTimeHistory[static_cast<size_t>(i)] = static_cast<float>(
+            static_cast<double>(performanceHistory[static_cast<size_t>(index)].wallNanoseconds)
+            / nanosecondsPerMillisecond);
     }
-    performance.averageProcessingTime = sum / static_cast<float>(performanceHistoryCount);
-    performance.peakProcessingTime = peak;
-    auto sorted = performance.processingTimeHistory;
-    std::sort(sorted.begin(), sorted.end());
-    performance.p95ProcessingTime = percentile(sorted, 0.95);
-    performance.p99ProcessingTime = percentile(sorted, 0.99);
+
+    // The averages cover the same blocks as the histogram, so they agree
+    // with the percentiles whichever window is selected.
+    const auto window = requestedPerformanceWindow.load(std::memory_order_relaxed);
+    if (window != performanceHistogram.getWindowSize())
+    {
+        performanceHistogram.setWindowSize(window);
+        performanceWindowRecords = plugin_analyzer::domain::HistoryRing<PerformanceRecord>(window);
+        performanceWallTotal = performanceCpuTotal = 0;
+    }
+    if (window > 0)
+    {
+        if (performanceWindowRecords.size() == window)
+        {
+            performanceWallTotal -= performanceWindowRecords[0].wallNanoseconds;
+            performanceCpuTotal -= performanceWindowRecords[0].cpuNanoseconds;
+        }
+        performanceWindowRecords.push(record);
+    }
+    performanceWallTotal += record.wallNanoseconds;
+    performanceCpuTotal += record.cpuNanoseconds;
+
     performance.bufferSize = record.blockSize;
     performance.sampleRate = activeSampleRate.load(std::memory_order_acquire);
     const auto availableMs = record.blockSize / performance.sampleRate * 1000.0;
+    performanceHistogram.record(processingTimeMs, processingTimeMs > availableMs);
+
+    const auto blocks = static_cast<double>(performanceHistogram.getCount());
+    const auto wallMs = static_cast<double>(performanceWallTotal) / nanosecondsPerMillisecond;
+    const auto cpuMs = static_cast<double>(performanceCpuTotal) / nanosecondsPerMillisecond;
+    performance.averageProcessingTime = static_cast<float>(wallMs / blocks);
+
+    // Wall time minus thread CPU time is what the scheduler took away while
+    // the plug-in was inside processBlock.
+    performance.threadCpuTimeAvailable = BlockTimer::hasThreadCpuTime();
+    performance.contextSwitchesAvailable = BlockTimer::hasContextSwitches();
+    if (performance.threadCpuTimeAvailable)
+    {
+        performance.averageCpuTime = static_cast<float>(cpuMs / blocks);
+        performance.averageOffCpuTime = static_cast<float>(juce::jmax(0.0, wallMs - cpuMs) / blocks);
+    }
+    performance.voluntaryContextSwitches += record.voluntarySwitches;
+    performance.involuntaryContextSwitches += record.involuntarySwitches;
+    if (record.involuntarySwitches > 0)
+        ++performance.preemptedBlocks;
+
+    // Percentiles come from the long-running histogram, so rare spikes that
+    // a short history would miss still show up in p99.9 and the maximum.
+    static constexpr std::array<double, 5> proportions { 0.5, 0.9, 0.95, 0.99, 0.999 };
+    std::array<double, proportions.size()> percentiles {};
+    performanceHistogram.getPercentiles(proportions.data(), percentiles.data(), proportions.size());
+    performance.p50ProcessingTime = static_cast<float>(percentiles[0]);
+    performance.p90ProcessingTime = static_cast<float>(percentiles[1]);
+    performance.p95ProcessingTime = static_cast<float>(percentiles[2]);
+    performance.p99ProcessingTime = static_cast<float>(percentiles[3]);
+    performance.p999ProcessingTime = static_cast<float>(percentiles[4]);
+    performance.peakProcessingTime = static_cast<float>(performanceHistogram.getMax());
+    performance.measuredBlocks = performanceHistogram.getCount();
+    performance.deadlineMisses = performanceHistogram.getMissCount();
     performance.cpuUsagePercent = static_cast<float>(
         performance.averageProcessingTime / availableMs * 100.0);
     performance.droppedAnalysisSamples =
         droppedAnalysisSamples.load(std::memory_order_relaxed);
-    performance.droppedScopeSamples =
-        droppedScopeSamples.load(std::memory_order_relaxed);
     performance.droppedPerformanceRecords =
         droppedPerformanceRecords.load(std::memory_order_relaxed);
+    markSnapshotChanged(SnapshotSection::Performance);
     publishSnapshot();
 }
 
@@ -1154,47 +1753,85 @@ void AnalyzerEngine::publishSnapshot()
 {
     workerResult.performance.droppedAnalysisSamples =
         droppedAnalysisSamples.load(std::memory_order_relaxed);
-    workerResult.performance.droppedScopeSamples =
-        droppedScopeSamples.load(std::memory_order_relaxed);
     workerResult.performance.droppedPerformanceRecords =
         droppedPerformanceRecords.load(std::memory_order_relaxed);
-    auto snapshot = std::make_shared<const AnalysisSnapshot>(workerResult);
-    std::atomic_store_explicit(&publishedSnapshot, std::move(snapshot), std::memory_order_release);
+
+    // Vector assignment reuses the recycled snapshot's capacity, so steady
+    // state publishing neither allocates nor copies unchanged sections.
+    auto& slot = snapshotPool.acquire();
+    auto& snapshot = *slot.value;
+    auto copyIfChanged = [&slot, this](SnapshotSection section, auto&& copy)
+    {
+        const auto index = static_cast<size_t>(section);
+        if (slot.metadata[index] != snapshotVersions[index])
+        {
+            copy();
+            slot.metadata[index] = snapshotVersions[index];
+        }
+    };
+    copyIfChanged(SnapshotSection::Spectrum, [&]
+    {
+        snapshot.magnitudeSpectrumL = workerResult.magnitudeSpectrumL;
+        snapshot.magnitudeSpectrumR = workerResult.magnitudeSpectrumR;
+        snapshot.phaseSpectrumL = workerResult.phaseSpectrumL;
+        snapshot.phaseSpectrumR = workerResult.phaseSpectrumR;
+        snapshot.spectrumDecimation = workerResult.spectrumDecimation;
+    });
+    copyIfChanged(SnapshotSection::Display, [&] { snapshot.display = workerResult.display; });
+    copyIfChanged(SnapshotSection::Harmonics, [&]
+    {
+        snapshot.harmonicLevels = workerResult.harmonicLevels;
+        snapshot.harmonicResponses = workerResult.harmonicResponses;
+    });
+    copyIfChanged(SnapshotSection::THDSweep, [&]
+    {
+        snapshot.thdSweepFrequencies = workerResult.thdSweepFrequencies;
+        snapshot.thdSweepValues = workerResult.thdSweepValues;
+    });
+    copyIfChanged(SnapshotSection::Dynamics, [&]
+    {
+        snapshot.dynamics.compressionRatio = workerResult.dynamics.compressionRatio;
+        snapshot.dynamics.threshold = workerResult.dynamics.threshold;
+        dynamicsInputLevels.copyTo(snapshot.dynamics.inputLevels);
+        dynamicsOutputLevels.copyTo(snapshot.dynamics.outputLevels);
+    });
+    copyIfChanged(SnapshotSection::Envelope, [&] { envelopeTracker.copyTo(snapshot.envelope); });
+    copyIfChanged(SnapshotSection::Scope, [&] { snapshot.scope = scopeCapture.getFrame(); });
+    scopeFramePending = false;
+    copyIfChanged(SnapshotSection::Performance, [&] { snapshot.performance = workerResult.performance; });
+    snapshot.performance.droppedAnalysisSamples = workerResult.performance.droppedAnalysisSamples;
+    snapshot.performance.droppedPerformanceRecords = workerResult.performance.droppedPerformanceRecords;
+    snapshot.thd = workerResult.thd;
+    snapshot.thdPlusN = workerResult.thdPlusN;
+    snapshot.imd = workerResult.imd;
+    snapshot.latencySamples = workerResult.latencySamples;
+    snapshot.sampleRate = workerResult.sampleRate;
+    snapshot.frameCount = workerResult.frameCount;
+    snapshot.measurementComplete = workerResult.measurementComplete;
+    snapshot.display.version = snapshotVersions[static_cast<size_t>(SnapshotSection::Display)];
+    snapshot.sequence = snapshotSequence.load(std::memory_order_relaxed) + 1;
+
+    std::shared_ptr<const AnalysisSnapshot> published = slot.value;
+    std::atomic_store_explicit(&publishedSnapshot, std::move(published), std::memory_order_release);
+    snapshotSequence.store(snapshot.sequence, std::memory_order_release);
+    // Posts at most one pending message however often the worker publishes.
+    triggerAsyncUpdate();
 }
 
 /**
- * @brief
- * @param data
- * @param numSamples
+ * @brief スナップショットの一部が変更されたことを記録
+ * @param section 変更されたセクション
  */
-void AnalyzerEngine::addToScopeFifo(const float* data, int numSamples)
+void AnalyzerEngine::markSnapshotChanged(SnapshotSection section)
 {
-    int start1 = 0, size1 = 0, start2 = 0, size2 = 0;
-    scopeFifo.prepareToWrite(numSamples, start1, size1, start2, size2);
-    if (size1 > 0)
-        std::copy(data, data + size1, scopeData.begin() + start1);
-    if (size2 > 0)
-        std::copy(data + size1, data + size1 + size2, scopeData.begin() + start2);
-    scopeFifo.finishedWrite(size1 + size2);
-    if (size1 + size2 < numSamples)
-        droppedScopeSamples.fetch_add(static_cast<uint64_t>(numSamples - size1 - size2),
-                                      std::memory_order_relaxed);
+    snapshotVersions[static_cast<size_t>(section)] = ++snapshotVersionCounter;
 }
 
 /**
- * @brief
- * @param dest
- * @param numSamples
- * @return
+ * @brief スナップショットのすべてのセクションが変更されたことを記録
  */
-int AnalyzerEngine::readFromScopeFifo(float* dest, int numSamples)
+void AnalyzerEngine::markSnapshotChanged()
 {
-    int start1 = 0, size1 = 0, start2 = 0, size2 = 0;
-    scopeFifo.prepareToRead(numSamples, start1, size1, start2, size2);
-    if (size1 > 0)
-        std::copy(scopeData.begin() + start1, scopeData.begin() + start1 + size1, dest);
-    if (size2 > 0)
-        std::copy(scopeData.begin() + start2, scopeData.begin() + start2 + size2, dest + size1);
-    scopeFifo.finishedRead(size1 + size2);
-    return size1 + size2;
+    for (auto& version : snapshotVersions)
+        version = ++snapshotVersionCounter;
 }
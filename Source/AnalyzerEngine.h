@@ -2,13 +2,24 @@
 
 #include <JuceHeader.h>
 #include "Application/AnalysisService.h"
+#include "Domain/EnvelopeTracker.h"
+#include "Domain/HarmonicTracker.h"
+#include "Domain/HistoryRing.h"
+#include "Domain/LatencyHistogram.h"
+#include "Domain/LogSpectrumResampler.h"
+#include "Domain/ScopeCapture.h"
+#include "FFTBackend.h"
+#include "HarmonicZoomAnalyzer.h"
+#include "RecyclingPool.h"
+#include "SweepDeconvolver.h"
 #include "TestSignalGenerator.h"
 #include <array>
 #include <atomic>
 #include <memory>
 
 class AnalyzerEngine : public plugin_analyzer::application::AnalysisService,
-                       private juce::Thread
+                       private juce::Thread,
+                       private juce::AsyncUpdater
 {
 public:
     using AnalysisMode = plugin_analyzer::domain::AnalysisMode;
@@ -16,6 +27,7 @@ public:
     using EnvelopeData = plugin_analyzer::domain::EnvelopeData;
     using PerformanceData = plugin_analyzer::domain::PerformanceData;
     using AnalysisSnapshot = plugin_analyzer::domain::AnalysisSnapshot;
+    using ScopeSettings = plugin_analyzer::domain::ScopeSettings;
 
     AnalyzerEngine();
     ~AnalyzerEngine() override;
@@ -24,6 +36,12 @@ public:
     void releaseResources();
     void setBlockSize(int newBlockSize);
 
+    static constexpr int minFFTOrder = 8;
+    static constexpr int maxFFTOrder = 20;
+    // Published spectra are peak-decimated to at most this many points.
+    static constexpr int maxPublishedBins = 1 << 14;
+    static constexpr int maxDisplayPoints = 8192;
+
     void setFFTOrder(int newFftOrder);
     int getFFTOrder() const { return requestedFFTOrder.load(std::memory_order_relaxed); }
     int getFFTSize() const { return 1 << getFFTOrder(); }
@@ -49,52 +67,124 @@ public:
     void setTestFrequency(double frequency) override;
     double getTestFrequency() const { return requestedFrequency.load(std::memory_order_relaxed); }
 
+    void setDisplayResolution(int numPoints) override;
+    void setSpectrumSmoothing(int octaveFraction) override;
+    void setScopeSettings(const ScopeSettings& settings) override;
+    ScopeSettings getScopeSettings() const;
+
     std::shared_ptr<const AnalysisSnapshot> getAnalysisSnapshot() const override;
+    uint64_t getSnapshotSequence() const override
+    {
+        return snapshotSequence.load(std::memory_order_acquire);
+    }
+    void addSnapshotListener(plugin_analyzer::application::SnapshotListener* listener) override;
+    void removeSnapshotListener(plugin_analyzer::application::SnapshotListener* listener) override;
+
+    // 0 keeps Performance percentiles over the whole measurement.
+    void setPerformanceWindow(size_t numBlocks);
+    size_t getPerformanceWindow() const
+    {
+        return requestedPerformanceWindow.load(std::memory_order_relaxed);
+    }
+
+    // Publishes Harmonic-mode THD from a sliding DFT this often; 0 publishes
+    // it once per FFT frame.
+    void setHarmonicTrackingInterval(double milliseconds);
+    double getHarmonicTrackingInterval() const
+    {
+        return requestedTrackingInterval.load(std::memory_order_relaxed);
+    }
 
     void processAudio(juce::AudioBuffer<float>& buffer);
     void triggerImpulseAnalysis();
 
-    void addToScopeFifo(const float* data, int numSamples);
-    int readFromScopeFifo(float* dest, int numSamples) override;
+    // Offline rendering drives processAudio() from the calling thread instead
+    // of an audio device. It must not run concurrently with device callbacks.
+    void setNonRealtime(bool shouldRenderOffline);
+    bool isNonRealtime() const { return nonRealtime.load(std::memory_order_relaxed); }
+    int renderOffline(int numSamples);
+    bool waitForAnalysisIdle(int timeoutMs = -1);
 
-    enum { scopeFifoSize = 32768 };
+    // Stops the worker without releasing anything. Blocks queued meanwhile
+    // wait in the FIFOs for resumeAnalysis(); blocks that no longer fit are
+    // dropped and counted.
+    void suspendAnalysis();
+    void resumeAnalysis();
 
 private:
-    struct AnalysisSample
+    // Samples travel in three float rings; the measurement state they belong
+    // to is tagged once per audio block in a small side FIFO.
+    struct AnalysisBlockTag
     {
-        float input = 0.0f;
-        float outputL = 0.0f;
-        float outputR = 0.0f;
         AnalysisMode mode = AnalysisMode::Linear;
         uint32_t generation = 0;
         float measurementFrequency = 1000.0f;
+        int numSamples = 0;
     };
 
+    // Durations of one processBlock call. CPU time and context switches are
+    // deltas of the audio thread's counters and stay 0 where unavailable.
     struct PerformanceRecord
     {
-        float processingTimeMs = 0.0f;
+        juce::int64 wallNanoseconds = 0;
+        juce::int64 cpuNanoseconds = 0;
+        uint32_t voluntarySwitches = 0;
+        uint32_t involuntarySwitches = 0;
         int blockSize = 0;
     };
 
     static constexpr int analysisFifoSize = 1 << 17;
+    static constexpr int analysisTagFifoSize = 2048;
     static constexpr int performanceFifoSize = 512;
     static constexpr int performanceHistorySize = 100;
+    static constexpr size_t snapshotPoolSize = 4;
+    static constexpr size_t dynamicsHistorySize = 1000;
+    static constexpr size_t envelopeHistorySize = 4096;
+    // Scope frames complete at most this often.
+    static constexpr double scopeFrameRate = 60.0;
+
+    // Published snapshots are copied per section; a section is only copied
+    // into a recycled snapshot when its version has changed since.
+    enum class SnapshotSection
+    {
+        Spectrum,
+        Harmonics,
+        THDSweep,
+        Dynamics,
+        Envelope,
+        Performance,
+        Display,
+        Scope
+    };
+    static constexpr size_t snapshotSectionCount = 8;
+    using SnapshotVersions = std::array<uint64_t, snapshotSectionCount>;
 
     void run() override;
+    void handleAsyncUpdate() override;
     void drainAnalysisFifo();
     void drainPerformanceFifo();
-    void processAnalysisSamples(const AnalysisSample* samples, int count);
+    void processAnalysisBlock(const AnalysisBlockTag& tag, int start, int count);
     void processCompletedFFT(AnalysisMode mode);
     void configureWorkerFFT(int order);
     void resetWorkerAnalysis(uint32_t generation);
     void publishSnapshot();
+    void markSnapshotChanged(SnapshotSection section);
+    void markSnapshotChanged();
+    void publishSpectra();
+    void updateDisplaySpectra();
+    void updatePowerPrefixSums();
+    double bandPower(int firstBin, int lastBin) const;
     void calculateTHD(AnalysisSnapshot& result);
+    void publishTrackedHarmonics();
     void calculateIMD(AnalysisSnapshot& result);
+    void completeSweepMeasurement();
     void analyzeDynamicsSample(float input, float output);
     void analyzeEnvelopeSample(float output);
-    void updateTHDSweep(float frequency, float thd);
+    void captureScope(const float* left, const float* right, int count);
+    bool analyseMultitoneFrame();
     void updatePerformanceMetrics(const PerformanceRecord& record);
     void resizeAudioBuffers(int blockSize);
+    bool waitForFifoSpace(const juce::AbstractFifo& fifo, int numSamples);
 
     std::unique_ptr<juce::AudioProcessor> pluginInstance;
     juce::AudioPluginFormatManager formatManager;
@@ -112,25 +202,39 @@ private:
     std::atomic<double> requestedFrequency { 1000.0 };
     std::atomic<int> requestedFFTOrder { 11 };
     std::atomic<uint32_t> requestedGeneration { 1 };
-    std::atomic<uint32_t> completedLinearGeneration { 0 };
+    std::atomic<uint32_t> completedMeasurementGeneration { 0 };
     uint32_t audioGeneration = 0;
     bool audioIsAnalyzing = false;
+    std::atomic<bool> nonRealtime { false };
+    juce::AudioBuffer<float> offlineBuffer;
+    juce::WaitableEvent fifoSpaceAvailable;
 
     juce::AbstractFifo analysisFifo { analysisFifoSize };
-    std::vector<AnalysisSample> analysisQueue;
+    std::vector<float> analysisInput, analysisOutputL, analysisOutputR;
+    juce::AbstractFifo analysisTagFifo { analysisTagFifoSize };
+    std::array<AnalysisBlockTag, analysisTagFifoSize> analysisTags {};
     juce::AbstractFifo performanceFifo { performanceFifoSize };
     std::array<PerformanceRecord, performanceFifoSize> performanceQueue {};
 
-    juce::AbstractFifo scopeFifo { scopeFifoSize };
-    std::vector<float> scopeData;
-
     int workerFFTOrder = 11;
     int workerFFTSize = 1 << 11;
-    std::unique_ptr<juce::dsp::FFT> forwardFFT;
-    std::unique_ptr<juce::dsp::WindowingFunction<float>> window;
+    // Plans belong to the worker; the pointers below refer into the cache.
+    FFTPlanCache fftPlans;
+    FFTBackend* forwardFFT = nullptr;
+    const std::vector<float>* window = nullptr;
+    // Frames are captured straight into the transform buffers, windowed
+    // segment by segment, so no separate full-frame copy is held.
     std::vector<float> complexDataL, complexDataR;
     std::vector<float> complexInput;
-    std::vector<float> accumulationBufferInput, accumulationBufferL, accumulationBufferR;
+    std::vector<float> displaySpectrumL, displaySpectrumR;
+    // powerPrefixSumL[b] is the linear power of bins 0..b-1 of the left
+    // display spectrum, so any band power is one subtraction.
+    std::vector<double> powerPrefixSumL;
+    std::vector<float> latencyRotation;
+    int latencyRotationSamples = -1;
+    std::vector<float> decimatedSpectrum;
+    // Log-spaced, smoothed copies of the published spectra for drawing.
+    plugin_analyzer::domain::LogSpectrumResampler displayResampler;
     std::vector<double> averagedInputPower, averagedOutputPowerL, averagedOutputPowerR;
     int spectralAverageCount = 0;
     int accumulationIndex = 0;
@@ -143,18 +247,53 @@ private:
     int dynamicsWindowSamples = 0;
     double envelopeTimeSeconds = 0.0;
     float envelopePrevious = 0.0f;
+    // Histories live in rings and are only laid out in order when published.
+    plugin_analyzer::domain::HistoryRing<float> dynamicsInputLevels { dynamicsHistorySize };
+    plugin_analyzer::domain::HistoryRing<float> dynamicsOutputLevels { dynamicsHistorySize };
+    plugin_analyzer::domain::EnvelopeTracker envelopeTracker { envelopeHistorySize };
+
+    SweepDeconvolver sweepDeconvolver;
+    HarmonicZoomAnalyzer harmonicZoom;
+    plugin_analyzer::domain::HarmonicTracker harmonicTracker;
+    bool harmonicTracking = false;
+    // The scope taps the analysis rings, so it sees every output block in
+    // every mode without a FIFO of its own.
+    plugin_analyzer::domain::ScopeCapture scopeCapture;
+    uint32_t workerScopeSettingsVersion = 0;
+    bool scopeFramePending = false;
 
-    int thdSweepSamplesAtFrequency = 0;
-    int thdSweepBin = 0;
-    static constexpr int thdSweepSteps = 30;
+    double multitoneTonePower = 0.0;
+    double multitoneResidualPower = 0.0;
+    // Tone main-lobe bins of the current multitone set; sized with the FFT.
+    std::vector<bool> multitoneToneBins;
 
     AnalysisSnapshot workerResult;
     std::shared_ptr<const AnalysisSnapshot> publishedSnapshot;
-    std::array<float, performanceHistorySize> performanceHistory {};
+    RecyclingPool<AnalysisSnapshot, SnapshotVersions> snapshotPool { snapshotPoolSize };
+    SnapshotVersions snapshotVersions {};
+    uint64_t snapshotVersionCounter = 0;
+    std::atomic<uint64_t> snapshotSequence { 0 };
+    // Only touched on the message thread; the worker posts one coalesced
+    // update per burst of publications.
+    juce::ListenerList<plugin_analyzer::application::SnapshotListener> snapshotListeners;
+    plugin_analyzer::domain::LatencyHistogram performanceHistogram;
+    // Exact wall and CPU time totals over the same blocks as the histogram;
+    // the ring holds the windowed blocks so the oldest can be subtracted.
+    plugin_analyzer::domain::HistoryRing<PerformanceRecord> performanceWindowRecords { 1 };
+    juce::int64 performanceWallTotal = 0;
+    juce::int64 performanceCpuTotal = 0;
+    std::atomic<size_t> requestedPerformanceWindow { 0 };
+    std::atomic<double> requestedTrackingInterval { 0.0 };
+    std::atomic<int> requestedDisplayPoints { 512 };
+    std::atomic<int> requestedSmoothing { 0 };
+    juce::SpinLock scopeSettingsLock;
+    ScopeSettings requestedScopeSettings;
+    std::atomic<uint32_t> scopeSettingsVersion { 1 };
+    // The most recent blocks, only for the processing time sparkline.
+    std::array<PerformanceRecord, performanceHistorySize> performanceHistory {};
     int performanceHistoryWrite = 0;
     int performanceHistoryCount = 0;
     std::atomic<uint64_t> droppedAnalysisSamples { 0 };
-    std::atomic<uint64_t> droppedScopeSamples { 0 };
     std::atomic<uint64_t> droppedPerformanceRecords { 0 };
 
     std::atomic<double> activeSampleRate { 44100.0 };
@@ -2,11 +2,30 @@
 
 #include "../Domain/AnalysisModel.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
 namespace plugin_analyzer::application
 {
+/**
+ * @brief 解析結果の公開を受け取るリスナ
+ *
+ * メッセージスレッドから呼ばれる。前回の通知以降に複数の結果が公開された
+ * 場合も通知は1回にまとめられる。
+ */
+class SnapshotListener
+{
+public:
+    virtual ~SnapshotListener() = default;
+
+    /**
+     * @brief 新しい解析結果が公開された
+     * @param sequence 最新の解析結果の通し番号
+     */
+    virtual void snapshotPublished(std::uint64_t sequence) = 0;
+};
+
 /**
  * @brief プレゼンテーション層から解析機能を利用するための境界
  *
@@ -41,6 +60,24 @@ public:
      */
     virtual void setTestFrequency(double frequency) = 0;
 
+    /**
+     * @brief 表示用スペクトルの点数を設定
+     * @param numPoints 20 Hz〜20 kHzに対数間隔で並べる点の数
+     */
+    virtual void setDisplayResolution(int numPoints) = 0;
+
+    /**
+     * @brief 表示用スペクトルの平滑化幅を設定
+     * @param octaveFraction 1/Nオクターブ平滑化のN（1〜48）。0の場合は平滑化しない
+     */
+    virtual void setSpectrumSmoothing(int octaveFraction) = 0;
+
+    /**
+     * @brief オシロスコープのトリガーと表示範囲を設定
+     * @param settings 取り込み設定。フレームはスナップショットのscopeに公開される
+     */
+    virtual void setScopeSettings(const domain::ScopeSettings& settings) = 0;
+
     /**
      * @brief 最新の解析結果を取得
      * @return 読み取り専用の解析結果
@@ -49,17 +86,27 @@ public:
         getAnalysisSnapshot() const = 0;
 
     /**
-     * @brief 表示用のプラグイン名を取得
-     * @return ロード中のプラグイン名
+     * @brief 最後に公開した解析結果の通し番号を取得
+     * @return 解析結果のsequence
      */
-    [[nodiscard]] virtual std::string getPluginDisplayName() const = 0;
+    [[nodiscard]] virtual std::uint64_t getSnapshotSequence() const = 0;
 
     /**
-     * @brief オシロスコープ用FIFOからサンプルを読み出す
-     * @param destination 読み出し先
-     * @param sampleCount 最大読み出しサンプル数
-     * @return 実際に読み出したサンプル数
+     * @brief 解析結果の公開通知を登録（メッセージスレッドから呼ぶ）
+     * @param listener 登録するリスナ
      */
-    virtual int readFromScopeFifo(float* destination, int sampleCount) = 0;
+    virtual void addSnapshotListener(SnapshotListener* listener) = 0;
+
+    /**
+     * @brief 解析結果の公開通知を解除（メッセージスレッドから呼ぶ）
+     * @param listener 解除するリスナ
+     */
+    virtual void removeSnapshotListener(SnapshotListener* listener) = 0;
+
+    /**
+     * @brief 表示用のプラグイン名を取得
+     * @return ロード中のプラグイン名
+     */
+    [[nodiscard]] virtual std::string getPluginDisplayName() const = 0;
 };
 }
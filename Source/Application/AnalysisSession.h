@@ -26,6 +26,7 @@ struct ModeControls
     bool dynamics = false;
     bool performance = false;
     bool phase = false;
+    bool smoothing = false;
 };
 
 /**
@@ -85,6 +86,7 @@ public:
         result.controls.dynamics = tabIndex == 8;
         result.controls.performance = tabIndex == 9;
         result.controls.phase = tabIndex == 0 || tabIndex == 5 || tabIndex == 6;
+        result.controls.smoothing = tabIndex >= 0 && tabIndex <= 6;
         return result;
     }
 
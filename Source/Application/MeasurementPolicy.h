@@ -0,0 +1,98 @@
+#pragma once
+
+#include "../Domain/AnalysisModel.h"
+#include "../Domain/MultitonePlan.h"
+
+#include <cmath>
+#include <cstdint>
+
+namespace plugin_analyzer::application
+{
+/**
+ * @brief 解析モードごとの測定完了条件
+ *
+ * 連続測定モードは、結果が安定するまでに必要なFFTフレーム数で完了を判定する。
+ * 有限長の測定はスナップショットの完了フラグに従う。
+ */
+class MeasurementPolicy
+{
+public:
+    /**
+     * @brief 測定が完了したかを判定
+     * @param mode 実行中の解析モード
+     * @param snapshot 現在の解析結果
+     * @param fftSize 解析に使用するFFTサイズ
+     * @return 結果を確定してよい場合はtrue
+     */
+    [[nodiscard]] static bool isComplete(domain::AnalysisMode mode,
+                                         const domain::AnalysisSnapshot& snapshot,
+                                         int fftSize)
+    {
+        if (snapshot.measurementComplete)
+            return true;
+        if (usesCompletionFlag(mode))
+            return false;
+        const auto required = requiredFrames(mode, snapshot.sampleRate, fftSize);
+        return required > 0 && snapshot.frameCount >= required;
+    }
+
+    /**
+     * @brief 有限長の測定で、完了をスナップショットのフラグで判定するかを取得
+     * @param mode 解析モード
+     * @return 完了フラグで判定する場合はtrue
+     */
+    [[nodiscard]] static bool usesCompletionFlag(domain::AnalysisMode mode)
+    {
+        return mode == domain::AnalysisMode::Linear
+            || mode == domain::AnalysisMode::Hammerstein
+            || mode == domain::AnalysisMode::THDSweep;
+    }
+
+    /**
+     * @brief 連続測定モードで結果が安定するまでのFFTフレーム数を取得
+     * @param mode 解析モード
+     * @param sampleRate サンプリング周波数
+     * @param fftSize FFTサイズ
+     * @return 必要なフレーム数。完了フラグで判定するモードは完了までの目安
+     */
+    [[nodiscard]] static std::uint32_t requiredFrames(domain::AnalysisMode mode,
+                                                      double sampleRate,
+                                                      int fftSize)
+    {
+        using domain::AnalysisMode;
+        const auto framesFor = [sampleRate, fftSize](double seconds)
+        {
+            return static_cast<std::uint32_t>(
+                       std::ceil(seconds * sampleRate / static_cast<double>(fftSize))) + 1;
+        };
+
+        switch (mode)
+        {
+            case AnalysisMode::Linear: return 0;
+            case AnalysisMode::Harmonic:
+            case AnalysisMode::IMD: return settledFrames;
+            case AnalysisMode::THDSweep:
+                return static_cast<std::uint32_t>(domain::MultitonePlanner::setCount
+                                                  * domain::MultitonePlanner::framesPerSet);
+            case AnalysisMode::WhiteNoise: return noiseAverageFrames;
+            case AnalysisMode::SineSweep: return framesFor(sweepSeconds);
+            case AnalysisMode::Hammerstein: return framesFor(sweepCaptureSeconds);
+            case AnalysisMode::Dynamics: return framesFor(rampSeconds);
+            case AnalysisMode::Performance: return framesFor(performanceSeconds);
+        }
+        return 0;
+    }
+
+private:
+    // The first frame may contain the processor's start-up transient.
+    static constexpr std::uint32_t settledFrames = 3;
+    // The white-noise average uses a 0.9 exponential blend.
+    static constexpr std::uint32_t noiseAverageFrames = 48;
+    // Matches the TestSignalGenerator sweep and ramp defaults.
+    static constexpr double sweepSeconds = 5.0;
+    // The Hammerstein capture adds a tail and rounds up to a power-of-two FFT.
+    static constexpr double sweepCaptureSeconds = 11.0;
+    static constexpr double rampSeconds = 2.0;
+    static constexpr double performanceSeconds = 1.0;
+};
+}
@@ -0,0 +1,563 @@
+#include "BatchAnalysis.h"
+#include "Application/MeasurementPolicy.h"
+
+#include <iostream>
+#include <limits>
+
+namespace
+{
+using AnalysisMode = AnalyzerEngine::AnalysisMode;
+
+constexpr AnalysisMode allModes[] = {
+    AnalysisMode::Linear, AnalysisMode::Harmonic, AnalysisMode::Hammerstein,
+    AnalysisMode::WhiteNoise, AnalysisMode::SineSweep, AnalysisMode::THDSweep,
+    AnalysisMode::IMD, AnalysisMode::Dynamics, AnalysisMode::Performance
+};
+
+/**
+ * @brief float配列をJSON配列へ変換
+ * @param values 変換する値
+ * @return JSON配列
+ */
+juce::var toVar(const std::vector<float>& values)
+{
+    juce::Array<juce::var> array;
+    array.ensureStorageAllocated(static_cast<int>(values.size()));
+    for (const auto value : values)
+        array.add(value);
+    return array;
+}
+
+/**
+ * @brief 相対パスを作業ディレクトリ基準のファイルへ変換
+ * @param path コマンドラインで指定されたパス
+ * @return 対応するファイル
+ */
+juce::File resolvePath(const juce::String& path)
+{
+    return juce::File::getCurrentWorkingDirectory().getChildFile(path);
+}
+}
+
+/**
+ * @brief コマンドラインがバッチ解析の要求かを判定
+ * @param commandLine アプリケーションのコマンドライン
+ * @return --analyzeまたは--analyze-allが含まれる場合はtrue
+ */
+bool BatchAnalyzer::isBatchCommandLine(const juce::String& commandLine)
+{
+    const auto arguments = juce::StringArray::fromTokens(commandLine, true);
+    return arguments.contains("--analyze") || arguments.contains("--analyze-all");
+}
+
+/**
+ * @brief バッチ解析のコマンドライン引数を解析
+ * @param commandLine アプリケーションのコマンドライン
+ * @param options 解析結果の格納先
+ * @param error 失敗時のエラーメッセージ
+ * @return 引数が有効な場合はtrue
+ */
+bool BatchAnalyzer::parseArguments(const juce::String& commandLine,
+                                   BatchAnalysisOptions& options,
+                                   juce::String& error)
+{
+    error.clear();
+    const auto arguments = juce::StringArray::fromTokens(commandLine, true);
+    for (int i = 0; i < arguments.size(); ++i)
+    {
+        const auto argument = arguments[i];
+        if (!argument.startsWith("--"))
+        {
+            error = "Unexpected argument: " + argument;
+            return false;
+        }
+        if (argument == "--analyze-all")
+        {
+            options.analyseKnownPlugins = true;
+            continue;
+        }
+        if (i + 1 >= arguments.size())
+        {
+            error = "Missing value for " + argument;
+            return false;
+        }
+        const auto value = arguments[++i].unquoted();
+
+        if (argument == "--analyze")
+            options.pluginPath = value;
+        else if (argument == "--plugin-description")
+            options.pluginDescriptionFile = resolvePath(value);
+        else if (argument == "--plugin-list")
+            options.pluginListFile = resolvePath(value);
+        else if (argument == "--jobs")
+            options.jobs = value.getIntValue();
+        else if (argument == "--timeout")
+            options.timeout = value.getDoubleValue();
+        else if (argument == "--out")
+            options.outputFile = resolvePath(value);
+        else if (argument == "--fft-order")
+            options.fftOrder = value.getIntValue();
+        else if (argument == "--sample-rate")
+            options.sampleRate = value.getDoubleValue();
+        else if (argument == "--block-size")
+            options.blockSize = value.getIntValue();
+        else if (argument == "--amplitude")
+            options.amplitude = static_cast<float>(value.getDoubleValue());
+        else if (argument == "--frequency")
+            options.frequency = value.getDoubleValue();
+        else if (argument == "--modes")
+        {
+            for (const auto& name : juce::StringArray::fromTokens(value, ",", {}))
+            {
+                const auto trimmed = name.trim();
+                if (trimmed.equalsIgnoreCase("all"))
+                {
+                    for (const auto mode : allModes)
+                        options.modes.addIfNotAlreadyThere(mode);
+                    continue;
+                }
+
+                bool found = false;
+                for (const auto mode : allModes)
+                {
+                    if (trimmed.equalsIgnoreCase(getModeName(mode)))
+                    {
+                        options.modes.addIfNotAlreadyThere(mode);
+                        found = true;
+                    }
+                }
+                if (!found)
+                {
+                    error = "Unknown analysis mode: " + trimmed;
+                    return false;
+                }
+            }
+        }
+        else
+        {
+            error = "Unknown option: " + argument;
+            return false;
+        }
+    }
+
+    if (options.pluginPath.isEmpty() && !options.analyseKnownPlugins
+        && options.pluginDescriptionFile == juce::File())
+        error = "--analyze requires a plug-in path";
+    else if (options.jobs < 0)
+        error = "--jobs must not be negative";
+    else if (options.timeout <= 0.0)
+        error = "--timeout must be positive";
+    else if (options.fftOrder < AnalyzerEngine::minFFTOrder || options.fftOrder > AnalyzerEngine::maxFFTOrder)
+        error = "--fft-order must be between " + juce::String(AnalyzerEngine::minFFTOrder) + " and "
+              + juce::String(AnalyzerEngine::maxFFTOrder);
+    else if (options.sampleRate <= 0.0 || options.blockSize <= 0)
+        error = "--sample-rate and --block-size must be positive";
+    if (error.isNotEmpty())
+        return false;
+
+    if (options.modes.isEmpty())
+        for (const auto mode : allModes)
+            options.modes.add(mode);
+    return true;
+}
+
+/**
+ * @brief ロード済みプラグインを各解析モードで完了までオフライン解析
+ * @param engine 準備済みでプラグインをロードしたエンジン
+ * @param options 実行する解析モードと信号設定
+ * @return 解析モード名をキーとするJSONオブジェクト
+ */
+juce::var BatchAnalyzer::analyse(AnalyzerEngine& engine, const BatchAnalysisOptions& options)
+{
+    using plugin_analyzer::application::MeasurementPolicy;
+
+    engine.setNonRealtime(true);
+    engine.setFFTOrder(options.fftOrder);
+    engine.setInputAmplitude(options.amplitude);
+    engine.setTestFrequency(options.frequency);
+    const auto fftSize = engine.getFFTSize();
+
+    auto* results = new juce::DynamicObject();
+    const juce::var resultsVar(results);
+    for (const auto mode : options.modes)
+    {
+        engine.setAnalysisMode(mode);
+        // Restart explicitly so repeating a mode never reuses stale results.
+        engine.triggerImpulseAnalysis();
+
+        const auto required = MeasurementPolicy::requiredFrames(mode, options.sampleRate, fftSize);
+        const auto frameLimit = juce::jmax<std::uint32_t>(16, required * 4);
+        auto snapshot = engine.getAnalysisSnapshot();
+        for (std::uint32_t frame = 0; frame < frameLimit; ++frame)
+        {
+            if (engine.renderOffline(fftSize) != fftSize)
+                break;
+            snapshot = engine.getAnalysisSnapshot();
+            if (MeasurementPolicy::isComplete(mode, *snapshot, fftSize))
+                break;
+        }
+
+        auto result = snapshotToVar(*snapshot);
+        if (auto* object = result.getDynamicObject())
+            object->setProperty("complete", MeasurementPolicy::isComplete(mode, *snapshot, fftSize));
+        results->setProperty(getModeName(mode), result);
+    }
+    return resultsVar;
+}
+
+/**
+ * @brief 解析結果をJSONオブジェクトへ変換
+ * @param snapshot 変換する解析結果
+ * @return JSONオブジェクト
+ */
+juce::var BatchAnalyzer::snapshotToVar(const AnalyzerEngine::AnalysisSnapshot& snapshot)
+{
+    auto* object = new juce::DynamicObject();
+    const juce::var result(object);
+    object->setProperty("sampleRate", snapshot.sampleRate);
+    object->setProperty("frames", static_cast<int>(snapshot.frameCount));
+    object->setProperty("latencySamples", snapshot.latencySamples);
+    object->setProperty("thd", snapshot.thd);
+    object->setProperty("thdPlusN", snapshot.thdPlusN);
+    object->setProperty("imd", snapshot.imd);
+    object->setProperty("spectrumDecimation", snapshot.spectrumDecimation);
+    object->setProperty("magnitudeL", toVar(snapshot.magnitudeSpectrumL));
+    object->setProperty("magnitudeR", toVar(snapshot.magnitudeSpectrumR));
+    object->setProperty("phaseL", toVar(snapshot.phaseSpectrumL));
+    object->setProperty("phaseR", toVar(snapshot.phaseSpectrumR));
+    object->setProperty("harmonicLevels", toVar(snapshot.harmonicLevels));
+    object->setProperty("thdSweepFrequencies", toVar(snapshot.thdSweepFrequencies));
+    object->setProperty("thdSweepValues", toVar(snapshot.thdSweepValues));
+
+    juce::Array<juce::var> harmonicResponses;
+    for (const auto& response : snapshot.harmonicResponses)
+        harmonicResponses.add(toVar(response));
+    object->setProperty("harmonicResponses", harmonicResponses);
+
+    auto* dynamics = new juce::DynamicObject();
+    dynamics->setProperty("inputLevels", toVar(snapshot.dynamics.inputLevels));
+    dynamics->setProperty("outputLevels", toVar(snapshot.dynamics.outputLevels));
+    dynamics->setProperty("compressionRatio", snapshot.dynamics.compressionRatio);
+    dynamics->setProperty("threshold", snapshot.dynamics.threshold);
+    object->setProperty("dynamics", juce::var(dynamics));
+
+    auto* envelope = new juce::DynamicObject();
+    envelope->setProperty("timePoints", toVar(snapshot.envelope.timePoints));
+    envelope->setProperty("values", toVar(snapshot.envelope.envelopeValues));
+    envelope->setProperty("attackTime", snapshot.envelope.attackTime);
+    envelope->setProperty("releaseTime", snapshot.envelope.releaseTime);
+    object->setProperty("envelope", juce::var(envelope));
+
+    const auto& performanceData = snapshot.performance;
+    auto* performance = new juce::DynamicObject();
+    performance->setProperty("averageMs", performanceData.averageProcessingTime);
+    performance->setProperty("peakMs", performanceData.peakProcessingTime);
+    performance->setProperty("p50Ms", performanceData.p50ProcessingTime);
+    performance->setProperty("p90Ms", performanceData.p90ProcessingTime);
+    performance->setProperty("p95Ms", performanceData.p95ProcessingTime);
+    performance->setProperty("p99Ms", performanceData.p99ProcessingTime);
+    performance->setProperty("p999Ms", performanceData.p999ProcessingTime);
+    performance->setProperty("blocks", static_cast<juce::int64>(performanceData.measuredBlocks));
+    performance->setProperty("deadlineMisses", static_cast<juce::int64>(performanceData.deadlineMisses));
+    if (performanceData.threadCpuTimeAvailable)
+    {
+        performance->setProperty("averageCpuMs", performanceData.averageCpuTime);
+        performance->setProperty("averageOffCpuMs", performanceData.averageOffCpuTime);
+    }
+    if (performanceData.contextSwitchesAvailable)
+    {
+        performance->setProperty("voluntaryContextSwitches",
+                                 static_cast<juce::int64>(performanceData.voluntaryContextSwitches));
+        performance->setProperty("involuntaryContextSwitches",
+                                 static_cast<juce::int64>(performanceData.involuntaryContextSwitches));
+        performance->setProperty("preemptedBlocks",
+                                 static_cast<juce::int64>(performanceData.preemptedBlocks));
+    }
+    performance->setProperty("cpuPercent", performanceData.cpuUsagePercent);
+    performance->setProperty("bufferSize", performanceData.bufferSize);
+    performance->setProperty("droppedAnalysisSamples",
+                             static_cast<juce::int64>(performanceData.droppedAnalysisSamples));
+    object->setProperty("performance", juce::var(performance));
+    return result;
+}
+
+/**
+ * @brief 解析モードのコマンドライン名を取得
+ * @param mode 解析モード
+ * @return 小文字のモード名
+ */
+juce::String BatchAnalyzer::getModeName(AnalysisMode mode)
+{
+    switch (mode)
+    {
+        case AnalysisMode::Linear: return "linear";
+        case AnalysisMode::Harmonic: return "harmonic";
+        case AnalysisMode::Hammerstein: return "hammerstein";
+        case AnalysisMode::WhiteNoise: return "whitenoise";
+        case AnalysisMode::SineSweep: return "sinesweep";
+        case AnalysisMode::THDSweep: return "thdsweep";
+        case AnalysisMode::IMD: return "imd";
+        case AnalysisMode::Dynamics: return "dynamics";
+        case AnalysisMode::Performance: return "performance";
+    }
+    return {};
+}
+
+/**
+ * @brief プラグインをロードして解析し、結果をJSONで出力
+ * @param options バッチ解析の設定
+ * @return プロセス終了コード
+ */
+int BatchAnalyzer::run(const BatchAnalysisOptions& options)
+{
+    AnalyzerEngine engine;
+    engine.prepare(options.sampleRate, options.blockSize);
+    engine.setNonRealtime(true);
+
+    bool loaded = false;
+    if (options.pluginDescriptionFile != juce::File())
+    {
+        juce::PluginDescription description;
+        const auto xml = juce::parseXML(options.pluginDescriptionFile);
+        loaded = xml != nullptr && description.loadFromXml(*xml) && engine.loadPlugin(description);
+    }
+    else
+    {
+        loaded = engine.loadPlugin(resolvePath(options.pluginPath));
+    }
+
+    if (!loaded)
+    {
+        const auto message = engine.getLastPluginError();
+        std::cerr << (message.isNotEmpty() ? message : "The plug-in description could not be read.") << '\n';
+        return 1;
+    }
+
+    auto* report = new juce::DynamicObject();
+    const juce::var reportVar(report);
+    report->setProperty("plugin", engine.getPluginName());
+    report->setProperty("path", options.pluginPath);
+    report->setProperty("sampleRate", options.sampleRate);
+    report->setProperty("blockSize", options.blockSize);
+    report->setProperty("fftOrder", options.fftOrder);
+    report->setProperty("results", analyse(engine, options));
+    engine.releaseResources();
+
+    const auto text = juce::JSON::toString(reportVar, false, 6);
+    if (options.outputFile.getFullPathName().isEmpty())
+    {
+        std::cout << text << '\n';
+        return 0;
+    }
+    if (!options.outputFile.replaceWithText(text))
+    {
+        std::cerr << "Could not write " << options.outputFile.getFullPathName() << '\n';
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief スキャン済みプラグイン一覧を読み込む
+ * @param options --plugin-listが指定されていればそのXMLを使用
+ * @param knownPlugins 読み込み先
+ * @param error 失敗時のエラーメッセージ
+ * @return 一覧を読み込めた場合はtrue
+ */
+bool ParallelBatchRunner::loadKnownPlugins(const BatchAnalysisOptions& options,
+                                           juce::KnownPluginList& knownPlugins,
+                                           juce::String& error)
+{
+    std::unique_ptr<juce::XmlElement> xml;
+    if (options.pluginListFile != juce::File())
+    {
+        xml = juce::parseXML(options.pluginListFile);
+    }
+    else
+    {
+        // Same settings file that MainComponent and PluginScannerComponent use.
+        juce::PropertiesFile::Options propertyOptions;
+        propertyOptions.applicationName = "PluginAnalyzer";
+        propertyOptions.filenameSuffix = "settings";
+        propertyOptions.folderName = "PluginAnalyzer";
+        propertyOptions.osxLibrarySubFolder = "Application Support";
+        juce::PropertiesFile properties(propertyOptions);
+        xml = properties.getXmlValue("knownPluginList");
+    }
+
+    if (xml == nullptr)
+    {
+        error = "No scanned plug-in list was found. Scan in the Browser first or pass --plugin-list.";
+        return false;
+    }
+    knownPlugins.recreateFromXml(*xml);
+    return true;
+}
+
+/**
+ * @brief 1つのプラグインを解析する子プロセスの引数を作成
+ * @param options 親プロセスの解析設定
+ * @param description 解析するプラグイン
+ * @param descriptionFile 解析するPluginDescriptionのXML
+ * @param reportFile 子プロセスが結果を書き込むJSON
+ * @return 実行ファイルを先頭とする引数
+ */
+juce::StringArray ParallelBatchRunner::createChildArguments(const BatchAnalysisOptions& options,
+                                                            const juce::PluginDescription& description,
+                                                            const juce::File& descriptionFile,
+                                                            const juce::File& reportFile)
+{
+    juce::StringArray modes;
+    for (const auto mode : options.modes)
+        modes.add(BatchAnalyzer::getModeName(mode));
+
+    return { juce::File::getSpecialLocation(juce::File::currentExecutableFile).getFullPathName(),
+             "--analyze", description.fileOrIdentifier,
+             "--plugin-description", descriptionFile.getFullPathName(),
+             "--modes", modes.joinIntoString(","),
+             "--fft-order", juce::String(options.fftOrder),
+             "--sample-rate", juce::String(options.sampleRate),
+             "--block-size", juce::String(options.blockSize),
+             "--amplitude", juce::String(options.amplitude),
+             "--frequency", juce::String(options.frequency),
+             "--out", reportFile.getFullPathName() };
+}
+
+/**
+ * @brief 同時に実行する子プロセス数を取得
+ * @param options --jobsの指定。0はCPUコア数
+ * @return 1以上の並列数
+ */
+int ParallelBatchRunner::getJobCount(const BatchAnalysisOptions& options)
+{
+    return juce::jmax(1, options.jobs > 0 ? options.jobs : juce::SystemStats::getNumCpus());
+}
+
+/**
+ * @brief スキャン済みの全プラグインを並列に解析し、1つのレポートへまとめる
+ * @param options バッチ解析の設定
+ * @return 全プラグインが成功した場合は0
+ */
+int ParallelBatchRunner::run(const BatchAnalysisOptions& options)
+{
+    juce::KnownPluginList knownPlugins;
+    juce::String error;
+    if (!loadKnownPlugins(options, knownPlugins, error))
+    {
+        std::cerr << error << '\n';
+        return 1;
+    }
+
+    const auto plugins = knownPlugins.getTypes();
+    const auto jobs = getJobCount(options);
+    const auto workDirectory = juce::File::getSpecialLocation(juce::File::tempDirectory)
+                                   .getNonexistentChildFile("PluginAnalyzerBatch", {}, false);
+    if (!workDirectory.createDirectory())
+    {
+        std::cerr << "Could not create " << workDirectory.getFullPathName() << '\n';
+        return 1;
+    }
+
+    struct RunningJob
+    {
+        int index = 0;
+        std::unique_ptr<juce::ChildProcess> process;
+        juce::File reportFile;
+        juce::uint32 startedAt = 0;
+    };
+
+    juce::Array<juce::var> entries;
+    entries.resize(plugins.size());
+    std::vector<RunningJob> running;
+    int nextIndex = 0;
+    int finished = 0;
+    int failures = 0;
+
+    const auto finish = [&](int index, int exitCode, const juce::File& reportFile, bool timedOut)
+    {
+        const auto& description = plugins.getReference(index);
+        auto* entry = new juce::DynamicObject();
+        entry->setProperty("name", description.name);
+        entry->setProperty("format", description.pluginFormatName);
+        entry->setProperty("identifier", description.createIdentifierString());
+        entry->setProperty("exitCode", exitCode);
+
+        const auto report = reportFile.existsAsFile() ? juce::JSON::parse(reportFile) : juce::var();
+        if (!timedOut && exitCode == 0 && report.isObject())
+        {
+            entry->setProperty("report", report);
+        }
+        else
+        {
+            entry->setProperty("error", timedOut ? "timed out"
+                                        : exitCode < 0 ? "The analysis process could not be launched."
+                                                       : "The plug-in failed or crashed during analysis.");
+            ++failures;
+        }
+        entries.set(index, juce::var(entry));
+        std::cerr << '[' << ++finished << '/' << plugins.size() << "] "
+                  << description.name << (timedOut ? " (timed out)" : exitCode == 0 ? "" : " (failed)") << '\n';
+    };
+
+    while (nextIndex < plugins.size() || !running.empty())
+    {
+        while (nextIndex < plugins.size() && static_cast<int>(running.size()) < jobs)
+        {
+            const auto index = nextIndex++;
+            const auto descriptionFile = workDirectory.getChildFile(juce::String(index) + ".xml");
+            const auto reportFile = workDirectory.getChildFile(juce::String(index) + ".json");
+            auto process = std::make_unique<juce::ChildProcess>();
+            const auto& description = plugins.getReference(index);
+            const auto xml = description.createXml();
+            if (xml == nullptr || !xml->writeTo(descriptionFile)
+                || !process->start(createChildArguments(options, description, descriptionFile, reportFile), 0))
+            {
+                finish(index, -1, reportFile, false);
+                continue;
+            }
+            running.push_back({ index, std::move(process), reportFile, juce::Time::getMillisecondCounter() });
+        }
+
+        // The millisecond counter is 32-bit, so longer timeouts are clamped.
+        const auto timeoutMs = static_cast<juce::uint32>(juce::jlimit(
+            0.0, static_cast<double>(std::numeric_limits<juce::uint32>::max()), options.timeout * 1000.0));
+        for (auto job = running.begin(); job != running.end();)
+        {
+            // A plug-in that hangs in its constructor, prepareToPlay or the
+            // render must not stall the rest of the library. A child that has
+            // already exited is never reported as timed out.
+            const auto isRunning = job->process->isRunning();
+            const auto timedOut = isRunning
+                && juce::Time::getMillisecondCounter() - job->startedAt > timeoutMs;
+            if (isRunning && !timedOut)
+            {
+                ++job;
+                continue;
+            }
+            if (timedOut)
+                job->process->kill();
+            finish(job->index, static_cast<int>(job->process->getExitCode()), job->reportFile, timedOut);
+            job = running.erase(job);
+        }
+
+        if (!running.empty())
+            juce::Thread::sleep(20);
+    }
+
+    auto* report = new juce::DynamicObject();
+    const juce::var reportVar(report);
+    report->setProperty("jobs", jobs);
+    report->setProperty("plugins", entries);
+    report->setProperty("failed", failures);
+    workDirectory.deleteRecursively();
+
+    const auto text = juce::JSON::toString(reportVar, false, 6);
+    if (options.outputFile.getFullPathName().isEmpty())
+        std::cout << text << '\n';
+    else if (!options.outputFile.replaceWithText(text))
+    {
+        std::cerr << "Could not write " << options.outputFile.getFullPathName() << '\n';
+        return 1;
+    }
+    return failures == 0 ? 0 : 1;
+}
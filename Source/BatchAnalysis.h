@@ -0,0 +1,65 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "AnalyzerEngine.h"
+
+// Headless batch analysis for build servers. The analyser hosts the plug-in
+// without a window, audio device or UI timer and renders every requested mode
+// offline until its measurement is complete.
+struct BatchAnalysisOptions
+{
+    juce::String pluginPath;
+    juce::Array<AnalyzerEngine::AnalysisMode> modes;
+    int fftOrder = 11;
+    double sampleRate = 48000.0;
+    int blockSize = 512;
+    float amplitude = 0.5f;
+    double frequency = 1000.0;
+    juce::File outputFile;
+
+    // Set by the parallel runner so a child analyses exactly one scanned type,
+    // including shell plug-ins and formats whose identifier is not a file.
+    juce::File pluginDescriptionFile;
+
+    // --analyze-all: every type in the scanned KnownPluginList, in parallel.
+    bool analyseKnownPlugins = false;
+    juce::File pluginListFile;
+    int jobs = 0;
+    // --timeout: seconds one child may run before it is killed and its entry
+    // reported as timed out, so a hung plug-in cannot stall the library run.
+    double timeout = 600.0;
+};
+
+class BatchAnalyzer final
+{
+public:
+    static bool isBatchCommandLine(const juce::String& commandLine);
+    static bool parseArguments(const juce::String& commandLine,
+                               BatchAnalysisOptions& options,
+                               juce::String& error);
+
+    static juce::var analyse(AnalyzerEngine& engine, const BatchAnalysisOptions& options);
+    static juce::var snapshotToVar(const AnalyzerEngine::AnalysisSnapshot& snapshot);
+    static juce::String getModeName(AnalyzerEngine::AnalysisMode mode);
+
+    static int run(const BatchAnalysisOptions& options);
+};
+
+// Analyses a whole plug-in library by keeping one sandboxed child process per
+// core busy. Each child is this executable in single-plug-in --analyze mode, so
+// it owns its own engine, worker thread and FIFOs, and a crashing plug-in only
+// fails its own entry in the combined report.
+class ParallelBatchRunner final
+{
+public:
+    static bool loadKnownPlugins(const BatchAnalysisOptions& options,
+                                 juce::KnownPluginList& knownPlugins,
+                                 juce::String& error);
+    static juce::StringArray createChildArguments(const BatchAnalysisOptions& options,
+                                                  const juce::PluginDescription& description,
+                                                  const juce::File& descriptionFile,
+                                                  const juce::File& reportFile);
+    static int getJobCount(const BatchAnalysisOptions& options);
+
+    static int run(const BatchAnalysisOptions& options);
+};
@@ -0,0 +1,84 @@
+#include "BlockTimer.h"
+#include <chrono>
+
+#if JUCE_LINUX || JUCE_BSD
+ #include <sys/resource.h>
+ #include <time.h>
+#elif JUCE_MAC
+ #include <time.h>
+#endif
+
+namespace
+{
+juce::int64 steadyNanoseconds() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+}
+
+/**
+ * @brief 経過時間のみを読み取る
+ * @return steady_clockのナノ秒
+ */
+BlockTimer::Reading BlockTimer::readWallClock() noexcept
+{
+    Reading reading;
+    reading.wallNanoseconds = steadyNanoseconds();
+    return reading;
+}
+
+/**
+ * @brief 経過時間と呼び出しスレッドのCPU時間、コンテキストスイッチ数を読み取る
+ * @return 計測値。取得できない項目は0
+ */
+BlockTimer::Reading BlockTimer::readThread() noexcept
+{
+    Reading reading;
+    reading.wallNanoseconds = steadyNanoseconds();
+
+   #if JUCE_LINUX || JUCE_BSD || JUCE_MAC
+    timespec cpu {};
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu) == 0)
+        reading.cpuNanoseconds = static_cast<juce::int64>(cpu.tv_sec) * 1000000000
+                               + static_cast<juce::int64>(cpu.tv_nsec);
+   #endif
+
+   #if JUCE_LINUX && defined (RUSAGE_THREAD)
+    rusage usage {};
+    if (getrusage(RUSAGE_THREAD, &usage) == 0)
+    {
+        reading.voluntarySwitches = static_cast<juce::int64>(usage.ru_nvcsw);
+        reading.involuntarySwitches = static_cast<juce::int64>(usage.ru_nivcsw);
+    }
+   #endif
+    return reading;
+}
+
+/**
+ * @brief スレッドCPU時間を取得できるか
+ * @return 取得できる場合はtrue
+ */
+bool BlockTimer::hasThreadCpuTime() noexcept
+{
+    // GetThreadTimes only advances once per scheduler tick (about 15.6 ms),
+    // far coarser than one audio block, so Windows reports no CPU time.
+   #if JUCE_LINUX || JUCE_BSD || JUCE_MAC
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+/**
+ * @brief スレッド単位のコンテキストスイッチ数を取得できるか
+ * @return 取得できる場合はtrue
+ */
+bool BlockTimer::hasContextSwitches() noexcept
+{
+   #if JUCE_LINUX && defined (RUSAGE_THREAD)
+    return true;
+   #else
+    return false;
+   #endif
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Timing backend for one processBlock call on the audio thread. Wall time
+// comes from steady_clock in nanoseconds. Where the platform exposes them,
+// the calling thread's CPU time and voluntary/involuntary context switches
+// are read as well, so compute cost can be separated from time spent
+// pre-empted or blocked. Every call is lock-free and allocation-free.
+class BlockTimer final
+{
+public:
+    struct Reading
+    {
+        juce::int64 wallNanoseconds = 0;
+        juce::int64 cpuNanoseconds = 0;
+        juce::int64 voluntarySwitches = 0;
+        juce::int64 involuntarySwitches = 0;
+    };
+
+    // Wall time only; used when thread counters are not wanted.
+    static Reading readWallClock() noexcept;
+
+    // Wall time plus the calling thread's CPU time and context switches.
+    static Reading readThread() noexcept;
+
+    static bool hasThreadCpuTime() noexcept;
+    static bool hasContextSwitches() noexcept;
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// Min/max level-of-detail pyramid over one curve. Level 0 is the curve
+// itself and every further level halves the point count, keeping the
+// minimum and maximum of each pair, so a drawn range can pick the coarsest
+// level that still has at most one entry per pixel and emit two vertices
+// (min and max) per entry without losing a peak.
+class CurvePyramid
+{
+public:
+    struct Entry
+    {
+        float minimum = 0.0f;
+        float maximum = 0.0f;
+    };
+
+    void build(const std::vector<float>& values)
+    {
+        const auto size = values.size();
+        levels.resize(1);
+        levels[0].resize(size);
+        for (size_t i = 0; i < size; ++i)
+            levels[0][i] = { values[i], values[i] };
+
+        while (levels.back().size() > 1)
+        {
+            const auto& finer = levels.back();
+            std::vector<Entry> coarser((finer.size() + 1) / 2);
+            for (size_t i = 0; i < coarser.size(); ++i)
+            {
+                const auto& first = finer[2 * i];
+                const auto& second = finer[std::min(2 * i + 1, finer.size() - 1)];
+                coarser[i] = { std::min(first.minimum, second.minimum),
+                               std::max(first.maximum, second.maximum) };
+            }
+            levels.push_back(std::move(coarser));
+        }
+    }
+
+    size_t getNumPoints() const { return levels.empty() ? 0 : levels[0].size(); }
+    int getNumLevels() const { return static_cast<int>(levels.size()); }
+
+    // The finest level whose entries are at least pointsPerPixel points wide.
+    int chooseLevel(double pointsPerPixel) const
+    {
+        if (pointsPerPixel <= 1.0 || levels.empty())
+            return 0;
+        const auto level = static_cast<int>(std::ceil(std::log2(pointsPerPixel)));
+        return std::min(level, getNumLevels() - 1);
+    }
+
+    const std::vector<Entry>& getLevel(int level) const
+    {
+        return levels[static_cast<size_t>(level)];
+    }
+
+private:
+    std::vector<std::vector<Entry>> levels;
+};
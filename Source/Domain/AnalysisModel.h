@@ -45,27 +45,120 @@ struct EnvelopeData
 
 /**
  * @brief オーディオ処理時間とドロップ数をまとめた性能解析結果
+ *
+ * 平均とprocessingTimeHistoryは直近のブロック、パーセンタイルと最大値、
+ * 締め切り超過数は測定開始から（またはウィンドウ内の）全ブロックが対象。
+ * CPU時間はオーディオスレッドが実際に計算していた時間で、経過時間との差は
+ * プリエンプションや待機に費やされた時間。コンテキストスイッチ数は測定開始からの累計。
  */
 struct PerformanceData
 {
     float averageProcessingTime = 0.0f;
     float peakProcessingTime = 0.0f;
+    float p50ProcessingTime = 0.0f;
+    float p90ProcessingTime = 0.0f;
     float p95ProcessingTime = 0.0f;
     float p99ProcessingTime = 0.0f;
+    float p999ProcessingTime = 0.0f;
+    float averageCpuTime = 0.0f;
+    float averageOffCpuTime = 0.0f;
+    bool threadCpuTimeAvailable = false;
+    bool contextSwitchesAvailable = false;
+    std::uint64_t voluntaryContextSwitches = 0;
+    std::uint64_t involuntaryContextSwitches = 0;
+    std::uint64_t preemptedBlocks = 0;
+    std::uint64_t measuredBlocks = 0;
+    std::uint64_t deadlineMisses = 0;
     float cpuUsagePercent = 0.0f;
     int bufferSize = 0;
     double sampleRate = 0.0;
     std::uint64_t droppedAnalysisSamples = 0;
-    std::uint64_t droppedScopeSamples = 0;
     std::uint64_t droppedPerformanceRecords = 0;
     std::vector<float> processingTimeHistory;
 };
 
+/**
+ * @brief 表示用に対数間隔の周波数へ再標本化したスペクトル
+ *
+ * frequenciesの各点に対応する値を持つ。octaveFractionは適用した
+ * 1/Nオクターブ平滑化のNで、0は平滑化なし。versionは内容が変わるたびに増加する。
+ */
+struct DisplaySpectrum
+{
+    std::vector<float> frequencies;
+    std::vector<float> magnitudeL;
+    std::vector<float> magnitudeR;
+    std::vector<float> phaseL;
+    std::vector<float> phaseR;
+    std::vector<std::vector<float>> harmonicResponses;
+    int octaveFraction = 0;
+    std::uint64_t version = 0;
+};
+
+/**
+ * @brief オシロスコープのトリガー条件
+ */
+enum class ScopeTrigger
+{
+    Free,
+    Rising,
+    Falling
+};
+
+/**
+ * @brief オシロスコープの取り込み設定
+ *
+ * トリガーは左チャンネルがlevelを指定方向に横切った位置。holdOffは
+ * 前のフレームの終わりから次のトリガーを受け付けるまでの時間（秒）。
+ */
+struct ScopeSettings
+{
+    ScopeTrigger trigger = ScopeTrigger::Rising;
+    float level = 0.0f;
+    double holdOff = 0.0;
+    double timeSpan = 0.01;
+    int columns = 512;
+
+    bool operator==(const ScopeSettings& other) const
+    {
+        return trigger == other.trigger && level == other.level && holdOff == other.holdOff
+            && timeSpan == other.timeSpan && columns == other.columns;
+    }
+    bool operator!=(const ScopeSettings& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief 描画用に間引いたオシロスコープの1フレーム
+ *
+ * minimum/maximumは列ごとの最小値と最大値で、1列は
+ * windowSamples / 列数のサンプルを表す。xyLeft/xyRightは同じ時刻の
+ * 左右のサンプル組（XY表示用）。sequenceはフレームごとに増加する。
+ */
+struct ScopeFrame
+{
+    std::vector<float> minimumL;
+    std::vector<float> maximumL;
+    std::vector<float> minimumR;
+    std::vector<float> maximumR;
+    std::vector<float> xyLeft;
+    std::vector<float> xyRight;
+    int windowSamples = 0;
+    bool triggered = false;
+    std::uint64_t sequence = 0;
+};
+
 /**
  * @brief UIへ公開する読み取り専用の解析結果
  *
  * 公開後のインスタンスは変更しない。利用側は描画や表示更新が完了するまで
- * 同じ共有ポインタを保持する。
+ * 同じ共有ポインタを保持する。frameCountは現在の測定開始から解析した
+ * FFTフレーム数、measurementCompleteは有限長の測定が完了したことを示す。
+ * harmonicResponsesはHammerstein測定のH1..H10で、基本波のFFTビンごとに
+ * 励振振幅に対するk次高調波のレベル（dB）を持つ。スペクトルの各点は
+ * spectrumDecimation個の連続したFFTビンを表し、その中で最大のビンの値を持つ。
+ * displayは同じスペクトルを描画用に変換したもの。scopeは測定の状態に
+ * 関係なく出力波形から取り込んだ最新のオシロスコープのフレーム。
+ * sequenceは公開ごとに1ずつ増加する通し番号。
  */
 struct AnalysisSnapshot
 {
@@ -76,6 +169,9 @@ struct AnalysisSnapshot
     std::vector<float> harmonicLevels;
     std::vector<float> thdSweepFrequencies;
     std::vector<float> thdSweepValues;
+    std::vector<std::vector<float>> harmonicResponses;
+    DisplaySpectrum display;
+    ScopeFrame scope;
     DynamicsData dynamics;
     EnvelopeData envelope;
     PerformanceData performance;
@@ -83,6 +179,10 @@ struct AnalysisSnapshot
     float thdPlusN = 0.0f;
     float imd = 0.0f;
     int latencySamples = 0;
+    int spectrumDecimation = 1;
     double sampleRate = 44100.0;
+    std::uint32_t frameCount = 0;
+    std::uint64_t sequence = 0;
+    bool measurementComplete = false;
 };
 }
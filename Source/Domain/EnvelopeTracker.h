@@ -0,0 +1,135 @@
+#pragma once
+
+#include "AnalysisModel.h"
+#include "HistoryRing.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace plugin_analyzer::domain
+{
+/**
+ * @brief エンベロープ履歴とアタック・リリース時間を逐次更新
+ *
+ * ピークは測定開始からの最大値。アタックはピークの10%から90%へ最初に
+ * 到達するまで、リリースはピーク以降に90%から10%へ下がるまでの時間。
+ * 到達点の探索位置は前にしか進まないため、1値あたりの処理は償却O(1)。
+ */
+class EnvelopeTracker
+{
+public:
+    /**
+     * @brief コンストラクタ
+     * @param capacity 保持するエンベロープ点の最大数
+     */
+    explicit EnvelopeTracker(std::size_t capacity)
+        : timePoints(capacity), values(capacity)
+    {
+    }
+
+    /**
+     * @brief 履歴と到達点を破棄
+     */
+    void reset()
+    {
+        timePoints.clear();
+        values.clear();
+        peak = 0.0f;
+        attack10 = attack90 = release90 = release10 = {};
+    }
+
+    /**
+     * @brief エンベロープ点を追加し、到達点を更新
+     * @param time 時刻（秒）
+     * @param value エンベロープ値
+     */
+    void push(float time, float value)
+    {
+        timePoints.push(time);
+        values.push(value);
+
+        if (value > peak)
+        {
+            // A higher peak raises both rising levels, so their first
+            // crossings can only move later; release restarts at the new peak.
+            peak = value;
+            if (peak > minimumPeak)
+            {
+                advanceRising(attack10, peak * 0.1f);
+                advanceRising(attack90, peak * 0.9f);
+            }
+            release90 = release10 = {};
+            return;
+        }
+
+        if (peak <= minimumPeak)
+            return;
+        if (!release90.found && value <= peak * 0.9f)
+            release90 = { values.getEndSequence() - 1, time, true };
+        if (!release10.found && value <= peak * 0.1f)
+            release10 = { values.getEndSequence() - 1, time, true };
+    }
+
+    [[nodiscard]] std::size_t size() const { return values.size(); }
+
+    /**
+     * @brief アタック時間を取得
+     * @return 秒。到達点が揃っていない場合は0
+     */
+    [[nodiscard]] float getAttackTime() const
+    {
+        return attack10.found && attack90.found && attack90.time >= attack10.time
+             ? attack90.time - attack10.time : 0.0f;
+    }
+
+    /**
+     * @brief リリース時間を取得
+     * @return 秒。到達点が揃っていない場合は0
+     */
+    [[nodiscard]] float getReleaseTime() const
+    {
+        return release90.found && release10.found && release10.time >= release90.time
+             ? release10.time - release90.time : 0.0f;
+    }
+
+    /**
+     * @brief 古い順の履歴と現在のアタック・リリース時間をコピー
+     * @param envelope コピー先
+     */
+    void copyTo(EnvelopeData& envelope) const
+    {
+        timePoints.copyTo(envelope.timePoints);
+        values.copyTo(envelope.envelopeValues);
+        envelope.attackTime = getAttackTime();
+        envelope.releaseTime = getReleaseTime();
+    }
+
+private:
+    static constexpr float minimumPeak = 1.0e-6f;
+
+    struct Crossing
+    {
+        std::uint64_t sequence = 0;
+        float time = 0.0f;
+        bool found = false;
+    };
+
+    void advanceRising(Crossing& crossing, float level)
+    {
+        // A crossing that has left the ring keeps its time until a higher
+        // level forces a new search, which then starts at the oldest point.
+        auto sequence = crossing.sequence < values.getFirstSequence() ? values.getFirstSequence()
+                                                                      : crossing.sequence;
+        if (crossing.found && sequence == crossing.sequence && values.atSequence(sequence) >= level)
+            return;
+        // The newest point is the peak itself, so the search always ends.
+        while (values.atSequence(sequence) < level)
+            ++sequence;
+        crossing = { sequence, timePoints.atSequence(sequence), true };
+    }
+
+    HistoryRing<float> timePoints;
+    HistoryRing<float> values;
+    float peak = 0.0f;
+    Crossing attack10, attack90, release90, release10;
+};
+}
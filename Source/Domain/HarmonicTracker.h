@@ -0,0 +1,129 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+namespace plugin_analyzer::domain
+{
+/**
+ * @brief スライディングDFTで基本波とH2..H10を1サンプルごとに追跡
+ *
+ * 窓はFFTフレームと同じ長さの矩形窓。テスト信号はビンの中心に量子化される
+ * ため、各高調波は互いに漏れ込まない。各ビンは窓内の位置を位相の基準に
+ * 保持するので、加算と削除に同じ回転子を使え、誤差は窓を一周するたびに
+ * 回転子を1へ戻すことで蓄積しない。
+ */
+class HarmonicTracker
+{
+public:
+    static constexpr int maxHarmonics = 10;
+
+    /**
+     * @brief 窓と追跡するビンを設定し、履歴を破棄
+     * @param windowSize 窓のサンプル数（FFTサイズ）
+     * @param fundamentalBin 基本波のビン
+     * @param hopSize 結果を更新する間隔（サンプル）
+     */
+    void prepare(int windowSize, int fundamentalBin, int hopSize)
+    {
+        size = std::max(2, windowSize);
+        bin = fundamentalBin;
+        hop = std::max(1, hopSize);
+        numHarmonics = 0;
+        while (numHarmonics < maxHarmonics && (numHarmonics + 1) * bin < size / 2)
+            ++numHarmonics;
+        constexpr auto twoPi = 6.283185307179586476925286766559;
+        for (int harmonic = 0; harmonic <= numHarmonics; ++harmonic)
+            rotations[static_cast<std::size_t>(harmonic)] =
+                std::polar(1.0, -twoPi * harmonic * bin / size);
+        history.assign(static_cast<std::size_t>(size), 0.0f);
+        reset();
+    }
+
+    void reset()
+    {
+        std::fill(history.begin(), history.end(), 0.0f);
+        sums.fill({});
+        phasors.fill({ 1.0, 0.0 });
+        sumOfSquares = 0.0;
+        position = 0;
+        filled = 0;
+        hopPosition = 0;
+    }
+
+    [[nodiscard]] int getWindowSize() const { return size; }
+    [[nodiscard]] int getFundamentalBin() const { return bin; }
+    [[nodiscard]] int getHopSize() const { return hop; }
+    [[nodiscard]] int getNumHarmonics() const { return numHarmonics; }
+
+    /**
+     * @brief 1サンプルを窓へ追加し、最も古いサンプルを削除
+     * @param sample 出力サンプル
+     * @return 窓が満たされた後、更新間隔に達した場合はtrue
+     */
+    bool push(float sample)
+    {
+        auto& oldest = history[static_cast<std::size_t>(position)];
+        const auto delta = static_cast<double>(sample) - oldest;
+        sumOfSquares += static_cast<double>(sample) * sample - static_cast<double>(oldest) * oldest;
+        oldest = sample;
+        // Index 0 tracks DC so the residual excludes any offset.
+        for (std::size_t harmonic = 0; harmonic <= static_cast<std::size_t>(numHarmonics); ++harmonic)
+        {
+            sums[harmonic] += delta * phasors[harmonic];
+            phasors[harmonic] *= rotations[harmonic];
+        }
+
+        if (++position == size)
+        {
+            position = 0;
+            phasors.fill({ 1.0, 0.0 });
+        }
+        filled = std::min(filled + 1, size);
+        if (++hopPosition < hop)
+            return false;
+        hopPosition = 0;
+        return filled == size;
+    }
+
+    /**
+     * @brief 高調波の平均パワーを取得
+     * @param harmonic 1が基本波
+     * @return 窓内の平均二乗値
+     */
+    [[nodiscard]] double getHarmonicPower(int harmonic) const
+    {
+        const auto n = static_cast<double>(size);
+        return 2.0 * std::norm(sums[static_cast<std::size_t>(harmonic)]) / (n * n);
+    }
+
+    /**
+     * @brief 直流と基本波を除いた広帯域のパワーを取得
+     * @return 高調波と雑音の平均二乗値
+     */
+    [[nodiscard]] double getResidualPower() const
+    {
+        const auto n = static_cast<double>(size);
+        const auto dc = std::norm(sums[0]) / (n * n);
+        return std::max(0.0, sumOfSquares / n - dc - getHarmonicPower(1));
+    }
+
+private:
+    int size = 2;
+    int bin = 1;
+    int hop = 1;
+    int numHarmonics = 0;
+    int position = 0;
+    int filled = 0;
+    int hopPosition = 0;
+    double sumOfSquares = 0.0;
+    std::vector<float> history;
+    std::array<std::complex<double>, maxHarmonics + 1> sums {};
+    std::array<std::complex<double>, maxHarmonics + 1> phasors {};
+    std::array<std::complex<double>, maxHarmonics + 1> rotations {};
+};
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace plugin_analyzer::domain
+{
+/**
+ * @brief 容量固定の時系列リングバッファ
+ *
+ * 容量に達した後は最も古い値を上書きするため、追加は常にO(1)。
+ * 各値には追加順の通し番号が付き、上書き済みかどうかを判定できる。
+ */
+template <typename Value>
+class HistoryRing
+{
+public:
+    /**
+     * @brief コンストラクタ
+     * @param capacity 保持する値の最大数
+     */
+    explicit HistoryRing(std::size_t capacity)
+        : values(std::max<std::size_t>(1, capacity))
+    {
+    }
+
+    void clear()
+    {
+        count = 0;
+        nextSequence = 0;
+    }
+
+    /**
+     * @brief 値を追加し、容量を超えた場合は最も古い値を破棄
+     * @param value 追加する値
+     */
+    void push(const Value& value)
+    {
+        values[static_cast<std::size_t>(nextSequence % values.size())] = value;
+        ++nextSequence;
+        count = std::min(count + 1, values.size());
+    }
+
+    [[nodiscard]] std::size_t size() const { return count; }
+    [[nodiscard]] bool empty() const { return count == 0; }
+    [[nodiscard]] std::size_t getCapacity() const { return values.size(); }
+
+    /**
+     * @brief 古い順のインデックスで値を取得
+     * @param index 0が最も古い値
+     * @return 値
+     */
+    [[nodiscard]] const Value& operator[](std::size_t index) const
+    {
+        return atSequence(getFirstSequence() + index);
+    }
+
+    [[nodiscard]] const Value& back() const { return atSequence(nextSequence - 1); }
+
+    // Sequence numbers count every value ever pushed, so a caller can keep a
+    // position across pushes and detect when it has been overwritten.
+    [[nodiscard]] std::uint64_t getFirstSequence() const { return nextSequence - count; }
+    [[nodiscard]] std::uint64_t getEndSequence() const { return nextSequence; }
+
+    [[nodiscard]] const Value& atSequence(std::uint64_t sequence) const
+    {
+        return values[static_cast<std::size_t>(sequence % values.size())];
+    }
+
+    /**
+     * @brief 古い順に並べた値をvectorへコピー
+     * @param destination コピー先。既存の容量を再利用する
+     */
+    void copyTo(std::vector<Value>& destination) const
+    {
+        const auto first = static_cast<std::size_t>(getFirstSequence() % values.size());
+        const auto head = std::min(count, values.size() - first);
+        destination.assign(values.begin() + static_cast<std::ptrdiff_t>(first),
+                           values.begin() + static_cast<std::ptrdiff_t>(first + head));
+        destination.insert(destination.end(), values.begin(),
+                           values.begin() + static_cast<std::ptrdiff_t>(count - head));
+    }
+
+private:
+    std::vector<Value> values;
+    std::size_t count = 0;
+    std::uint64_t nextSequence = 0;
+};
+}
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace plugin_analyzer::domain
+{
+/**
+ * @brief 処理時間の対数バケットヒストグラム
+ *
+ * HDR Histogramと同様に、2の累乗ごとの区間を32個の線形バケットに分けるため、
+ * 相対誤差は約3%以内に収まる。記録はO(1)で、実行全体または直近N件の
+ * スライディングウィンドウを保持できる。
+ */
+class LatencyHistogram
+{
+public:
+    static constexpr int subBucketBits = 5;
+    static constexpr int subBucketCount = 1 << subBucketBits;
+    // 0.1 us resolution; the largest bucket holds roughly 30 hours.
+    static constexpr double ticksPerMillisecond = 10000.0;
+    static constexpr int maxShift = 35;
+    static constexpr int bucketCount = 2 * subBucketCount + maxShift * subBucketCount;
+
+    /**
+     * @brief コンストラクタ
+     * @param windowSize 保持する直近の記録数。0の場合は実行全体
+     */
+    explicit LatencyHistogram(std::size_t windowSize = 0)
+    {
+        setWindowSize(windowSize);
+    }
+
+    /**
+     * @brief スライディングウィンドウの長さを設定し、記録をリセット
+     * @param windowSize 保持する直近の記録数。0の場合は実行全体
+     */
+    void setWindowSize(std::size_t windowSize)
+    {
+        window.assign(windowSize, 0);
+        reset();
+    }
+
+    [[nodiscard]] std::size_t getWindowSize() const { return window.size(); }
+
+    /**
+     * @brief すべての記録を破棄
+     */
+    void reset()
+    {
+        counts.fill(0);
+        std::fill(window.begin(), window.end(), std::uint16_t { 0 });
+        windowWrite = 0;
+        count = 0;
+        missCount = 0;
+        maxTicks = 0;
+    }
+
+    /**
+     * @brief 処理時間を1件記録
+     * @param milliseconds 処理時間（ミリ秒）
+     * @param missedDeadline ブロックの締め切りを超えた場合はtrue
+     */
+    void record(double milliseconds, bool missedDeadline)
+    {
+        const auto ticks = static_cast<std::uint64_t>(
+            std::max(0.0, std::round(milliseconds * ticksPerMillisecond)));
+        const auto bucket = getBucketIndex(ticks);
+
+        if (!window.empty())
+        {
+            // Each window entry packs the bucket index with the miss flag.
+            auto& slot = window[windowWrite];
+            if (count == window.size())
+            {
+                --counts[static_cast<std::size_t>(slot & bucketMask)];
+                if ((slot & missFlag) != 0)
+                    --missCount;
+            }
+            else
+            {
+                ++count;
+            }
+            slot = static_cast<std::uint16_t>(bucket | (missedDeadline ? missFlag : 0));
+            windowWrite = (windowWrite + 1) % window.size();
+        }
+        else
+        {
+            ++count;
+        }
+
+        ++counts[static_cast<std::size_t>(bucket)];
+        if (missedDeadline)
+            ++missCount;
+        maxTicks = std::max(maxTicks, ticks);
+    }
+
+    [[nodiscard]] std::uint64_t getCount() const { return count; }
+    [[nodiscard]] std::uint64_t getMissCount() const { return missCount; }
+
+    /**
+     * @brief 最大値を取得
+     * @return 実行全体の場合は正確な最大値、ウィンドウの場合は最上位バケットの上限
+     */
+    [[nodiscard]] double getMax() const
+    {
+        if (count == 0)
+            return 0.0;
+        if (window.empty())
+            return static_cast<double>(maxTicks) / ticksPerMillisecond;
+        for (auto bucket = bucketCount - 1; bucket >= 0; --bucket)
+            if (counts[static_cast<std::size_t>(bucket)] > 0)
+                return static_cast<double>(getBucketUpperBound(bucket)) / ticksPerMillisecond;
+        return 0.0;
+    }
+
+    /**
+     * @brief 複数のパーセンタイルを1回の走査で取得
+     * @param proportions 昇順の割合（0..1）
+     * @param results 結果（ミリ秒）の格納先
+     * @param numValues 要素数
+     */
+    void getPercentiles(const double* proportions, double* results, std::size_t numValues) const
+    {
+        std::size_t next = 0;
+        std::uint64_t cumulative = 0;
+        const auto maximum = getMax();
+        for (int bucket = 0; bucket < bucketCount && next < numValues; ++bucket)
+        {
+            cumulative += counts[static_cast<std::size_t>(bucket)];
+            while (next < numValues && count > 0
+                   && static_cast<double>(cumulative)
+                          >= std::max(1.0, std::ceil(proportions[next] * static_cast<double>(count))))
+            {
+                // Report the bucket midpoint, but never above the true maximum.
+                const auto midpoint = 0.5 * static_cast<double>(getBucketLowerBound(bucket)
+                                                                + getBucketUpperBound(bucket));
+                results[next++] = std::min(midpoint / ticksPerMillisecond, maximum);
+            }
+        }
+        for (; next < numValues; ++next)
+            results[next] = 0.0;
+    }
+
+    /**
+     * @brief パーセンタイルを取得
+     * @param proportion 割合（0..1）
+     * @return 処理時間（ミリ秒）
+     */
+    [[nodiscard]] double getPercentile(double proportion) const
+    {
+        double result = 0.0;
+        getPercentiles(&proportion, &result, 1);
+        return result;
+    }
+
+private:
+    static constexpr std::uint16_t missFlag = 0x8000;
+    static constexpr std::uint16_t bucketMask = 0x7fff;
+    static_assert(bucketCount <= bucketMask, "Bucket indices must fit beside the miss flag");
+
+    static int getBucketIndex(std::uint64_t ticks)
+    {
+        if (ticks < 2 * subBucketCount)
+            return static_cast<int>(ticks);
+        auto highestBit = 0;
+        for (auto value = ticks; value > 1; value >>= 1)
+            ++highestBit;
+        const auto shift = std::min(highestBit - subBucketBits, maxShift);
+        const auto top = std::min<std::uint64_t>(ticks >> shift, 2 * subBucketCount - 1);
+        return 2 * subBucketCount + (shift - 1) * subBucketCount
+             + static_cast<int>(top - subBucketCount);
+    }
+
+    static std::uint64_t getBucketLowerBound(int bucket)
+    {
+        if (bucket < 2 * subBucketCount)
+            return static_cast<std::uint64_t>(bucket);
+        const auto shift = (bucket - 2 * subBucketCount) / subBucketCount + 1;
+        const auto top = static_cast<std::uint64_t>((bucket - 2 * subBucketCount) % subBucketCount
+                                                    + subBucketCount);
+        return top << shift;
+    }
+
+    static std::uint64_t getBucketUpperBound(int bucket)
+    {
+        if (bucket < 2 * subBucketCount)
+            return static_cast<std::uint64_t>(bucket);
+        const auto shift = (bucket - 2 * subBucketCount) / subBucketCount + 1;
+        return getBucketLowerBound(bucket) + (std::uint64_t { 1 } << shift) - 1;
+    }
+
+    std::array<std::uint64_t, bucketCount> counts {};
+    std::vector<std::uint16_t> window;
+    std::size_t windowWrite = 0;
+    std::uint64_t count = 0;
+    std::uint64_t missCount = 0;
+    std::uint64_t maxTicks = 0;
+};
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+namespace plugin_analyzer::domain
+{
+/**
+ * @brief 線形周波数のスペクトルを対数間隔の表示点へ再標本化
+ *
+ * 各表示点は中心周波数の前後1/(2N)オクターブのビンのパワー平均を持つ
+ * （1/Nオクターブ平滑化）。平滑化幅が表示点の間隔より狭い場合は間隔まで
+ * 広げるため、表示点の間にあるビンも必ずどこかの点に反映される。
+ * 幅の中にビンが無い低域では隣接するビンの間を補間する。位相は振幅で
+ * 重み付けした複素平均の偏角。帯域和は累積和から求めるので1点あたりO(1)。
+ */
+class LogSpectrumResampler
+{
+public:
+    static constexpr double minFrequency = 20.0;
+    static constexpr double maxFrequency = 20000.0;
+    static constexpr int maxOctaveFraction = 48;
+
+    /**
+     * @brief 表示点と平滑化幅を設定
+     * @param numPoints 表示点の数（2以上）
+     * @param octaveFraction 1/Nオクターブ平滑化のN。0の場合は平滑化しない
+     */
+    void prepare(int numPoints, int octaveFraction)
+    {
+        points = std::max(2, numPoints);
+        fraction = std::clamp(octaveFraction, 0, maxOctaveFraction);
+        const auto span = std::log(maxFrequency / minFrequency);
+        frequencies.resize(static_cast<std::size_t>(points));
+        for (int point = 0; point < points; ++point)
+            frequencies[static_cast<std::size_t>(point)] = static_cast<float>(
+                minFrequency * std::exp(span * point / (points - 1)));
+
+        // Half the spacing between points, as a frequency ratio.
+        const auto spacing = std::exp(0.5 * span / (points - 1));
+        const auto smoothing = fraction > 0 ? std::pow(2.0, 0.5 / fraction) : 1.0;
+        halfWidth = std::max(spacing, smoothing);
+    }
+
+    [[nodiscard]] int getNumPoints() const { return points; }
+    [[nodiscard]] int getOctaveFraction() const { return fraction; }
+    [[nodiscard]] const std::vector<float>& getFrequencies() const { return frequencies; }
+
+    /**
+     * @brief dBの振幅と位相を表示点へ変換
+     * @param magnitudes 線形周波数のビンごとの振幅（dB）。ビン0は直流
+     * @param phases ビンごとの位相（ラジアン）。空の場合は位相を出力しない
+     * @param binWidth 1ビンあたりの周波数（Hz）
+     * @param magnitudesOut 表示点ごとの振幅（dB）
+     * @param phasesOut 表示点ごとの位相。phasesが空の場合は空にする
+     */
+    void process(const std::vector<float>& magnitudes, const std::vector<float>& phases,
+                 double binWidth, std::vector<float>& magnitudesOut, std::vector<float>& phasesOut)
+    {
+        const auto bins = static_cast<int>(magnitudes.size());
+        const auto withPhase = phases.size() == magnitudes.size();
+        magnitudesOut.resize(static_cast<std::size_t>(points));
+        phasesOut.resize(withPhase ? static_cast<std::size_t>(points) : 0);
+        if (bins < 2 || binWidth <= 0.0)
+        {
+            std::fill(magnitudesOut.begin(), magnitudesOut.end(), floorDecibels);
+            std::fill(phasesOut.begin(), phasesOut.end(), 0.0f);
+            return;
+        }
+
+        // powerSum[b] and amplitudeSum[b] cover bins 0..b-1.
+        powerSum.resize(static_cast<std::size_t>(bins + 1));
+        amplitudeSum.resize(withPhase ? static_cast<std::size_t>(bins + 1) : 0);
+        powerSum[0] = 0.0;
+        if (withPhase)
+            amplitudeSum[0] = {};
+        for (std::size_t bin = 0; bin < static_cast<std::size_t>(bins); ++bin)
+        {
+            const auto amplitude = std::pow(10.0, magnitudes[bin] / 20.0);
+            powerSum[bin + 1] = powerSum[bin] + amplitude * amplitude;
+            if (withPhase)
+                amplitudeSum[bin + 1] = amplitudeSum[bin] + std::polar(amplitude, static_cast<double>(phases[bin]));
+        }
+
+        for (std::size_t point = 0; point < static_cast<std::size_t>(points); ++point)
+        {
+            const auto centre = frequencies[point] / binWidth;
+            const auto first = std::max(1, static_cast<int>(std::ceil(centre / halfWidth)));
+            const auto last = std::min(bins - 1, static_cast<int>(std::floor(centre * halfWidth)));
+            if (first <= last)
+            {
+                const auto count = static_cast<double>(last - first + 1);
+                const auto power = (powerSum[static_cast<std::size_t>(last + 1)]
+                                    - powerSum[static_cast<std::size_t>(first)]) / count;
+                magnitudesOut[point] = power > 0.0
+                    ? std::max(floorDecibels, static_cast<float>(10.0 * std::log10(power)))
+                    : floorDecibels;
+                if (withPhase)
+                    phasesOut[point] = static_cast<float>(std::arg(
+                        amplitudeSum[static_cast<std::size_t>(last + 1)]
+                        - amplitudeSum[static_cast<std::size_t>(first)]));
+                continue;
+            }
+
+            // No bin inside the window: interpolate between its neighbours.
+            const auto position = std::clamp(centre, 1.0, static_cast<double>(bins - 1));
+            const auto lower = std::min(bins - 2, static_cast<int>(position));
+            const auto t = static_cast<float>(position - lower);
+            const auto below = static_cast<std::size_t>(lower);
+            magnitudesOut[point] = magnitudes[below] + t * (magnitudes[below + 1] - magnitudes[below]);
+            if (withPhase)
+                phasesOut[point] = phases[t < 0.5f ? below : below + 1];
+        }
+    }
+
+private:
+    static constexpr float floorDecibels = -160.0f;
+
+    int points = 2;
+    int fraction = 0;
+    double halfWidth = 1.0;
+    std::vector<float> frequencies;
+    std::vector<double> powerSum;
+    std::vector<std::complex<double>> amplitudeSum;
+};
+}
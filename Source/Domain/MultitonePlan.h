@@ -0,0 +1,239 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+namespace plugin_analyzer::domain
+{
+/**
+ * @brief 同時に再生するマルチトーンの1セット
+ */
+struct MultitoneSet
+{
+    std::vector<int> toneBins;
+    // FFTサイズ1周期分の波形。ピークが1になるように正規化済み
+    std::vector<float> waveform;
+    // 正規化後の各トーンの振幅
+    double toneAmplitude = 0.0;
+};
+
+/**
+ * @brief FFTサイズごとのマルチトーン歪み測定の計画
+ */
+struct MultitonePlan
+{
+    int fftSize = 0;
+    std::vector<MultitoneSet> sets;
+};
+
+/**
+ * @brief 高調波が互いに重ならないマルチトーン刺激を設計
+ *
+ * すべてのトーンをFFTビンの中心に置き、各トーンのH2..H5と2次・3次の
+ * 相互変調積が他のトーンや高調波から2ビン以上離れるように貪欲法で配置する。
+ * 4次以上の相互変調積は高調波のビンに重なることがある。
+ * ビン単位で設計するため、計画はサンプリング周波数に依存しない。
+ */
+class MultitonePlanner
+{
+public:
+    static constexpr int minOrder = 8;
+    static constexpr int maxOrder = 15;
+    static constexpr int maxHarmonic = 5;
+    static constexpr int setCount = 3;
+    static constexpr int targetTones = 30;
+    // Each set plays for one settling frame followed by the averaged frames.
+    static constexpr int settleFrames = 1;
+    static constexpr int averageFrames = 2;
+    static constexpr int framesPerSet = settleFrames + averageFrames;
+
+    /**
+     * @brief FFTサイズに対するマルチトーン計画を作成
+     * @param fftSize FFTサイズ（2の累乗）
+     * @return 各セットのトーンビンと1周期分の波形
+     */
+    [[nodiscard]] static MultitonePlan create(int fftSize)
+    {
+        MultitonePlan plan;
+        plan.fftSize = fftSize;
+        std::vector<Occupancy> occupancy(static_cast<size_t>(setCount));
+        for (auto& set : occupancy)
+            set.intermodulation.push_back(0);
+
+        // Tones are spaced logarithmically up to fs/4 so that H2 of every tone
+        // stays below Nyquist. Each target may move by 15 % to find free bins.
+        const auto lowest = 3.0;
+        const auto highest = static_cast<double>(fftSize / 4);
+        for (int target = 0; target < targetTones; ++target)
+        {
+            const auto centre = lowest * std::pow(highest / lowest,
+                                                  target / static_cast<double>(targetTones - 1));
+            const auto reach = std::max(2, static_cast<int>(centre * 0.15));
+            for (int distance = 0; distance <= reach; ++distance)
+            {
+                const auto placed = [&]
+                {
+                    for (const auto sign : { 1, -1 })
+                    {
+                        const auto bin = static_cast<int>(std::lround(centre)) + sign * distance;
+                        const auto alreadyPlayed = std::any_of(
+                            occupancy.begin(), occupancy.end(), [bin](const Occupancy& set)
+                            {
+                                return std::find(set.tones.begin(), set.tones.end(), bin)
+                                    != set.tones.end();
+                            });
+                        if (bin < 3 || bin > fftSize / 4 || alreadyPlayed)
+                            continue;
+                        for (auto& set : occupancy)
+                            if (tryPlace(set, bin, fftSize))
+                                return true;
+                    }
+                    return false;
+                }();
+                if (placed)
+                    break;
+            }
+        }
+
+        for (const auto& set : occupancy)
+        {
+            if (set.tones.empty())
+                continue;
+            plan.sets.push_back(synthesise(set.tones, fftSize));
+        }
+        return plan;
+    }
+
+    /**
+     * @brief FFT次数ごとに事前計算した計画を取得
+     *
+     * 最初の呼び出しで全次数の計画を作成する。オーディオスレッドで使う前に
+     * メッセージスレッドから一度呼び出しておくこと。
+     * @param order FFT次数
+     * @return 計画
+     */
+    [[nodiscard]] static const MultitonePlan& forOrder(int order)
+    {
+        static const auto plans = []
+        {
+            std::array<MultitonePlan, maxOrder - minOrder + 1> table;
+            for (int index = 0; index < static_cast<int>(table.size()); ++index)
+                table[static_cast<size_t>(index)] = create(1 << (minOrder + index));
+            return table;
+        }();
+        return plans[static_cast<size_t>(std::clamp(order, minOrder, maxOrder) - minOrder)];
+    }
+
+    /**
+     * @brief エイリアスを含めた高調波のビンを取得
+     * @param bin 基本波のビン
+     * @param harmonic 高調波の次数
+     * @param fftSize FFTサイズ
+     * @return 0..fftSize/2に折り返したビン
+     */
+    [[nodiscard]] static int harmonicBin(int bin, int harmonic, int fftSize)
+    {
+        const auto folded = (bin * harmonic) % fftSize;
+        return folded > fftSize / 2 ? fftSize - folded : folded;
+    }
+
+private:
+    struct Occupancy
+    {
+        std::vector<int> tones;
+        std::vector<int> harmonics;
+        std::vector<int> intermodulation;
+    };
+
+    // A Hann-windowed tone on an exact bin also leaks into both neighbours.
+    static bool isNear(const std::vector<int>& bins, int bin)
+    {
+        return std::any_of(bins.begin(), bins.end(),
+                           [bin](int other) { return std::abs(other - bin) < 2; });
+    }
+
+    static bool tryPlace(Occupancy& set, int bin, int fftSize)
+    {
+        const auto occupied = [&set](int candidate)
+        {
+            return isNear(set.tones, candidate) || isNear(set.harmonics, candidate)
+                || isNear(set.intermodulation, candidate);
+        };
+        if (occupied(bin))
+            return false;
+
+        std::vector<int> harmonics;
+        for (int harmonic = 2; harmonic <= maxHarmonic; ++harmonic)
+        {
+            const auto target = harmonicBin(bin, harmonic, fftSize);
+            if (occupied(target) || isNear(harmonics, target) || std::abs(target - bin) < 2)
+                return false;
+            harmonics.push_back(target);
+        }
+
+        // Second- and third-order products with the existing tones must stay
+        // off the tone and harmonic bins that are measured. Products of the
+        // existing tones alone were checked when those tones were placed.
+        std::vector<int> products;
+        const auto accept = [&](int frequency)
+        {
+            const auto product = harmonicBin(std::abs(frequency), 1, fftSize);
+            if (isNear(set.tones, product) || isNear(set.harmonics, product)
+                || isNear(harmonics, product) || std::abs(product - bin) < 2)
+                return false;
+            products.push_back(product);
+            return true;
+        };
+        for (size_t first = 0; first < set.tones.size(); ++first)
+        {
+            const auto tone = set.tones[first];
+            if (!accept(bin + tone) || !accept(bin - tone)
+                || !accept(2 * bin + tone) || !accept(2 * bin - tone)
+                || !accept(bin + 2 * tone) || !accept(bin - 2 * tone))
+                return false;
+            for (size_t second = first + 1; second < set.tones.size(); ++second)
+            {
+                const auto other = set.tones[second];
+                if (!accept(bin + tone + other) || !accept(bin + tone - other)
+                    || !accept(bin - tone + other) || !accept(bin - tone - other))
+                    return false;
+            }
+        }
+
+        set.tones.push_back(bin);
+        set.harmonics.insert(set.harmonics.end(), harmonics.begin(), harmonics.end());
+        set.intermodulation.insert(set.intermodulation.end(), products.begin(), products.end());
+        return true;
+    }
+
+    static MultitoneSet synthesise(const std::vector<int>& tones, int fftSize)
+    {
+        // Schroeder phases keep the crest factor of equal-amplitude tones low.
+        constexpr auto pi = 3.14159265358979323846;
+        const auto count = static_cast<double>(tones.size());
+        std::vector<double> signal(static_cast<size_t>(fftSize), 0.0);
+        for (size_t index = 0; index < tones.size(); ++index)
+        {
+            const auto phase = -pi * static_cast<double>(index * index) / count;
+            const auto increment = 2.0 * pi * tones[index] / fftSize;
+            for (int sample = 0; sample < fftSize; ++sample)
+                signal[static_cast<size_t>(sample)] += std::cos(increment * sample + phase);
+        }
+
+        double peak = 0.0;
+        for (const auto value : signal)
+            peak = std::max(peak, std::abs(value));
+
+        MultitoneSet set;
+        set.toneBins = tones;
+        set.toneAmplitude = 1.0 / peak;
+        set.waveform.resize(signal.size());
+        std::transform(signal.begin(), signal.end(), set.waveform.begin(),
+                       [peak](double value) { return static_cast<float>(value / peak); });
+        return set;
+    }
+};
+}
@@ -0,0 +1,179 @@
+#pragma once
+
+#include "AnalysisModel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace plugin_analyzer::domain
+{
+/**
+ * @brief 出力波形を書き込み位置が一周するリングへ取り込み、トリガー位置から
+ *        1画面分を切り出して列ごとの最小値・最大値へ間引く
+ *
+ * トリガーしたサンプルが画面の左端になる。フリーランではホールドオフを
+ * 過ぎた最初のサンプルがトリガーになる。完成したフレームはその場で
+ * 間引くので、リングは1画面分の長さで足りる。
+ */
+class ScopeCapture
+{
+public:
+    static constexpr int minWindowSamples = 16;
+    static constexpr int maxWindowSamples = 1 << 16;
+    static constexpr int maxXYPoints = 2048;
+
+    /**
+     * @brief 取り込み設定を適用し、取り込み途中の状態を破棄
+     * @param sampleRate サンプリング周波数
+     * @param newSettings トリガーと表示範囲の設定
+     * @param minimumFrameInterval フレームを完成させる最短の間隔（秒）
+     */
+    void prepare(double sampleRate, const ScopeSettings& newSettings, double minimumFrameInterval)
+    {
+        rate = sampleRate;
+        settings = newSettings;
+        window = std::clamp(static_cast<int>(std::lround(settings.timeSpan * sampleRate)),
+                            minWindowSamples, maxWindowSamples);
+        columns = std::clamp(settings.columns, 1, window);
+        // The hold-off also keeps frames from completing faster than the
+        // display can show them.
+        const auto minimumHoldOff = std::lround(minimumFrameInterval * sampleRate) - window;
+        holdOff = std::max<std::int64_t>({ 0, std::lround(settings.holdOff * sampleRate), minimumHoldOff });
+        if (ringL.empty())
+        {
+            ringL.assign(static_cast<std::size_t>(maxWindowSamples), 0.0f);
+            ringR.assign(static_cast<std::size_t>(maxWindowSamples), 0.0f);
+        }
+        reset();
+    }
+
+    void reset()
+    {
+        std::fill(ringL.begin(), ringL.end(), 0.0f);
+        std::fill(ringR.begin(), ringR.end(), 0.0f);
+        writeIndex = 0;
+        written = 0;
+        nextEligible = 0;
+        remaining = 0;
+        previous = 0.0f;
+    }
+
+    [[nodiscard]] double getSampleRate() const { return rate; }
+    [[nodiscard]] const ScopeSettings& getSettings() const { return settings; }
+    [[nodiscard]] int getWindowSamples() const { return window; }
+    [[nodiscard]] const ScopeFrame& getFrame() const { return frame; }
+
+    /**
+     * @brief 左右の出力サンプルを取り込む
+     * @param left 左チャンネル（トリガー元）
+     * @param right 右チャンネル
+     * @param count サンプル数
+     * @return この呼び出し中にフレームが完成した場合はtrue
+     */
+    bool push(const float* left, const float* right, int count)
+    {
+        auto completed = false;
+        for (int i = 0; i < count; ++i)
+        {
+            const auto sample = left[i];
+            ringL[static_cast<std::size_t>(writeIndex)] = sample;
+            ringR[static_cast<std::size_t>(writeIndex)] = right[i];
+            writeIndex = (writeIndex + 1) & (maxWindowSamples - 1);
+            ++written;
+
+            if (remaining == 0 && written > nextEligible && crosses(sample))
+            {
+                remaining = window;
+                triggered = settings.trigger != ScopeTrigger::Free;
+            }
+            previous = sample;
+            if (remaining > 0 && --remaining == 0)
+            {
+                completeFrame();
+                completed = true;
+            }
+        }
+        return completed;
+    }
+
+private:
+    bool crosses(float sample) const
+    {
+        switch (settings.trigger)
+        {
+            case ScopeTrigger::Rising: return previous < settings.level && sample >= settings.level;
+            case ScopeTrigger::Falling: return previous > settings.level && sample <= settings.level;
+            case ScopeTrigger::Free: break;
+        }
+        return true;
+    }
+
+    void completeFrame()
+    {
+        const auto start = writeIndex - window;
+        auto at = [start](const std::vector<float>& ring, std::int64_t offset)
+        {
+            return ring[static_cast<std::size_t>((start + offset) & (maxWindowSamples - 1))];
+        };
+
+        frame.minimumL.resize(static_cast<std::size_t>(columns));
+        frame.maximumL.resize(static_cast<std::size_t>(columns));
+        frame.minimumR.resize(static_cast<std::size_t>(columns));
+        frame.maximumR.resize(static_cast<std::size_t>(columns));
+        for (std::int64_t column = 0; column < columns; ++column)
+        {
+            const auto first = column * window / columns;
+            const auto last = (column + 1) * window / columns;
+            auto minimumL = at(ringL, first), maximumL = minimumL;
+            auto minimumR = at(ringR, first), maximumR = minimumR;
+            for (auto offset = first + 1; offset < last; ++offset)
+            {
+                const auto l = at(ringL, offset);
+                const auto r = at(ringR, offset);
+                minimumL = std::min(minimumL, l);
+                maximumL = std::max(maximumL, l);
+                minimumR = std::min(minimumR, r);
+                maximumR = std::max(maximumR, r);
+            }
+            const auto index = static_cast<std::size_t>(column);
+            frame.minimumL[index] = minimumL;
+            frame.maximumL[index] = maximumL;
+            frame.minimumR[index] = minimumR;
+            frame.maximumR[index] = maximumR;
+        }
+
+        // XY pairs must stay simultaneous, so they are strided, not min/max.
+        const auto stride = (window + maxXYPoints - 1) / maxXYPoints;
+        const auto points = static_cast<std::size_t>(window / stride);
+        frame.xyLeft.resize(points);
+        frame.xyRight.resize(points);
+        for (std::size_t point = 0; point < points; ++point)
+        {
+            const auto offset = static_cast<std::int64_t>(point) * stride;
+            frame.xyLeft[point] = at(ringL, offset);
+            frame.xyRight[point] = at(ringR, offset);
+        }
+
+        frame.windowSamples = window;
+        frame.triggered = triggered;
+        ++frame.sequence;
+        nextEligible = written + holdOff;
+    }
+
+    double rate = 44100.0;
+    ScopeSettings settings;
+    int window = minWindowSamples;
+    int columns = 1;
+    std::int64_t holdOff = 0;
+    std::vector<float> ringL, ringR;
+    int writeIndex = 0;
+    std::int64_t written = 0;
+    std::int64_t nextEligible = 0;
+    int remaining = 0;
+    bool triggered = false;
+    float previous = 0.0f;
+    ScopeFrame frame;
+};
+}
@@ -0,0 +1,378 @@
+#include "FFTBackend.h"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <vector>
+
+#if PLUGIN_ANALYZER_HAS_FFTW
+ #include <fftw3.h>
+#endif
+
+namespace
+{
+constexpr double twoPi = 6.283185307179586476925286766559;
+
+// Mirrors bins 1..size/2-1 into size/2+1..size-1 as complex conjugates.
+void mirrorNegativeFrequencies(float* data, int size) noexcept
+{
+    for (int bin = size / 2 + 1; bin < size; ++bin)
+    {
+        data[2 * bin] = data[2 * (size - bin)];
+        data[2 * bin + 1] = -data[2 * (size - bin) + 1];
+    }
+}
+
+class JuceBackend final : public FFTBackend
+{
+public:
+    explicit JuceBackend(int order) : fft(order) {}
+
+    int getSize() const noexcept override { return fft.getSize(); }
+
+    void performRealForward(float* data) noexcept override
+    {
+        fft.performRealOnlyForwardTransform(data);
+    }
+
+private:
+    juce::dsp::FFT fft;
+};
+
+// A real FFT of size N is computed as a complex FFT of the N/2 even/odd
+// sample pairs followed by one split pass. The complex FFT is a Stockham
+// autosort FFT, so no bit reversal is needed; radix-4 stages are followed
+// by one radix-2 stage when log2(N/2) is odd.
+class StockhamBackend final : public FFTBackend
+{
+public:
+    explicit StockhamBackend(int order)
+        : size(1 << order), half(size / 2)
+    {
+        const auto halfSize = static_cast<size_t>(juce::jmax(1, half));
+        for (auto* buffer : { &realA, &imagA, &realB, &imagB })
+            buffer->assign(halfSize, 0.0f);
+
+        for (int length = half, stride = 1; length > 1;)
+        {
+            Stage stage;
+            stage.length = length;
+            stage.stride = stride;
+            if (length >= 4)
+            {
+                const auto quarter = length / 4;
+                for (auto* table : { &stage.w1Real, &stage.w1Imag, &stage.w2Real,
+                                     &stage.w2Imag, &stage.w3Real, &stage.w3Imag })
+                    table->resize(static_cast<size_t>(quarter));
+                for (int p = 0; p < quarter; ++p)
+                {
+                    const auto index = static_cast<size_t>(p);
+                    const auto angle = -twoPi * p / length;
+                    stage.w1Real[index] = static_cast<float>(std::cos(angle));
+                    stage.w1Imag[index] = static_cast<float>(std::sin(angle));
+                    stage.w2Real[index] = static_cast<float>(std::cos(2.0 * angle));
+                    stage.w2Imag[index] = static_cast<float>(std::sin(2.0 * angle));
+                    stage.w3Real[index] = static_cast<float>(std::cos(3.0 * angle));
+                    stage.w3Imag[index] = static_cast<float>(std::sin(3.0 * angle));
+                }
+                length /= 4;
+                stride *= 4;
+            }
+            else
+            {
+                length /= 2;
+                stride *= 2;
+            }
+            stages.push_back(std::move(stage));
+        }
+
+        splitReal.resize(static_cast<size_t>(half / 2 + 1));
+        splitImag.resize(static_cast<size_t>(half / 2 + 1));
+        for (int bin = 0; bin <= half / 2; ++bin)
+        {
+            const auto angle = -twoPi * bin / size;
+            splitReal[static_cast<size_t>(bin)] = static_cast<float>(std::cos(angle));
+            splitImag[static_cast<size_t>(bin)] = static_cast<float>(std::sin(angle));
+        }
+    }
+
+    int getSize() const noexcept override { return size; }
+
+    void performRealForward(float* data) noexcept override
+    {
+        if (size < 2)
+        {
+            data[1] = 0.0f;
+            return;
+        }
+
+        // z[k] = x[2k] + i x[2k+1]
+        for (int k = 0; k < half; ++k)
+        {
+            realA[static_cast<size_t>(k)] = data[2 * k];
+            imagA[static_cast<size_t>(k)] = data[2 * k + 1];
+        }
+
+        auto* xr = realA.data();
+        auto* xi = imagA.data();
+        auto* yr = realB.data();
+        auto* yi = imagB.data();
+        for (const auto& stage : stages)
+        {
+            if (stage.length >= 4)
+                radix4(stage, xr, xi, yr, yi);
+            else
+                radix2(stage, xr, xi, yr, yi);
+            std::swap(xr, yr);
+            std::swap(xi, yi);
+        }
+
+        // X[k] = E[k] + W^k O[k] with E and O recovered from Z[k] and
+        // conj(Z[n - k]). Bins k and n - k are produced together.
+        data[0] = xr[0] + xi[0];
+        data[1] = 0.0f;
+        data[2 * half] = xr[0] - xi[0];
+        data[2 * half + 1] = 0.0f;
+        for (int k = 1; k <= half / 2; ++k)
+        {
+            const auto index = static_cast<size_t>(k);
+            const auto mirror = static_cast<size_t>(half - k);
+            const auto evenReal = 0.5f * (xr[index] + xr[mirror]);
+            const auto evenImag = 0.5f * (xi[index] - xi[mirror]);
+            const auto oddReal = 0.5f * (xi[index] + xi[mirror]);
+            const auto oddImag = -0.5f * (xr[index] - xr[mirror]);
+            const auto wr = splitReal[index];
+            const auto wi = splitImag[index];
+            const auto rotatedReal = wr * oddReal - wi * oddImag;
+            const auto rotatedImag = wr * oddImag + wi * oddReal;
+            data[2 * k] = evenReal + rotatedReal;
+            data[2 * k + 1] = evenImag + rotatedImag;
+            // W^(n-k) = -conj(W^k)
+            data[2 * (half - k)] = evenReal - rotatedReal;
+            data[2 * (half - k) + 1] = -evenImag + rotatedImag;
+        }
+        mirrorNegativeFrequencies(data, size);
+    }
+
+private:
+    struct Stage
+    {
+        int length = 0;
+        int stride = 0;
+        std::vector<float> w1Real, w1Imag, w2Real, w2Imag, w3Real, w3Imag;
+    };
+
+    static void radix4(const Stage& stage, const float* xr, const float* xi,
+                       float* yr, float* yi) noexcept
+    {
+        const auto quarter = stage.length / 4;
+        const auto s = stage.stride;
+        auto butterfly = [&](int p, int q)
+        {
+            const auto a = q + s * p;
+            const auto b = a + s * quarter;
+            const auto c = b + s * quarter;
+            const auto d = c + s * quarter;
+            const auto apcR = xr[a] + xr[c], apcI = xi[a] + xi[c];
+            const auto amcR = xr[a] - xr[c], amcI = xi[a] - xi[c];
+            const auto bpdR = xr[b] + xr[d], bpdI = xi[b] + xi[d];
+            // j * (b - d)
+            const auto jbmdR = xi[d] - xi[b], jbmdI = xr[b] - xr[d];
+
+            const auto index = static_cast<size_t>(p);
+            const auto out = q + s * 4 * p;
+            yr[out] = apcR + bpdR;
+            yi[out] = apcI + bpdI;
+            auto rotate = [&](float re, float im, float wr, float wi, int slot)
+            {
+                yr[out + slot * s] = re * wr - im * wi;
+                yi[out + slot * s] = re * wi + im * wr;
+            };
+            rotate(amcR - jbmdR, amcI - jbmdI, stage.w1Real[index], stage.w1Imag[index], 1);
+            rotate(apcR - bpdR, apcI - bpdI, stage.w2Real[index], stage.w2Imag[index], 2);
+            rotate(amcR + jbmdR, amcI + jbmdI, stage.w3Real[index], stage.w3Imag[index], 3);
+        };
+
+        // Keep the contiguous index innermost: p in the first stage, q after.
+        if (s == 1)
+        {
+            for (int p = 0; p < quarter; ++p)
+                butterfly(p, 0);
+        }
+        else
+        {
+            for (int p = 0; p < quarter; ++p)
+                for (int q = 0; q < s; ++q)
+                    butterfly(p, q);
+        }
+    }
+
+    static void radix2(const Stage& stage, const float* xr, const float* xi,
+                       float* yr, float* yi) noexcept
+    {
+        const auto s = stage.stride;
+        for (int q = 0; q < s; ++q)
+        {
+            yr[q] = xr[q] + xr[q + s];
+            yi[q] = xi[q] + xi[q + s];
+            yr[q + s] = xr[q] - xr[q + s];
+            yi[q + s] = xi[q] - xi[q + s];
+        }
+    }
+
+    int size;
+    int half;
+    std::vector<Stage> stages;
+    std::vector<float> realA, imagA, realB, imagB;
+    std::vector<float> splitReal, splitImag;
+};
+
+#if PLUGIN_ANALYZER_HAS_FFTW
+class FFTWBackend final : public FFTBackend
+{
+public:
+    explicit FFTWBackend(int order) : size(1 << order)
+    {
+        // The FFTW planner is not thread-safe; only execution is.
+        const std::lock_guard<std::mutex> lock(getPlannerMutex());
+        input = fftwf_alloc_real(static_cast<size_t>(size));
+        output = fftwf_alloc_complex(static_cast<size_t>(size / 2 + 1));
+        // Plans are built on the analysis worker when the FFT size changes;
+        // FFTW_MEASURE would stall it for up to seconds, so only estimate.
+        plan = fftwf_plan_dft_r2c_1d(size, input, output, FFTW_ESTIMATE);
+    }
+
+    ~FFTWBackend() override
+    {
+        const std::lock_guard<std::mutex> lock(getPlannerMutex());
+        fftwf_destroy_plan(plan);
+        fftwf_free(input);
+        fftwf_free(output);
+    }
+
+    int getSize() const noexcept override { return size; }
+
+    void performRealForward(float* data) noexcept override
+    {
+        std::copy(data, data + size, input);
+        fftwf_execute(plan);
+        for (int bin = 0; bin <= size / 2; ++bin)
+        {
+            data[2 * bin] = output[bin][0];
+            data[2 * bin + 1] = output[bin][1];
+        }
+        mirrorNegativeFrequencies(data, size);
+    }
+
+private:
+    static std::mutex& getPlannerMutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    int size;
+    float* input = nullptr;
+    fftwf_complex* output = nullptr;
+    fftwf_plan plan = nullptr;
+};
+#endif
+}
+
+/**
+ * @brief 指定した実装のFFTを作成
+ * @param kind FFTの実装
+ * @param order FFT次数
+ * @return FFT。実装が利用できない場合はJUCEのFFT
+ */
+std::unique_ptr<FFTBackend> FFTBackend::create(Kind kind, int order)
+{
+    switch (kind)
+    {
+        case Kind::Stockham:
+            return std::make_unique<StockhamBackend>(order);
+        case Kind::FFTW:
+           #if PLUGIN_ANALYZER_HAS_FFTW
+            return std::make_unique<FFTWBackend>(order);
+           #else
+            break;
+           #endif
+        case Kind::Juce:
+            break;
+    }
+    return std::make_unique<JuceBackend>(order);
+}
+
+/**
+ * @brief 実装がこのビルドで利用できるか
+ * @param kind FFTの実装
+ * @return 利用できる場合はtrue
+ */
+bool FFTBackend::isAvailable(Kind kind)
+{
+   #if PLUGIN_ANALYZER_HAS_FFTW
+    juce::ignoreUnused(kind);
+    return true;
+   #else
+    return kind != Kind::FFTW;
+   #endif
+}
+
+/**
+ * @brief 既定の実装を取得
+ *
+ * IPPを使わないJUCEの汎用FFTは遅いため、FFTWがあればFFTW、
+ * なければ内蔵のStockham FFTを使う。
+ * @return 既定の実装
+ */
+FFTBackend::Kind FFTBackend::getDefaultKind()
+{
+   #if PLUGIN_ANALYZER_HAS_FFTW
+    return Kind::FFTW;
+   #else
+    return Kind::Stockham;
+   #endif
+}
+
+/**
+ * @brief 実装の表示名を取得
+ * @param kind FFTの実装
+ * @return 表示名
+ */
+const char* FFTBackend::getKindName(Kind kind)
+{
+    switch (kind)
+    {
+        case Kind::Juce: return "JUCE";
+        case Kind::Stockham: return "Stockham";
+        case Kind::FFTW: return "FFTW";
+    }
+    return "JUCE";
+}
+
+/**
+ * @brief コンストラクタ
+ * @param backendKind 作成するFFTの実装
+ */
+FFTPlanCache::FFTPlanCache(FFTBackend::Kind backendKind)
+    : kind(backendKind)
+{
+}
+
+/**
+ * @brief FFT次数に対する計画を取得し、未作成の場合は作成
+ * @param order FFT次数（1..maxOrder）
+ * @return FFTとHann窓
+ */
+const FFTPlanCache::Plan& FFTPlanCache::get(int order)
+{
+    auto& plan = plans[static_cast<size_t>(juce::jlimit(1, maxOrder, order))];
+    if (plan.fft == nullptr)
+    {
+        plan.fft = FFTBackend::create(kind, order);
+        const auto size = static_cast<size_t>(plan.fft->getSize());
+        plan.window.assign(size, 1.0f);
+        juce::dsp::WindowingFunction<float>(size, juce::dsp::WindowingFunction<float>::hann)
+            .multiplyWithWindowingTable(plan.window.data(), size);
+    }
+    return plan;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <memory>
+#include <vector>
+
+// Real forward FFTs for the analysis worker. Every backend works in place on
+// JUCE's performRealOnlyForwardTransform layout: the first size floats hold
+// the real input, and the result is size interleaved complex bins (re, im)
+// with the negative frequencies mirrored as conjugates. The in-tree backend
+// is a radix-4 Stockham FFT on split real/imaginary arrays whose inner loops
+// are contiguous so the compiler vectorises them; FFTW is used instead when
+// the build found it at configure time.
+class FFTBackend
+{
+public:
+    enum class Kind
+    {
+        Juce,
+        Stockham,
+        FFTW
+    };
+
+    virtual ~FFTBackend() = default;
+
+    virtual int getSize() const noexcept = 0;
+
+    // data must hold 2 * getSize() floats.
+    virtual void performRealForward(float* data) noexcept = 0;
+
+    static std::unique_ptr<FFTBackend> create(Kind kind, int order);
+    static bool isAvailable(Kind kind);
+    static Kind getDefaultKind();
+    static const char* getKindName(Kind kind);
+};
+
+// Plans and Hann windows per FFT order, created on first use and kept for the
+// lifetime of the cache so switching orders never rebuilds them. Only the
+// thread that owns the cache may call it.
+class FFTPlanCache final
+{
+public:
+    static constexpr int maxOrder = 20;
+
+    struct Plan
+    {
+        std::unique_ptr<FFTBackend> fft;
+        // JUCE's normalised Hann window as a table, so frames can be windowed
+        // segment by segment while they are captured.
+        std::vector<float> window;
+    };
+
+    explicit FFTPlanCache(FFTBackend::Kind kind = FFTBackend::getDefaultKind());
+
+    const Plan& get(int order);
+    FFTBackend::Kind getKind() const noexcept { return kind; }
+
+private:
+    FFTBackend::Kind kind;
+    std::array<Plan, maxOrder + 1> plans;
+};
@@ -0,0 +1,176 @@
+#include "HarmonicZoomAnalyzer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+/**
+ * @brief 基本波と解析周波数を設定し、状態を初期化
+ * @param sampleRate サンプリング周波数
+ * @param fundamental 基本波の周波数（Hz）
+ */
+void HarmonicZoomAnalyzer::prepare(double sampleRate, double fundamental)
+{
+    currentSampleRate = sampleRate;
+    fundamentalFrequency = fundamental;
+    numHarmonics = 0;
+    while (numHarmonics < maxHarmonics && (numHarmonics + 1) * fundamental < sampleRate * 0.5)
+        ++numHarmonics;
+
+    // The decimated rate covers +-2 f0 around each harmonic; the neighbouring
+    // harmonics land inside the band at +-f0 and never alias onto DC.
+    decimation = juce::jmax(1, static_cast<int>(sampleRate / (4.0 * fundamental)));
+
+    // Three cascaded boxcars of one decimation period, normalised to unit
+    // DC gain, built by two running sums over the boxcar.
+    const auto period = static_cast<size_t>(decimation);
+    std::vector<double> boxcar(period, 1.0);
+    auto convolveWithBoxcar = [period](const std::vector<double>& source)
+    {
+        std::vector<double> result(source.size() + period - 1, 0.0);
+        double running = 0.0;
+        for (size_t i = 0; i < result.size(); ++i)
+        {
+            if (i < source.size())
+                running += source[i];
+            if (i >= period)
+                running -= source[i - period];
+            result[i] = running;
+        }
+        return result;
+    };
+    kernel = convolveWithBoxcar(convolveWithBoxcar(boxcar));
+    kernel.resize(period * kernelBlocks, 0.0);
+    const auto gain = std::accumulate(kernel.begin(), kernel.end(), 0.0);
+    for (auto& weight : kernel)
+        weight /= gain;
+
+    for (int harmonic = 1; harmonic <= numHarmonics; ++harmonic)
+    {
+        const auto index = static_cast<size_t>(harmonic - 1);
+        rotations[index] = std::polar(1.0, -juce::MathConstants<double>::twoPi * harmonic
+                                               * fundamental / sampleRate);
+        decimated[index].resize(static_cast<size_t>(zoomSize));
+    }
+
+    zoomWindow.assign(static_cast<size_t>(zoomSize), 1.0f);
+    juce::dsp::WindowingFunction<float>(static_cast<size_t>(zoomSize),
+                                        juce::dsp::WindowingFunction<float>::hann, false)
+        .multiplyWithWindowingTable(zoomWindow.data(), zoomWindow.size());
+    zoomInput.resize(static_cast<size_t>(zoomSize));
+    zoomOutput.resize(static_cast<size_t>(zoomSize));
+    reset();
+}
+
+/**
+ * @brief 測定途中の状態と結果を破棄
+ */
+void HarmonicZoomAnalyzer::reset()
+{
+    oscillators.fill({ 1.0, 0.0 });
+    for (auto& slots : accumulators)
+        slots.fill({});
+    harmonicPowers.fill(0.0);
+    blockPosition = 0;
+    blockIndex = 0;
+    warmupBlocks = kernelBlocks - 1;
+    decimatedCount = 0;
+    resultAvailable = false;
+}
+
+/**
+ * @brief 出力サンプルを各高調波の帯域へ混合・間引き
+ * @param samples 解析するサンプル
+ * @param numSamples サンプル数
+ * @return この呼び出し中にズーム解析が完了した場合はtrue
+ */
+bool HarmonicZoomAnalyzer::addSamples(const float* samples, int numSamples)
+{
+    auto completed = false;
+    for (int i = 0; i < numSamples; ++i)
+    {
+        // The sample belongs to the output completed with this block and the
+        // two after it, whose kernels it reaches at offsets 2D, D and 0.
+        const auto position = static_cast<size_t>(blockPosition);
+        const auto period = static_cast<size_t>(decimation);
+        const auto current = kernel[position + 2 * period];
+        const auto next = kernel[position + period];
+        const auto last = kernel[position];
+        const auto slot = static_cast<size_t>(blockIndex);
+        const auto x = static_cast<double>(samples[i]);
+        for (size_t harmonic = 0; harmonic < static_cast<size_t>(numHarmonics); ++harmonic)
+        {
+            const auto mixed = x * oscillators[harmonic];
+            auto& slots = accumulators[harmonic];
+            slots[slot] += current * mixed;
+            slots[(slot + 1) % kernelBlocks] += next * mixed;
+            slots[(slot + 2) % kernelBlocks] += last * mixed;
+            oscillators[harmonic] *= rotations[harmonic];
+        }
+
+        if (++blockPosition == decimation && finishBlock())
+            completed = true;
+    }
+    return completed;
+}
+
+/**
+ * @brief 1間引き周期を終え、完成した出力を保存
+ * @return ズーム解析の1フレームが完了した場合はtrue
+ */
+bool HarmonicZoomAnalyzer::finishBlock()
+{
+    const auto slot = static_cast<size_t>(blockIndex);
+    // The first outputs only saw part of their kernel.
+    const auto settled = warmupBlocks == 0;
+    for (size_t harmonic = 0; harmonic < static_cast<size_t>(numHarmonics); ++harmonic)
+    {
+        if (settled)
+            decimated[harmonic][static_cast<size_t>(decimatedCount)] = accumulators[harmonic][slot];
+        accumulators[harmonic][slot] = {};
+        // Rounding in the recursive oscillator would slowly change its gain.
+        oscillators[harmonic] /= std::abs(oscillators[harmonic]);
+    }
+    blockPosition = 0;
+    blockIndex = (blockIndex + 1) % kernelBlocks;
+    if (!settled)
+    {
+        --warmupBlocks;
+        return false;
+    }
+    if (++decimatedCount < zoomSize)
+        return false;
+    analyseFrame();
+    decimatedCount = 0;
+    return true;
+}
+
+/**
+ * @brief 間引き済みの帯域をFFTし、各高調波の中心3ビンのパワーを更新
+ */
+void HarmonicZoomAnalyzer::analyseFrame()
+{
+    for (size_t harmonic = 0; harmonic < static_cast<size_t>(numHarmonics); ++harmonic)
+    {
+        for (size_t i = 0; i < zoomInput.size(); ++i)
+        {
+            const auto value = decimated[harmonic][i] * static_cast<double>(zoomWindow[i]);
+            zoomInput[i] = { static_cast<float>(value.real()), static_cast<float>(value.imag()) };
+        }
+        zoomFFT.perform(zoomInput.data(), zoomOutput.data(), false);
+        // Each harmonic sits exactly on DC; its Hann main lobe is bins -1..1.
+        harmonicPowers[harmonic] = std::norm(std::complex<double>(zoomOutput.front()))
+                                 + std::norm(std::complex<double>(zoomOutput[1]))
+                                 + std::norm(std::complex<double>(zoomOutput.back()));
+    }
+    resultAvailable = true;
+}
+
+/**
+ * @brief ズーム帯域の周波数分解能を取得
+ * @return 1ビンあたりの周波数（Hz）
+ */
+double HarmonicZoomAnalyzer::getResolution() const
+{
+    return currentSampleRate / (static_cast<double>(decimation) * zoomSize);
+}
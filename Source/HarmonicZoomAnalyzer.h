@@ -0,0 +1,68 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <complex>
+#include <vector>
+
+// Decimate-and-mix zoom analysis of the fundamental and its harmonics. Each
+// harmonic is mixed down to DC, low-pass filtered and decimated by a third
+// order CIC kernel, and the decimated band is resolved by a short FFT. The
+// zoomed band spans four fundamentals at a resolution of f0 / 32, so the
+// harmonics stay separated however few display FFT bins lie below them.
+class HarmonicZoomAnalyzer
+{
+public:
+    static constexpr int maxHarmonics = 10;
+    static constexpr int zoomOrder = 7;
+    static constexpr int zoomSize = 1 << zoomOrder;
+
+    void prepare(double sampleRate, double fundamental);
+    void reset();
+    bool addSamples(const float* samples, int numSamples);
+
+    double getSampleRate() const { return currentSampleRate; }
+    double getFundamental() const { return fundamentalFrequency; }
+    int getNumHarmonics() const { return numHarmonics; }
+    // Hz per zoomed bin.
+    double getResolution() const;
+    // Number of input samples needed for one zoomed frame.
+    int getFrameLength() const { return (zoomSize + kernelBlocks - 1) * decimation; }
+
+    bool hasResult() const { return resultAvailable; }
+    // Power of the three zoomed bins around the harmonic in the latest frame.
+    double getHarmonicPower(int harmonic) const
+    {
+        return harmonicPowers[static_cast<size_t>(harmonic - 1)];
+    }
+
+private:
+    // The CIC kernel is three boxcars of one decimation period each, so every
+    // input sample contributes to three consecutive decimated outputs.
+    static constexpr int kernelBlocks = 3;
+
+    bool finishBlock();
+    void analyseFrame();
+
+    double currentSampleRate = 0.0;
+    double fundamentalFrequency = 0.0;
+    int numHarmonics = 0;
+    int decimation = 1;
+    int blockPosition = 0;
+    // Accumulator slot of the output completed by the current block.
+    int blockIndex = 0;
+    int warmupBlocks = 0;
+    int decimatedCount = 0;
+    bool resultAvailable = false;
+
+    std::vector<double> kernel;
+    std::array<std::complex<double>, maxHarmonics> oscillators {};
+    std::array<std::complex<double>, maxHarmonics> rotations {};
+    std::array<std::array<std::complex<double>, kernelBlocks>, maxHarmonics> accumulators {};
+    std::array<std::vector<std::complex<double>>, maxHarmonics> decimated;
+    std::array<double, maxHarmonics> harmonicPowers {};
+
+    juce::dsp::FFT zoomFFT { zoomOrder };
+    std::vector<float> zoomWindow;
+    std::vector<juce::dsp::Complex<float>> zoomInput, zoomOutput;
+};
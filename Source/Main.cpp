@@ -1,6 +1,9 @@
 #include <JuceHeader.h>
 #include "MainComponent.h"
 #include "PluginScanIPC.h"
+#include "BatchAnalysis.h"
+
+#include <iostream>
 
 class PluginAnalyzerApplication  : public juce::JUCEApplication
 {
@@ -29,6 +32,27 @@ public:
             return;
         }
 
+        if (BatchAnalyzer::isBatchCommandLine(commandLine))
+        {
+            // Build-server mode: render every requested analysis offline and
+            // exit with a status code instead of opening the UI.
+            BatchAnalysisOptions options;
+            juce::String error;
+            if (BatchAnalyzer::parseArguments(commandLine, options, error))
+            {
+                setApplicationReturnValue(options.analyseKnownPlugins
+                                              ? ParallelBatchRunner::run(options)
+                                              : BatchAnalyzer::run(options));
+            }
+            else
+            {
+                std::cerr << error << '\n';
+                setApplicationReturnValue(2);
+            }
+            quit();
+            return;
+        }
+
         auto scanner = std::make_unique<PluginScanWorker>();
         if (scanner->initialise(commandLine))
         {
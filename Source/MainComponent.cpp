@@ -42,6 +42,16 @@ MainComponent::MainComponent()
             graphComponent->setShowPhase(showPhaseButton.getToggleState());
     };
     
+    // 分数オクターブ平滑化（解析スレッドで計算）
+    addAndMakeVisible(smoothingBox);
+    smoothingBox.addItem("No Smoothing", 1);
+    for (const auto fraction : { 1, 3, 6, 12, 24, 48 })
+        smoothingBox.addItem("1/" + juce::String(fraction) + " Octave", fraction + 1);
+    smoothingBox.onChange = [this] {
+        analysisService.setSpectrumSmoothing(smoothingBox.getSelectedId() - 1);
+    };
+    smoothingBox.setSelectedId(7, juce::sendNotificationSync);
+
     addAndMakeVisible(pluginNameLabel);
     pluginNameLabel.setText("No Plugin Loaded", juce::dontSendNotification);
     pluginNameLabel.setColour(juce::Label::textColourId, juce::Colours::white);
@@ -153,9 +163,11 @@ MainComponent::MainComponent()
                      currentSettings.numOutputChannels,
                      savedAudioState.get());
     engine.setFFTOrder(currentSettings.fftOrder);
+    engine.setHarmonicTrackingInterval(10.0);
     currentTabChanged(0, tabs.getCurrentTabName());
-    
-    startTimer(100);
+
+    analysisService.addSnapshotListener(this);
+    refreshFromSnapshot();
 }
 
 /**
@@ -164,6 +176,7 @@ MainComponent::MainComponent()
 MainComponent::~MainComponent()
 {
     tabs.removeChangeListener(this);
+    analysisService.removeSnapshotListener(this);
     stopTimer();
     savePersistentSettings();
     shutdownAudio();
@@ -280,6 +293,7 @@ void MainComponent::resized()
     browserButton.setBounds(header.removeFromLeft(90).reduced(5));
     settingsButton.setBounds(header.removeFromLeft(100).reduced(5));
     showPhaseButton.setBounds(header.removeFromLeft(100).reduced(5));
+    smoothingBox.setBounds(header.removeFromLeft(140).reduced(5));
     pluginNameLabel.setBounds(header.removeFromRight(300).reduced(5));
     
     // タブ
@@ -307,8 +321,8 @@ void MainComponent::resized()
     
     // Performance
     performanceLabel.setBounds(row3.removeFromLeft(100).reduced(5));
-    avgProcessingTimeLabel.setBounds(row3.removeFromLeft(120).reduced(5));
-    peakProcessingTimeLabel.setBounds(row3.removeFromLeft(260).reduced(5));
+    avgProcessingTimeLabel.setBounds(row3.removeFromLeft(220).reduced(5));
+    peakProcessingTimeLabel.setBounds(row3.removeFromLeft(480).reduced(5));
     cpuUsageLabel.setBounds(row3.removeFromLeft(100).reduced(5));
     
     // Content
@@ -389,14 +403,47 @@ void MainComponent::showPluginLoadError()
                                            message);
 }
 
+/**
+ * @brief 解析結果の公開通知
+ *
+ * 直前の更新から最小間隔が経過していない場合は、タイマで次の更新まで待つ。
+ * @param sequence 最新の解析結果の通し番号
+ */
+void MainComponent::snapshotPublished(std::uint64_t)
+{
+    if (isTimerRunning())
+    {
+        refreshPending = true;
+        return;
+    }
+    refreshFromSnapshot();
+    startTimerHz(maxRefreshRate);
+}
+
 /**
  * @brief タイマコールバック
+ *
+ * 待機中に公開された解析結果を表示し、新しい結果が無ければ停止する。
  */
 void MainComponent::timerCallback()
+{
+    if (!refreshPending)
+    {
+        stopTimer();
+        return;
+    }
+    refreshPending = false;
+    refreshFromSnapshot();
+}
+
+/**
+ * @brief 最新の解析結果で表示を更新
+ */
+void MainComponent::refreshFromSnapshot()
 {
     const auto snapshot = analysisService.getAnalysisSnapshot();
     if (graphComponent != nullptr)
-        graphComponent->repaint();
+        graphComponent->refresh();
 
 	// THD/IMD表示の更新
     juce::String thdText;
@@ -427,14 +474,22 @@ void MainComponent::timerCallback()
     const auto& perfData = snapshot->performance;
     
 	// 平均処理時間
-    avgProcessingTimeLabel.setText("Avg: " + juce::String(perfData.averageProcessingTime, 3) + " ms", 
-                                   juce::dontSendNotification);
+    // 経過時間とスレッドCPU時間を並べ、差分がスケジューラ由来であることを示す
+    auto averageText = "Avg: " + juce::String(perfData.averageProcessingTime, 3) + " ms";
+    if (perfData.threadCpuTimeAvailable)
+        averageText << "  CPU: " << juce::String(perfData.averageCpuTime, 3) << " ms";
+    avgProcessingTimeLabel.setText(averageText, juce::dontSendNotification);
     
 	// ピーク処理時間
     peakProcessingTimeLabel.setText(
         "Peak: " + juce::String(perfData.peakProcessingTime, 3)
-        + " ms  p95/p99: " + juce::String(perfData.p95ProcessingTime, 3)
-        + "/" + juce::String(perfData.p99ProcessingTime, 3) + " ms",
+        + " ms  p50/p99/p99.9: " + juce::String(perfData.p50ProcessingTime, 3)
+        + "/" + juce::String(perfData.p99ProcessingTime, 3)
+        + "/" + juce::String(perfData.p999ProcessingTime, 3) + " ms  Misses: "
+        + juce::String(static_cast<juce::int64>(perfData.deadlineMisses))
+        + (perfData.contextSwitchesAvailable
+               ? "  Preempted: " + juce::String(static_cast<juce::int64>(perfData.preemptedBlocks))
+               : juce::String()),
                                     juce::dontSendNotification);
     
 	// CPU使用率
@@ -618,4 +673,5 @@ void MainComponent::updateModeControls(
     peakProcessingTimeLabel.setVisible(controls.performance);
     cpuUsageLabel.setVisible(controls.performance);
     showPhaseButton.setVisible(controls.phase);
+    smoothingBox.setVisible(controls.smoothing);
 }
@@ -13,7 +13,8 @@ class OscilloscopeComponent;
 
 class MainComponent : public juce::AudioAppComponent,
                       public juce::Timer,
-                      public juce::ChangeListener
+                      public juce::ChangeListener,
+                      private plugin_analyzer::application::SnapshotListener
 {
 public:
     MainComponent();
@@ -56,6 +57,7 @@ private:
     
     juce::TextButton loadButton { "Load Plugin..." };
     juce::ToggleButton showPhaseButton { "Show Phase" };
+    juce::ComboBox smoothingBox;
     juce::Label pluginNameLabel;
     
     // Settings
@@ -86,6 +88,13 @@ private:
     std::unique_ptr<juce::FileChooser> fileChooser;
     std::unique_ptr<juce::PropertiesFile> properties;
 
+    // Results are shown as they are published, but at most this often; the
+    // timer only runs while results keep arriving.
+    static constexpr int maxRefreshRate = 60;
+    bool refreshPending = false;
+
+    void snapshotPublished(std::uint64_t sequence) override;
+    void refreshFromSnapshot();
     void showPluginLoadError();
     void loadPersistentSettings();
     void savePersistentSettings();
@@ -3,32 +3,67 @@
 #include <JuceHeader.h>
 #include "Application/AnalysisService.h"
 
+// Draws the scope frames the analysis worker publishes in each snapshot.
+// Triggering and min/max decimation happen on the worker, so painting costs
+// one vertical line per column (or one path segment per XY point).
 class OscilloscopeComponent : public juce::Component,
-                              public juce::Timer
+                              private plugin_analyzer::application::SnapshotListener
 {
 public:
     /**
      * @brief オシロスコープコンポーネントを作成
-     * @param service 波形サンプルの取得に使用するサービス
+     * @param service 波形フレームの取得と取り込み設定に使用するサービス
      */
     explicit OscilloscopeComponent(
         plugin_analyzer::application::AnalysisService& service)
         : analysisService(service)
     {
-        startTimerHz(60);
-        plotBuffer.resize(2048, 0.0f);
+        addAndMakeVisible(triggerBox);
+        triggerBox.addItem("Free Run", 1);
+        triggerBox.addItem("Rising Edge", 2);
+        triggerBox.addItem("Falling Edge", 3);
+        triggerBox.setSelectedId(2, juce::dontSendNotification);
+        triggerBox.onChange = [this] { updateSettings(); };
+
+        addAndMakeVisible(timeSpanBox);
+        for (auto milliseconds : { 1, 2, 5, 10, 20, 50, 100, 200, 500 })
+            timeSpanBox.addItem(juce::String(milliseconds) + " ms", milliseconds);
+        timeSpanBox.setSelectedId(10, juce::dontSendNotification);
+        timeSpanBox.onChange = [this] { updateSettings(); };
+
+        addAndMakeVisible(holdOffBox);
+        holdOffBox.addItem("No Hold-off", 1);
+        for (auto milliseconds : { 10, 50, 100, 250, 500 })
+            holdOffBox.addItem("Hold-off " + juce::String(milliseconds) + " ms", milliseconds + 1);
+        holdOffBox.setSelectedId(1, juce::dontSendNotification);
+        holdOffBox.onChange = [this] { updateSettings(); };
+
+        addAndMakeVisible(viewBox);
+        viewBox.addItem("Stereo", 1);
+        viewBox.addItem("XY", 2);
+        viewBox.setSelectedId(1, juce::dontSendNotification);
+        viewBox.onChange = [this] { repaint(); };
+
+        addAndMakeVisible(levelSlider);
+        levelSlider.setRange(-1.0, 1.0, 0.01);
+        levelSlider.setValue(0.0, juce::dontSendNotification);
+        levelSlider.setSliderStyle(juce::Slider::LinearHorizontal);
+        levelSlider.setTextBoxStyle(juce::Slider::TextBoxRight, false, 50, 20);
+        levelSlider.onValueChange = [this] { updateSettings(); };
+
+        analysisService.addSnapshotListener(this);
     }
 
     /**
-     * @brief 更新タイマーを停止してコンポーネントを破棄
+     * @brief 公開通知を解除してコンポーネントを破棄
      */
     ~OscilloscopeComponent() override
     {
-        stopTimer();
+        analysisService.removeSnapshotListener(this);
     }
 
     /**
-     * @brief 現在の波形を描画
+     * @brief 最新のフレームを描画
      * @param g グラフィックスコンテキスト
      */
     void paint(juce::Graphics& g) override
@@ -36,74 +71,168 @@ public:
         // 背景
         g.fillAll(juce::Colour(0xff202020));
 
-        // グリッド
+        const auto plot = getPlotBounds();
         g.setColour(juce::Colour(0xff555555));
-        g.drawRect(getLocalBounds(), 1);
-        g.drawLine(0.0f, getHeight() / 2.0f, (float)getWidth(), getHeight() / 2.0f);
+        g.drawRect(plot, 1);
+        if (shownSnapshot == nullptr)
+            return;
 
-        juce::Path p;
-        auto w = getWidth();
-        auto h = getHeight();
-        auto halfH = h / 2.0f;
-        
-        bool started = false;
-        
-        float xRatio = (float)w / (float)plotBuffer.size();
-        
-        for (int i = 0; i < (int)plotBuffer.size(); ++i)
+        const auto& frame = shownSnapshot->scope;
+        if (viewBox.getSelectedId() == 2)
+            drawXY(g, plot.toFloat(), frame);
+        else
+            drawStereo(g, plot.toFloat(), frame);
+    }
+
+    /**
+     * @brief 操作部と描画範囲を配置し、列数を描画幅に合わせる
+     */
+    void resized() override
+    {
+        auto controls = getLocalBounds().removeFromTop(controlHeight);
+        triggerBox.setBounds(controls.removeFromLeft(130).reduced(4));
+        levelSlider.setBounds(controls.removeFromLeft(180).reduced(4));
+        timeSpanBox.setBounds(controls.removeFromLeft(90).reduced(4));
+        holdOffBox.setBounds(controls.removeFromLeft(150).reduced(4));
+        viewBox.setBounds(controls.removeFromLeft(90).reduced(4));
+        updateSettings();
+    }
+
+private:
+    static constexpr int controlHeight = 30;
+
+    /**
+     * @brief 新しいフレームが公開されている場合のみ再描画
+     */
+    void snapshotPublished(std::uint64_t) override
+    {
+        auto snapshot = analysisService.getAnalysisSnapshot();
+        if (snapshot == nullptr
+            || (shownSnapshot != nullptr && snapshot->scope.sequence == shownSnapshot->scope.sequence))
+            return;
+
+        shownSnapshot = std::move(snapshot);
+        repaint();
+    }
+
+    juce::Rectangle<int> getPlotBounds() const
+    {
+        return getLocalBounds().withTrimmedTop(controlHeight).reduced(2);
+    }
+
+    /**
+     * @brief 操作部の状態を取り込み設定としてサービスへ送る
+     */
+    void updateSettings()
+    {
+        plugin_analyzer::domain::ScopeSettings settings;
+        settings.trigger = static_cast<plugin_analyzer::domain::ScopeTrigger>(triggerBox.getSelectedId() - 1);
+        settings.level = static_cast<float>(levelSlider.getValue());
+        settings.holdOff = (holdOffBox.getSelectedId() - 1) / 1000.0;
+        settings.timeSpan = timeSpanBox.getSelectedId() / 1000.0;
+        settings.columns = juce::jmax(1, getPlotBounds().getWidth());
+        analysisService.setScopeSettings(settings);
+    }
+
+    /**
+     * @brief 左右チャンネルを上下に分けて列ごとの最小値から最大値までを描画
+     * @param g グラフィックスコンテキスト
+     * @param area 描画範囲
+     * @param frame 描画するフレーム
+     */
+    void drawStereo(juce::Graphics& g, juce::Rectangle<float> area,
+                    const plugin_analyzer::domain::ScopeFrame& frame)
+    {
+        const auto upper = area.removeFromTop(area.getHeight() * 0.5f);
+        const auto level = static_cast<float>(levelSlider.getValue());
+        drawChannel(g, upper, frame.minimumL, frame.maximumL, juce::Colour(0xff00ffcc));
+        drawChannel(g, area, frame.minimumR, frame.maximumR, juce::Colour(0xffff6b35));
+
+        g.setColour(juce::Colour(0xff555555));
+        g.drawHorizontalLine((int)upper.getBottom(), area.getX(), area.getRight());
+        // トリガーレベル
+        if (triggerBox.getSelectedId() != 1)
         {
-            float x = i * xRatio;
-            float sample = plotBuffer[i];
-            
-            // スケーリング
-            float y = halfH - (sample * halfH * 0.9f);
-            
-            if (!started)
-            {
-                p.startNewSubPath(x, y);
-                started = true;
-            }
-            else
-            {
-                p.lineTo(x, y);
-            }
+            g.setColour(juce::Colour(0xffffff00).withAlpha(0.4f));
+            g.drawHorizontalLine((int)toY(level, upper), upper.getX(), upper.getRight());
+        }
+    }
+
+    void drawChannel(juce::Graphics& g, juce::Rectangle<float> lane,
+                     const std::vector<float>& minimum, const std::vector<float>& maximum,
+                     juce::Colour colour)
+    {
+        g.setColour(juce::Colour(0xff3a3a3a));
+        g.drawHorizontalLine((int)lane.getCentreY(), lane.getX(), lane.getRight());
+
+        const auto columns = juce::jmin(minimum.size(), maximum.size());
+        if (columns == 0)
+            return;
+        g.setColour(colour);
+        const auto columnWidth = lane.getWidth() / (float)columns;
+        for (size_t column = 0; column < columns; ++column)
+        {
+            const auto x = lane.getX() + (float)column * columnWidth;
+            const auto top = toY(maximum[column], lane);
+            // 1列に1サンプルの場合も1ピクセルの線を描く
+            const auto bottom = juce::jmax(top + 1.0f, toY(minimum[column], lane));
+            g.drawVerticalLine((int)x, top, bottom);
         }
-        
-        g.setColour(juce::Colour(0xff00ffcc));
-        g.strokePath(p, juce::PathStrokeType(2.0f));
     }
 
     /**
-     * @brief FIFOから新しい波形サンプルを取得
+     * @brief 左右のサンプル組をゴニオメーター（45度回転したXY）として描画
+     * @param g グラフィックスコンテキスト
+     * @param area 描画範囲
+     * @param frame 描画するフレーム
      */
-    void timerCallback() override
+    void drawXY(juce::Graphics& g, juce::Rectangle<float> area,
+                const plugin_analyzer::domain::ScopeFrame& frame)
     {
+        const auto side = juce::jmin(area.getWidth(), area.getHeight());
+        const auto square = area.withSizeKeepingCentre(side, side);
+        const auto centre = square.getCentre();
+        const auto scale = side * 0.45f;
 
-        int numToRead = analysisService.readFromScopeFifo(tempBuffer.data(), 1024);
-        
-        if (numToRead > 0)
+        g.setColour(juce::Colour(0xff3a3a3a));
+        g.drawLine(square.getX(), centre.y, square.getRight(), centre.y);
+        g.drawLine(centre.x, square.getY(), centre.x, square.getBottom());
+
+        const auto points = juce::jmin(frame.xyLeft.size(), frame.xyRight.size());
+        if (points == 0)
+            return;
+        // モノラルは縦線、逆相は横線になる
+        juce::Path p;
+        for (size_t point = 0; point < points; ++point)
         {
-            int samplesToKeep = (int)plotBuffer.size() - numToRead;
-            if (samplesToKeep > 0)
-            {
-                std::move(plotBuffer.begin() + numToRead, plotBuffer.end(), plotBuffer.begin());
-                std::copy(tempBuffer.begin(), tempBuffer.begin() + numToRead,
-                          plotBuffer.begin() + samplesToKeep);
-            }
+            const auto left = frame.xyLeft[point];
+            const auto right = frame.xyRight[point];
+            const auto x = centre.x + (right - left) * juce::MathConstants<float>::sqrt2 * 0.5f * scale;
+            const auto y = centre.y - (left + right) * juce::MathConstants<float>::sqrt2 * 0.5f * scale;
+            if (point == 0)
+                p.startNewSubPath(x, y);
             else
-            {
-                // 置き換え
-                 std::copy(tempBuffer.begin(), tempBuffer.begin() + plotBuffer.size(), plotBuffer.begin());
-            }
-            
-            repaint();
+                p.lineTo(x, y);
         }
+        g.setColour(juce::Colour(0xff00ffcc).withAlpha(0.7f));
+        g.strokePath(p, juce::PathStrokeType(1.0f));
+    }
+
+    static float toY(float sample, juce::Rectangle<float> lane)
+    {
+        // スケーリング
+        const auto halfH = lane.getHeight() * 0.5f;
+        return juce::jlimit(lane.getY(), lane.getBottom(), lane.getCentreY() - sample * halfH * 0.9f);
     }
 
-private:
     plugin_analyzer::application::AnalysisService& analysisService;
-    std::vector<float> plotBuffer;
-    std::array<float, 2048> tempBuffer;
+    std::shared_ptr<const plugin_analyzer::domain::AnalysisSnapshot> shownSnapshot;
+
+    juce::ComboBox triggerBox;
+    juce::ComboBox timeSpanBox;
+    juce::ComboBox holdOffBox;
+    juce::ComboBox viewBox;
+    juce::Slider levelSlider;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OscilloscopeComponent)
 };
@@ -0,0 +1,345 @@
+#include "PluginMetadataReader.h"
+#include "TurtleGraph.h"
+
+#include <array>
+
+namespace
+{
+constexpr auto lv2Core = "http://lv2plug.in/ns/lv2core#";
+constexpr auto rdfsSeeAlso = "http://www.w3.org/2000/01/rdf-schema#seeAlso";
+constexpr auto doapName = "http://usefulinc.com/ns/doap#name";
+constexpr auto doapMaintainer = "http://usefulinc.com/ns/doap#maintainer";
+constexpr auto foafName = "http://xmlns.com/foaf/0.1/name";
+constexpr auto vst3AudioClass = "Audio Module Class";
+
+// Metadata files are a few kilobytes; anything much larger is not read.
+constexpr juce::int64 maxMetadataFileSize = 4 * 1024 * 1024;
+
+/**
+ * @brief 上限以下の大きさのメタデータファイルを読み込む
+ * @param file 読み込むファイル
+ * @param text 読み込んだ内容
+ * @return ファイルが存在し、上限を超えない場合はtrue
+ */
+bool loadMetadataFile(const juce::File& file, juce::String& text)
+{
+    if (!file.existsAsFile() || file.getSize() > maxMetadataFileSize)
+        return false;
+    text = file.loadFileAsString();
+    return true;
+}
+
+/**
+ * @brief ディレクトリまたはファイルをfile URIへ変換
+ * @param file 変換するファイル
+ * @param isDirectory trueの場合は末尾に区切りを付ける
+ * @return URI
+ */
+std::string toFileUri(const juce::File& file, bool isDirectory)
+{
+    auto path = file.getFullPathName().replaceCharacter('\\', '/');
+    if (!path.startsWithChar('/'))
+        path = "/" + path;
+    path = path.replace("%", "%25").replace(" ", "%20");
+    return ("file://" + path + (isDirectory ? "/" : "")).toStdString();
+}
+
+/**
+ * @brief file URIをファイルへ変換
+ * @param uri 変換するURI
+ * @return ファイル。file URIでない場合は空のファイル
+ */
+juce::File fromFileUri(const std::string& uri)
+{
+    if (uri.compare(0, 7, "file://") != 0)
+        return {};
+
+    std::string path;
+    for (size_t i = 7; i < uri.size(); ++i)
+    {
+        if (uri[i] == '%' && i + 2 < uri.size())
+        {
+            path += static_cast<char>(juce::String(uri.substr(i + 1, 2)).getHexValue32());
+            i += 2;
+        }
+        else
+        {
+            path += uri[i];
+        }
+    }
+    auto fullPath = juce::String::fromUTF8(path.c_str());
+   #if JUCE_WINDOWS
+    fullPath = fullPath.trimCharactersAtStart("/");
+   #endif
+    return juce::File::isAbsolutePath(fullPath) ? juce::File(fullPath) : juce::File();
+}
+
+/**
+ * @brief 32桁の16進数で書かれたVST3のクラスIDを読み取る
+ * @param text クラスID
+ * @param bytes 文字列の順のバイト列
+ * @return 正しい形式の場合はtrue
+ */
+bool parseClassId(const juce::String& text, std::array<juce::uint8, 16>& bytes)
+{
+    if (text.length() != 32 || !text.containsOnly("0123456789abcdefABCDEF"))
+        return false;
+    for (int i = 0; i < 16; ++i)
+        bytes[static_cast<size_t>(i)] = static_cast<juce::uint8>(text.substring(i * 2, i * 2 + 2).getHexValue32());
+    return true;
+}
+
+// The same hash JUCE's VST3 host computes over a class ID, so descriptions
+// read here match the ones it produces and can be instantiated.
+template <typename Range>
+int hashRange(const Range& range)
+{
+    juce::uint32 value = 0;
+    for (const auto& item : range)
+        value = (value * 31) + static_cast<juce::uint32>(item);
+    return static_cast<int>(value);
+}
+}
+
+/**
+ * @brief メタデータの読み取りを準備
+ * @param searchPath LV2バンドルを探す場所。空の場合は形式の既定の場所
+ */
+PluginMetadataReader::PluginMetadataReader(const juce::FileSearchPath& searchPath)
+    : paths(searchPath)
+{
+}
+
+/**
+ * @brief モジュールを読み込まずにプラグインの記述を作成
+ * @param format 識別子の形式
+ * @param identifier プラグインの識別子
+ * @param results 作成した記述の追加先
+ * @return メタデータから1つ以上の記述を作成できた場合はtrue
+ */
+bool PluginMetadataReader::read(juce::AudioPluginFormat& format, const juce::String& identifier,
+                                juce::OwnedArray<juce::PluginDescription>& results)
+{
+    const auto formatName = format.getName();
+    if (formatName == "VST3" && juce::File::isAbsolutePath(identifier))
+        return readVST3Bundle(juce::File(identifier), results);
+    if (formatName == "LV2")
+        return readLV2(format, identifier, results);
+    return false;
+}
+
+/**
+ * @brief VST3のクラスIDからJUCEのホストと同じ識別用の値を求める
+ * @param classId 32桁の16進数で書かれたクラスID
+ * @param comLayout trueの場合はWindowsのCOM GUIDと同じバイト順のTUIDとして扱う
+ * @param uniqueId クラスIDを4つの32ビット値として求めたハッシュ
+ * @param deprecatedUid メモリ上のTUIDのバイト列から求めたハッシュ
+ * @return クラスIDが正しい形式の場合はtrue
+ */
+bool PluginMetadataReader::getVST3Ids(const juce::String& classId, bool comLayout,
+                                      int& uniqueId, int& deprecatedUid)
+{
+    std::array<juce::uint8, 16> bytes {};
+    if (!parseClassId(classId, bytes))
+        return false;
+
+    std::array<juce::uint32, 4> longs {};
+    for (size_t i = 0; i < 16; ++i)
+        longs[i / 4] = (longs[i / 4] << 8) | bytes[i];
+    uniqueId = hashRange(longs);
+
+    // In memory the ID is a TUID, which is laid out like a COM GUID on Windows.
+    std::array<char, 16> tuid {};
+    for (size_t i = 0; i < 16; ++i)
+        tuid[i] = static_cast<char>(bytes[i]);
+    if (comLayout)
+    {
+        std::swap(tuid[0], tuid[3]);
+        std::swap(tuid[1], tuid[2]);
+        std::swap(tuid[4], tuid[5]);
+        std::swap(tuid[6], tuid[7]);
+    }
+    deprecatedUid = hashRange(tuid);
+    return true;
+}
+
+/**
+ * @brief VST3バンドルのmoduleinfo.jsonから記述を作成
+ * @param bundle .vst3バンドル
+ * @param results 作成した記述の追加先
+ * @return 1つ以上のオーディオクラスを読み取れた場合はtrue
+ */
+bool PluginMetadataReader::readVST3Bundle(const juce::File& bundle,
+                                          juce::OwnedArray<juce::PluginDescription>& results)
+{
+    auto moduleInfo = bundle.getChildFile("Contents/Resources/moduleinfo.json");
+    if (!moduleInfo.existsAsFile())
+        moduleInfo = bundle.getChildFile("Contents/moduleinfo.json");
+    juce::String text;
+    if (!bundle.isDirectory() || !loadMetadataFile(moduleInfo, text))
+        return false;
+
+    const auto json = juce::JSON::parse(text);
+    const auto* classes = json["Classes"].getArray();
+    if (classes == nullptr)
+        return false;
+
+    const auto factoryVendor = json["Factory Info"]["Vendor"].toString();
+    juce::OwnedArray<juce::PluginDescription> found;
+    for (const auto& info : *classes)
+    {
+        if (info["Category"].toString() != vst3AudioClass)
+            continue;
+
+        juce::StringArray subCategories;
+        if (const auto* categories = info["Sub Categories"].getArray())
+            for (const auto& category : *categories)
+                subCategories.add(category.toString());
+
+        auto description = std::make_unique<juce::PluginDescription>();
+        description->name = info["Name"].toString();
+        description->descriptiveName = description->name;
+        description->pluginFormatName = "VST3";
+        description->category = subCategories.joinIntoString("|");
+        description->manufacturerName = info["Vendor"].toString().isNotEmpty()
+                                            ? info["Vendor"].toString() : factoryVendor;
+        description->version = info["Version"].toString();
+        description->fileOrIdentifier = bundle.getFullPathName();
+        description->lastFileModTime = bundle.getLastModificationTime();
+        description->lastInfoUpdateTime = juce::Time::getCurrentTime();
+        description->isInstrument = description->category.containsIgnoreCase("Instrument");
+        if (!getVST3Ids(info["CID"].toString(), JUCE_WINDOWS != 0,
+                        description->uniqueId, description->deprecatedUid))
+            return false;
+        if (description->name.isEmpty())
+            return false;
+        found.add(description.release());
+    }
+
+    if (found.isEmpty())
+        return false;
+    results.addArray(found);
+    found.clear(false);
+    return true;
+}
+
+/**
+ * @brief LV2プラグインのURIを含むバンドルを探し、Turtleファイルから記述を作成
+ * @param format LV2形式（既定の検索場所の取得に使用）
+ * @param uri プラグインのURI
+ * @param results 作成した記述の追加先
+ * @return 名前を含む記述を読み取れた場合はtrue
+ */
+bool PluginMetadataReader::readLV2(juce::AudioPluginFormat& format, const juce::String& uri,
+                                   juce::OwnedArray<juce::PluginDescription>& results)
+{
+    indexLV2Bundles(format);
+    const auto bundle = lv2Bundles.find(uri);
+    return bundle != lv2Bundles.end() && readLV2Bundle(bundle->second, uri, format.getName(), results);
+}
+
+/**
+ * @brief LV2バンドルのmanifest.ttlとrdfs:seeAlsoのファイルから記述を作成
+ * @param bundle .lv2バンドル
+ * @param uri プラグインのURI
+ * @param formatName 記述に設定する形式名
+ * @param results 作成した記述の追加先
+ * @return 名前を含む記述を読み取れた場合はtrue
+ */
+bool PluginMetadataReader::readLV2Bundle(const juce::File& bundle, const juce::String& uri,
+                                         const juce::String& formatName,
+                                         juce::OwnedArray<juce::PluginDescription>& results)
+{
+    const auto manifest = bundle.getChildFile("manifest.ttl");
+    const auto subject = uri.toStdString();
+    TurtleGraph graph;
+    juce::String text;
+    if (!loadMetadataFile(manifest, text) || !graph.parse(text.toStdString(), toFileUri(bundle, true)))
+        return false;
+    for (const auto& seeAlso : graph.getObjects(subject, rdfsSeeAlso))
+    {
+        if (seeAlso.isLiteral || !loadMetadataFile(fromFileUri(seeAlso.value), text)
+            || !graph.parse(text.toStdString(), seeAlso.value))
+            return false;
+    }
+
+    const auto name = juce::String::fromUTF8(graph.getLiteral(subject, doapName).c_str());
+    if (name.isEmpty())
+        return false;
+
+    auto description = std::make_unique<juce::PluginDescription>();
+    description->name = name;
+    description->descriptiveName = name;
+    description->pluginFormatName = formatName;
+    description->fileOrIdentifier = uri;
+    description->lastFileModTime = manifest.getLastModificationTime();
+    description->lastInfoUpdateTime = juce::Time::getCurrentTime();
+    description->uniqueId = description->deprecatedUid = uri.hashCode();
+
+    for (const auto& maintainer : graph.getObjects(subject, doapMaintainer))
+    {
+        const auto maintainerName = maintainer.isLiteral ? maintainer.value
+                                                         : graph.getLiteral(maintainer.value, foafName);
+        if (!maintainerName.empty())
+        {
+            description->manufacturerName = juce::String::fromUTF8(maintainerName.c_str());
+            break;
+        }
+    }
+
+    const std::string core = lv2Core;
+    for (const auto& type : graph.getObjects(subject, TurtleGraph::rdfType))
+    {
+        const auto local = juce::String(type.value.substr(std::min(type.value.size(), core.size())));
+        if (type.value.compare(0, core.size(), core) == 0 && local.endsWith("Plugin") && local != "Plugin"
+            && description->category.isEmpty())
+            description->category = local.dropLastCharacters(6);
+    }
+    description->isInstrument = graph.hasType(subject, core + "InstrumentPlugin");
+
+    for (const auto& port : graph.getObjects(subject, core + "port"))
+    {
+        if (port.isLiteral || !graph.hasType(port.value, core + "AudioPort"))
+            continue;
+        if (graph.hasType(port.value, core + "InputPort"))
+            ++description->numInputChannels;
+        else if (graph.hasType(port.value, core + "OutputPort"))
+            ++description->numOutputChannels;
+    }
+
+    const auto minor = graph.getLiteral(subject, core + "minorVersion");
+    const auto micro = graph.getLiteral(subject, core + "microVersion");
+    if (!minor.empty())
+        description->version = juce::String(minor) + "." + juce::String(micro.empty() ? "0" : micro);
+
+    results.add(description.release());
+    return true;
+}
+
+/**
+ * @brief 検索場所にあるLV2バンドルのmanifest.ttlを読み、プラグインのURIとバンドルを対応付ける
+ * @param format LV2形式（検索場所が空の場合に既定の場所を取得）
+ */
+void PluginMetadataReader::indexLV2Bundles(juce::AudioPluginFormat& format)
+{
+    if (lv2BundlesIndexed)
+        return;
+    lv2BundlesIndexed = true;
+
+    const auto searchPath = paths.getNumPaths() > 0 ? paths : format.getDefaultLocationsToSearch();
+    const auto pluginClass = std::string(lv2Core) + "Plugin";
+    for (int i = 0; i < searchPath.getNumPaths(); ++i)
+    {
+        for (const auto& bundle : searchPath[i].findChildFiles(juce::File::findDirectories, false, "*.lv2"))
+        {
+            TurtleGraph manifest;
+            juce::String text;
+            if (!loadMetadataFile(bundle.getChildFile("manifest.ttl"), text)
+                || !manifest.parse(text.toStdString(), toFileUri(bundle, true)))
+                continue;
+            // Earlier search paths take precedence, as they do for LV2 hosts.
+            for (const auto& plugin : manifest.getSubjectsOfType(pluginClass))
+                lv2Bundles.emplace(juce::String::fromUTF8(plugin.c_str()), bundle);
+        }
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <map>
+
+// Builds plug-in descriptions from the metadata bundles ship with, without
+// loading the module: Contents/Resources/moduleinfo.json for VST3 and the
+// manifest.ttl (plus the files it points to with rdfs:seeAlso) for LV2.
+// Identifiers whose metadata is missing or unreadable are left to the
+// isolated scanner processes. VST3 metadata carries no bus layout, so those
+// descriptions report zero channels until the module is instantiated.
+class PluginMetadataReader final
+{
+public:
+    explicit PluginMetadataReader(const juce::FileSearchPath& searchPath);
+
+    bool read(juce::AudioPluginFormat& format, const juce::String& identifier,
+              juce::OwnedArray<juce::PluginDescription>& results);
+
+    // Single-bundle readers, independent of the search path.
+    static bool readVST3Bundle(const juce::File& bundle, juce::OwnedArray<juce::PluginDescription>& results);
+    static bool readLV2Bundle(const juce::File& bundle, const juce::String& uri, const juce::String& formatName,
+                              juce::OwnedArray<juce::PluginDescription>& results);
+
+    // The uniqueId and deprecatedUid JUCE's VST3 host derives from a class ID.
+    // comLayout selects the Windows in-memory byte order of the TUID.
+    static bool getVST3Ids(const juce::String& classId, bool comLayout, int& uniqueId, int& deprecatedUid);
+
+private:
+    bool readLV2(juce::AudioPluginFormat& format, const juce::String& uri,
+                 juce::OwnedArray<juce::PluginDescription>& results);
+    void indexLV2Bundles(juce::AudioPluginFormat& format);
+
+    juce::FileSearchPath paths;
+    bool lv2BundlesIndexed = false;
+    std::map<juce::String, juce::File> lv2Bundles;
+
+    JUCE_DECLARE_NON_COPYABLE(PluginMetadataReader)
+};
@@ -1,6 +1,9 @@
 #include "PluginScanIPC.h"
 
-#include <condition_variable>
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
 
 namespace
 {
@@ -29,70 +32,87 @@ void addPluginFormats(juce::AudioPluginFormatManager& manager)
 class ScannerCoordinator final : private juce::ChildProcessCoordinator
 {
 public:
-    ScannerCoordinator()
+    struct Result
+    {
+        int job = -1;
+        bool timedOut = false;
+        juce::OwnedArray<juce::PluginDescription> descriptions;
+    };
+
+    /**
+     * @brief スキャナの子プロセスを起動
+     * @param activityEvent 応答または切断時に通知するイベント
+     */
+    explicit ScannerCoordinator(juce::WaitableEvent& activityEvent)
+        : activity(activityEvent)
     {
         launchWorkerProcess(juce::File::getSpecialLocation(juce::File::currentExecutableFile),
                             scannerProcessId, 0, 0);
     }
 
     /**
-     * @brief
-     * @param format
-     * @param identifier
-     * @param result
-     * @param shouldExit
-     * @return
+     * @brief 子プロセスを終了
+     *
+     * 基底クラスのデストラクタより先に終了し、破棄中のメンバーへ通知が届かないようにする。
      */
-    bool scan(juce::AudioPluginFormat& format,
-              const juce::String& identifier,
-              juce::OwnedArray<juce::PluginDescription>& result,
-              const std::function<bool()>& shouldExit)
+    ~ScannerCoordinator() override
     {
-        juce::MemoryBlock request;
-        juce::MemoryOutputStream stream(request, true);
-        stream.writeString(format.getName());
-        stream.writeString(identifier);
-
-        if (!sendMessageToWorker(request))
-            return false;
-
-        std::unique_lock<std::mutex> lock(mutex);
-        while (!receivedResult && !connectionLost)
-        {
-            condition.wait_for(lock, std::chrono::milliseconds(50));
-            if (shouldExit())
-                return true;
-        }
-
-        if (connectionLost)
-            return false;
+        killWorkerProcess();
+    }
 
-        if (response != nullptr)
+    /**
+     * @brief 複数の識別子のスキャンを1つのメッセージで依頼
+     * @param jobs 作業の一覧
+     * @param batch 依頼する作業の番号（子プロセスはこの順にスキャンする）
+     * @param deadlineMs 1つの識別子に許す時間（ミリ秒）
+     * @return 依頼を送信できた場合はtrue
+     */
+    bool scan(const std::vector<PluginScanPool::Job>& jobs, const std::vector<int>& batch,
+              int deadlineMs)
+    {
+        std::vector<PluginScanProtocol::ScanRequest> requests;
+        for (const auto index : batch)
         {
-            for (const auto* item : response->getChildIterator())
-            {
-                auto description = std::make_unique<juce::PluginDescription>();
-                if (description->loadFromXml(*item))
-                    result.add(std::move(description));
-            }
+            const auto& job = jobs[static_cast<size_t>(index)];
+            requests.push_back({ index, job.format->getName(), job.identifier });
         }
+        return sendMessageToWorker(PluginScanProtocol::createScanBatch(deadlineMs, requests));
+    }
 
-        receivedResult = false;
-        response.reset();
-        return true;
+    /**
+     * @brief 届いた結果を受け取る
+     * @param results 届いた順に結果を追加する
+     * @return 子プロセスとの接続が続いている場合はtrue
+     */
+    bool takeResults(std::vector<Result>& results)
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        for (auto& result : received)
+            results.push_back(std::move(result));
+        received.clear();
+        return !connectionLost;
     }
 
 private:
     /**
-     * @brief
-     * @param message
+     * @brief 1つの識別子の結果または期限切れの通知を読み込む（読み込めない場合は接続断として扱う）
+     * @param message 子プロセスからのメッセージ
      */
     void handleMessageFromWorker(const juce::MemoryBlock& message) override
     {
-        const std::lock_guard<std::mutex> lock(mutex);
-        response = juce::parseXML(message.toString());
-        receivedResult = true;
-        condition.notify_one();
+        Result result;
+        result.timedOut = PluginScanProtocol::readTimedOut(message, result.job);
+        const auto valid = result.timedOut
+                        || PluginScanProtocol::readJobResult(message, result.job, result.descriptions);
+
+        {
+            const std::lock_guard<std::mutex> lock(mutex);
+            if (valid)
+                received.push_back(std::move(result));
+            else
+                connectionLost = true;
+        }
+        activity.signal();
     }
 
     /**
@@ -100,65 +120,441 @@ private:
      */
     void handleConnectionLost() override
     {
-        const std::lock_guard<std::mutex> lock(mutex);
-        connectionLost = true;
-        condition.notify_one();
+        {
+            const std::lock_guard<std::mutex> lock(mutex);
+            connectionLost = true;
+        }
+        activity.signal();
     }
 
+    juce::WaitableEvent& activity;
     std::mutex mutex;
-    std::condition_variable condition;
-    std::unique_ptr<juce::XmlElement> response;
-    bool receivedResult = false;
+    std::vector<Result> received;
     bool connectionLost = false;
 };
+}
 
-class IsolatedScanner final : public juce::KnownPluginList::CustomScanner
+// One scanner process and the jobs sent to it, in the order it scans them;
+// the front one is in progress since startedAt.
+struct PluginScanPool::Worker
 {
-public:
-    /**
-     * @brief
-     * @param format
-     * @param result
-     * @param identifier
-     * @return
-     */
-    bool findPluginTypesFor(juce::AudioPluginFormat& format,
-                            juce::OwnedArray<juce::PluginDescription>& result,
-                            const juce::String& identifier) override
+    std::unique_ptr<ScannerCoordinator> coordinator;
+    std::deque<int> jobs;
+    double startedAt = 0.0;
+};
+
+/**
+ * @brief スキャンプールを作成（子プロセスは最初の依頼時に起動）
+ * @param list 見つかったプラグインとブラックリストを記録するリスト
+ * @param index スキャンを終えたモジュールの指紋を記録する索引
+ * @param deadMansPedal スキャン中の識別子を記録するファイル
+ * @param workerCount 同時に起動するスキャナの子プロセス数
+ */
+PluginScanPool::PluginScanPool(juce::KnownPluginList& list, PluginScanIndex& index,
+                               const juce::File& deadMansPedal, int workerCount)
+    : knownPlugins(list),
+      scanIndex(index),
+      deadMansPedalFile(deadMansPedal),
+      numWorkers(juce::jlimit(1, maxWorkers, workerCount)),
+      activity(false)
+{
+}
+
+PluginScanPool::~PluginScanPool() = default;
+
+/**
+ * @brief 既定のスキャナ数を取得
+ * @return CPUコア数（1〜maxWorkers）
+ */
+int PluginScanPool::getDefaultWorkerCount()
+{
+    return juce::jlimit(1, maxWorkers, juce::SystemStats::getNumCpus());
+}
+
+/**
+ * @brief 全形式の未スキャンまたは変更された識別子を1つの作業リストにまとめる
+ * @param formats スキャンする形式
+ * @param searchPath 検索パス。空の場合は各形式の既定の場所
+ * @param list 登録済みのプラグインとブラックリスト
+ * @param index 前回までにスキャンしたモジュールの指紋
+ * @param hashContents trueの場合はモジュールの内容も比較する
+ * @return 指紋が索引と異なり、ブラックリストにも無い識別子
+ */
+std::vector<PluginScanPool::Job> PluginScanPool::createJobs(juce::AudioPluginFormatManager& formats,
+                                                            const juce::FileSearchPath& searchPath,
+                                                            const juce::KnownPluginList& list,
+                                                            PluginScanIndex& index, bool hashContents)
+{
+    std::vector<Job> jobs;
+    const auto blacklist = list.getBlacklistedFiles();
+    for (auto* format : formats.getFormats())
     {
-        if (coordinator == nullptr)
-            coordinator = std::make_unique<ScannerCoordinator>();
+        const auto paths = searchPath.getNumPaths() > 0 ? searchPath
+                                                        : format->getDefaultLocationsToSearch();
+        for (const auto& identifier : format->searchPathsForPlugins(paths, true, false))
+        {
+            if (blacklist.contains(identifier))
+                continue;
 
-        if (coordinator->scan(format, identifier, result, [this] { return shouldExit(); }))
-            return true;
+            Job job { format, identifier };
+            job.hasFingerprint = PluginScanIndex::computeFingerprint(identifier, hashContents,
+                                                                     job.fingerprint);
+            if (job.hasFingerprint && index.confirmUnchanged(identifier, job.fingerprint))
+                continue;
+            if (!index.contains(identifier) && list.isListingUpToDate(identifier, *format))
+            {
+                // Listed before the index existed; record it without probing.
+                // A module the index knows about but whose fingerprint changed
+                // is always rescanned, whatever the list says.
+                if (job.hasFingerprint)
+                    index.update(identifier, job.fingerprint);
+                continue;
+            }
+            jobs.push_back(std::move(job));
+        }
+    }
+    return jobs;
+}
 
-        // A crash or disconnect blacklists this identifier. The next scan gets
-        // a fresh worker, so one bad plug-in does not prevent later discoveries.
-        coordinator.reset();
-        return false;
+/**
+ * @brief メタデータを持つバンドルをモジュールを読み込まずに登録
+ * @param jobs スキャンする識別子
+ * @param searchPath 検索パス。空の場合は各形式の既定の場所
+ * @return メタデータから記述を作成できず、スキャナでの調査が必要な識別子
+ */
+std::vector<PluginScanPool::Job> PluginScanPool::readMetadata(const std::vector<Job>& jobs,
+                                                              const juce::FileSearchPath& searchPath)
+{
+    PluginMetadataReader reader(searchPath);
+    std::vector<Job> remaining;
+    for (const auto& job : jobs)
+    {
+        juce::OwnedArray<juce::PluginDescription> found;
+        if (!reader.read(*job.format, job.identifier, found))
+        {
+            remaining.push_back(job);
+            continue;
+        }
+
+        replaceTypes(job.identifier, found);
+        if (job.hasFingerprint)
+            scanIndex.update(job.identifier, job.fingerprint);
     }
+    return remaining;
+}
 
-    /**
-     * @brief
-     */
-    void scanFinished() override
+/**
+ * @brief すべての作業をまとめてスキャナへ振り分け、完了まで待機
+ * @param jobs スキャンする識別子
+ * @return すべての作業を終えた場合はtrue、cancel()で中断した場合はfalse
+ */
+bool PluginScanPool::run(const std::vector<Job>& jobs)
+{
     {
-        coordinator.reset();
+        const juce::ScopedLock lock(stateLock);
+        failedFiles.clear();
+        currentIdentifier.clear();
+        scanTimes.clear();
+        completedJobs = 0;
+        totalJobs = static_cast<int>(jobs.size());
     }
 
-private:
-    std::unique_ptr<ScannerCoordinator> coordinator;
-};
+    std::vector<Worker> workers(static_cast<size_t>(numWorkers));
+    std::vector<double> jobDeadlines(jobs.size(), 0.0);
+    std::deque<int> pending;
+    for (size_t i = 0; i < jobs.size(); ++i)
+        pending.push_back(static_cast<int>(i));
+
+    auto begin = [this, &jobs](Worker& worker)
+    {
+        worker.startedAt = juce::Time::getMillisecondCounterHiRes();
+        setInProgress(jobs[static_cast<size_t>(worker.jobs.front())].identifier, true);
+    };
+
+    auto finish = [this, &jobs, &begin](Worker& worker, ScanTime::Outcome outcome)
+    {
+        const auto succeeded = outcome == ScanTime::Outcome::Scanned;
+        const auto& job = jobs[static_cast<size_t>(worker.jobs.front())];
+        const auto seconds = (juce::Time::getMillisecondCounterHiRes() - worker.startedAt) / 1000.0;
+        if (succeeded && job.hasFingerprint)
+            scanIndex.update(job.identifier, job.fingerprint);
+        else
+            scanIndex.remove(job.identifier);
+        if (!succeeded)
+            knownPlugins.addToBlacklist(job.identifier);
+        setInProgress(job.identifier, false);
+        {
+            const juce::ScopedLock lock(stateLock);
+            if (!succeeded)
+                failedFiles.add(job.identifier);
+            scanTimes.push_back({ job.identifier, seconds, outcome });
+            ++completedJobs;
+        }
+
+        worker.jobs.pop_front();
+        if (!worker.jobs.empty())
+            begin(worker);
+    };
+
+    // Only the job in progress crashed or hung; the rest of the batch goes
+    // back to the queue and gets a fresh process. Destroying the coordinator
+    // kills the old one.
+    auto lose = [this, &jobs, &finish, &pending](Worker& worker, ScanTime::Outcome outcome)
+    {
+        if (!worker.jobs.empty())
+            finish(worker, outcome);
+        if (!worker.jobs.empty())
+            setInProgress(jobs[static_cast<size_t>(worker.jobs.front())].identifier, false);
+        pending.insert(pending.begin(), worker.jobs.begin(), worker.jobs.end());
+        worker.jobs.clear();
+        worker.coordinator.reset();
+    };
+
+    // Applies the replies that have arrived. Returns false when the process
+    // reported a timeout (setting timedOut) or the connection is gone.
+    auto collect = [this, &jobs, &finish](Worker& worker, bool& timedOut)
+    {
+        std::vector<ScannerCoordinator::Result> results;
+        auto connected = worker.coordinator->takeResults(results);
+        for (const auto& result : results)
+        {
+            // Replies arrive in request order; anything else is a
+            // protocol error and the process is replaced.
+            if (worker.jobs.empty() || result.job != worker.jobs.front())
+                return false;
+            // The process is ending itself; nothing follows this.
+            if (result.timedOut)
+            {
+                timedOut = true;
+                return false;
+            }
+            replaceTypes(jobs[static_cast<size_t>(result.job)].identifier, result.descriptions);
+            finish(worker, ScanTime::Outcome::Scanned);
+        }
+        return connected;
+    };
+
+    for (;;)
+    {
+        if (cancelled.load())
+        {
+            // Abandoned identifiers did not crash anything.
+            for (const auto& worker : workers)
+                if (!worker.jobs.empty())
+                    setInProgress(jobs[static_cast<size_t>(worker.jobs.front())].identifier, false);
+            return false;
+        }
+
+        // Batches shrink as the queue drains so the last jobs still spread
+        // over every worker, and are topped up at half so a process never
+        // waits for a round trip between batches.
+        const auto batchSize = juce::jlimit(1, maxBatchSize,
+                                            static_cast<int>(pending.size()) / numWorkers);
+        const auto currentDeadline = getCurrentDeadline();
+        auto busy = false;
+        for (auto& worker : workers)
+        {
+            if (!pending.empty() && static_cast<int>(worker.jobs.size()) <= batchSize / 2)
+            {
+                std::vector<int> batch;
+                while (!pending.empty() && static_cast<int>(worker.jobs.size() + batch.size()) < batchSize)
+                {
+                    batch.push_back(pending.front());
+                    jobDeadlines[static_cast<size_t>(pending.front())] = currentDeadline;
+                    pending.pop_front();
+                }
+                // Launching the process does not count against the deadline
+                // of its first job.
+                if (worker.coordinator == nullptr)
+                    worker.coordinator = std::make_unique<ScannerCoordinator>(activity);
+                const auto wasIdle = worker.jobs.empty();
+                worker.jobs.insert(worker.jobs.end(), batch.begin(), batch.end());
+                if (wasIdle)
+                    begin(worker);
+                if (!worker.coordinator->scan(jobs, batch, juce::roundToInt(currentDeadline * 1000.0)))
+                {
+                    // Replies to the previous batch may be waiting; those
+                    // jobs finished before the connection broke.
+                    auto timedOut = false;
+                    collect(worker, timedOut);
+                    lose(worker, timedOut ? ScanTime::Outcome::TimedOut : ScanTime::Outcome::Crashed);
+                }
+            }
+            busy = busy || !worker.jobs.empty();
+        }
+        if (!busy)
+        {
+            // Every launch in this pass failed; retry what is left.
+            if (pending.empty())
+                return true;
+            continue;
+        }
+
+        // Sleep until something arrives or the earliest deadline passes.
+        auto killAt = std::numeric_limits<double>::max();
+        for (const auto& worker : workers)
+            if (!worker.jobs.empty())
+                killAt = juce::jmin(killAt, worker.startedAt
+                                                + (jobDeadlines[static_cast<size_t>(worker.jobs.front())]
+                                                   + killGracePeriod) * 1000.0);
+        activity.wait(juce::jmax(1, static_cast<int>(std::ceil(killAt - juce::Time::getMillisecondCounterHiRes()))));
+
+        for (auto& worker : workers)
+        {
+            if (worker.jobs.empty())
+                continue;
+
+            auto timedOut = false;
+            const auto connected = collect(worker, timedOut);
+
+            // The process's own watchdog normally ends it first; this covers
+            // one that is too wedged to do so. A lost connection without a
+            // timeout report is a crash, however long the scan had run.
+            const auto overdue = !worker.jobs.empty()
+                && juce::Time::getMillisecondCounterHiRes() - worker.startedAt
+                       >= (jobDeadlines[static_cast<size_t>(worker.jobs.front())] + killGracePeriod) * 1000.0;
+            if (timedOut || overdue)
+                lose(worker, ScanTime::Outcome::TimedOut);
+            else if (!connected)
+                lose(worker, ScanTime::Outcome::Crashed);
+        }
+    }
+}
+
+/**
+ * @brief 実行中および以降のrun()を中断する
+ */
+void PluginScanPool::cancel()
+{
+    cancelled.store(true);
+    activity.signal();
+}
+
+/**
+ * @brief 1つの識別子に許す時間を設定
+ * @param seconds 秒数。adaptiveDeadline（0）の場合はこれまでのスキャン時間から決める
+ */
+void PluginScanPool::setDeadline(double seconds)
+{
+    deadline.store(juce::jmax(0.0, seconds));
+}
+
+/**
+ * @brief 次に依頼する識別子に許す時間を取得
+ * @return 秒数
+ */
+double PluginScanPool::getCurrentDeadline() const
+{
+    const auto fixed = deadline.load();
+    if (fixed > 0.0)
+        return fixed;
+
+    std::vector<double> durations;
+    {
+        const juce::ScopedLock lock(stateLock);
+        for (const auto& time : scanTimes)
+            if (time.outcome == ScanTime::Outcome::Scanned)
+                durations.push_back(time.seconds);
+    }
+    return getAdaptiveDeadline(std::move(durations));
+}
+
+/**
+ * @brief 直前の実行で各識別子のスキャンにかかった時間を取得
+ * @return 完了した順の記録
+ */
+std::vector<PluginScanPool::ScanTime> PluginScanPool::getScanTimes() const
+{
+    const juce::ScopedLock lock(stateLock);
+    return scanTimes;
+}
+
+/**
+ * @brief スキャンの進捗を取得
+ * @return 完了した作業の割合（0〜1）
+ */
+double PluginScanPool::getProgress() const
+{
+    const juce::ScopedLock lock(stateLock);
+    return totalJobs > 0 ? static_cast<double>(completedJobs) / totalJobs : 1.0;
+}
+
+/**
+ * @brief 最後にスキャンを開始した識別子を取得
+ * @return 識別子
+ */
+juce::String PluginScanPool::getCurrentIdentifier() const
+{
+    const juce::ScopedLock lock(stateLock);
+    return currentIdentifier;
+}
+
+/**
+ * @brief 直前の実行でブラックリストに追加した識別子を取得
+ * @return 識別子の一覧
+ */
+juce::StringArray PluginScanPool::getFailedFiles() const
+{
+    const juce::ScopedLock lock(stateLock);
+    return failedFiles;
+}
+
+/**
+ * @brief スキャン中の識別子をデッドマンズペダルへ記録
+ * @param identifier 識別子
+ * @param isInProgress スキャンを開始した場合はtrue、終えた場合はfalse
+ */
+void PluginScanPool::setInProgress(const juce::String& identifier, bool isInProgress)
+{
+    const juce::ScopedLock lock(stateLock);
+    if (isInProgress)
+    {
+        inProgress.addIfNotAlreadyThere(identifier);
+        currentIdentifier = identifier;
+    }
+    else
+    {
+        inProgress.removeString(identifier);
+    }
+
+    if (deadMansPedalFile == juce::File())
+        return;
+    if (inProgress.isEmpty())
+        deadMansPedalFile.deleteFile();
+    else
+        deadMansPedalFile.replaceWithText(inProgress.joinIntoString("\n"));
+}
+
+/**
+ * @brief 識別子が以前に提供していた記述を新しい記述で置き換える
+ * @param identifier モジュールの識別子
+ * @param found 新しく見つかった記述
+ */
+void PluginScanPool::replaceTypes(const juce::String& identifier,
+                                  const juce::OwnedArray<juce::PluginDescription>& found)
+{
+    // A changed module replaces everything it provided before.
+    for (const auto& type : knownPlugins.getTypes())
+        if (type.fileOrIdentifier == identifier)
+            knownPlugins.removeType(type);
+    for (const auto* description : found)
+        knownPlugins.addType(*description);
 }
 
 /**
  * @brief 
  */
 PluginScanWorker::PluginScanWorker()
+    : juce::Thread("Plugin scan watchdog")
 {
     addPluginFormats(formatManager);
 }
 
+PluginScanWorker::~PluginScanWorker()
+{
+    stopThread(1000);
+}
+
 /**
  * @brief
  * @param commandLine
@@ -166,67 +562,109 @@ PluginScanWorker::PluginScanWorker()
  */
 bool PluginScanWorker::initialise(const juce::String& commandLine)
 {
-    return initialiseFromCommandLine(commandLine, scannerProcessId);
+    if (!initialiseFromCommandLine(commandLine, scannerProcessId))
+        return false;
+    startThread();
+    return true;
 }
 
 /**
- * @brief
- * @param message
+ * @brief 依頼されたバッチを読み込み、スキャン待ちの列へ追加
+ * @param message ScanBatchメッセージ
  */
 void PluginScanWorker::handleMessageFromCoordinator(const juce::MemoryBlock& message)
 {
-    if (message.isEmpty())
+    int deadlineMs = 0;
+    std::vector<PluginScanProtocol::ScanRequest> requests;
+    if (!PluginScanProtocol::readScanBatch(message, deadlineMs, requests))
         return;
 
     const std::lock_guard<std::mutex> lock(mutex);
-    pendingMessages.push(message);
+    for (auto& request : requests)
+        pendingScans.push({ request.job, deadlineMs, request.formatName, request.identifier });
     triggerAsyncUpdate();
 }
 
 /**
- * @brief
+ * @brief コーディネータとの接続が切れたらアプリケーションを終了
  */
 void PluginScanWorker::handleConnectionLost()
 {
+    connectionLostAt.store(juce::Time::getMillisecondCounterHiRes());
     juce::JUCEApplicationBase::quit();
 }
 
 /**
- * @brief
+ * @brief 期限を過ぎたスキャン、または終了できないまま残ったプロセスを強制終了
  */
-void PluginScanWorker::handleAsyncUpdate()
+void PluginScanWorker::run()
 {
-    for (;;)
+    constexpr double quitTimeoutMs = 1000.0;
+    while (!threadShouldExit())
     {
-        juce::MemoryBlock message;
+        wait(50);
+        const auto now = juce::Time::getMillisecondCounterHiRes();
+        const auto startedAt = scanStartedAt.load();
+        const auto deadlineMs = scanDeadlineMs.load();
+        const auto lostAt = connectionLostAt.load();
+        if (startedAt > 0.0 && deadlineMs > 0 && now - startedAt > deadlineMs)
         {
-            const std::lock_guard<std::mutex> lock(mutex);
-            if (pendingMessages.empty())
-                return;
-            message = std::move(pendingMessages.front());
-            pendingMessages.pop();
+            // A scan that finished meanwhile has already taken the job and
+            // will send its result instead.
+            const auto job = scanJob.exchange(-1);
+            if (job < 0)
+                continue;
+            sendMessageToCoordinator(PluginScanProtocol::createTimedOut(job));
+            juce::Process::terminate();
         }
-        sendResults(scan(message));
+        // The coordinator sees the lost connection and blacklists the
+        // identifier it was waiting for.
+        if (lostAt > 0.0 && now - lostAt > quitTimeoutMs)
+            juce::Process::terminate();
     }
 }
 
+/**
+ * @brief 1つの識別子をスキャンして結果を返し、残りがあれば次の更新で続ける
+ */
+void PluginScanWorker::handleAsyncUpdate()
+{
+    PendingScan next;
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        if (pendingScans.empty())
+            return;
+        next = std::move(pendingScans.front());
+        pendingScans.pop();
+        // Returning to the message loop between modules keeps the worker
+        // responsive to a lost connection.
+        if (!pendingScans.empty())
+            triggerAsyncUpdate();
+    }
+    scanDeadlineMs.store(next.deadlineMs);
+    scanJob.store(next.job);
+    scanStartedAt.store(juce::Time::getMillisecondCounterHiRes());
+    auto results = scan(next);
+    scanStartedAt.store(0.0);
+    // The watchdog has reported a timeout and is ending the process.
+    if (scanJob.exchange(-1) < 0)
+        return;
+    sendResults(next.job, results);
+}
+
 /**
  * @brief
- * @param message
+ * @param request
  * @return
  */
-juce::OwnedArray<juce::PluginDescription> PluginScanWorker::scan(const juce::MemoryBlock& message)
+juce::OwnedArray<juce::PluginDescription> PluginScanWorker::scan(const PendingScan& request)
 {
-    juce::MemoryInputStream stream(message, false);
-    const auto formatName = stream.readString();
-    const auto identifier = stream.readString();
-
     juce::OwnedArray<juce::PluginDescription> result;
     for (auto* format : formatManager.getFormats())
     {
-        if (format->getName() == formatName)
+        if (format->getName() == request.formatName)
         {
-            format->findAllTypesForFile(result, identifier);
+            format->findAllTypesForFile(result, request.identifier);
             break;
         }
     }
@@ -234,24 +672,11 @@ juce::OwnedArray<juce::PluginDescription> PluginScanWorker::scan(const juce::Mem
 }
 
 /**
- * @brief
- * @param results
- */
-void PluginScanWorker::sendResults(const juce::OwnedArray<juce::PluginDescription>& results)
-{
-    juce::XmlElement xml("PLUGIN_LIST");
-    for (const auto* description : results)
-        xml.addChildElement(description->createXml().release());
-
-    const auto text = xml.toString();
-    sendMessageToCoordinator({ text.toRawUTF8(), text.getNumBytesAsUTF8() });
-}
-
-/**
- * @brief
- * @return
+ * @brief 1つの識別子の結果をJobResultメッセージとして送信
+ * @param job 作業の番号
+ * @param results 見つかったプラグイン
  */
-std::unique_ptr<juce::KnownPluginList::CustomScanner> createIsolatedPluginScanner()
+void PluginScanWorker::sendResults(int job, const juce::OwnedArray<juce::PluginDescription>& results)
 {
-    return std::make_unique<IsolatedScanner>();
+    sendMessageToCoordinator(PluginScanProtocol::createJobResult(job, results));
 }
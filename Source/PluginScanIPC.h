@@ -1,28 +1,174 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "PluginMetadataReader.h"
+#include "PluginScanIndex.h"
+#include "PluginScanProtocol.h"
+#include <algorithm>
+#include <vector>
 
 // The scanner worker is the same executable launched in JUCE child-process
 // mode. Keeping plug-in discovery in this process prevents a faulty module from
-// taking down the analyser UI.
+// taking down the analyser UI. It receives identifiers in batches and replies
+// once per identifier, in order, as each one finishes. A watchdog thread ends
+// the process when one identifier overruns its deadline, first telling the
+// coordinator which job timed out so it is not mistaken for a crash, or when
+// the coordinator is gone but a hung module keeps the message loop from
+// quitting.
 class PluginScanWorker final : private juce::ChildProcessWorker,
-                               private juce::AsyncUpdater
+                               private juce::AsyncUpdater,
+                               private juce::Thread
 {
 public:
     PluginScanWorker();
+    ~PluginScanWorker() override;
     bool initialise(const juce::String& commandLine);
 
 private:
     void handleMessageFromCoordinator(const juce::MemoryBlock&) override;
     void handleConnectionLost() override;
     void handleAsyncUpdate() override;
-    juce::OwnedArray<juce::PluginDescription> scan(const juce::MemoryBlock&);
-    void sendResults(const juce::OwnedArray<juce::PluginDescription>&);
+    void run() override;
+
+    struct PendingScan
+    {
+        int job = -1;
+        int deadlineMs = 0;
+        juce::String formatName;
+        juce::String identifier;
+    };
+
+    juce::OwnedArray<juce::PluginDescription> scan(const PendingScan&);
+    void sendResults(int job, const juce::OwnedArray<juce::PluginDescription>&);
 
     std::mutex mutex;
-    std::queue<juce::MemoryBlock> pendingMessages;
+    std::queue<PendingScan> pendingScans;
     juce::AudioPluginFormatManager formatManager;
+
+    // The job being scanned, or -1. Whichever of the scan and the watchdog
+    // exchanges it first decides whether a result or a timeout is reported.
+    std::atomic<int> scanJob { -1 };
+    std::atomic<double> scanStartedAt { 0.0 };
+    std::atomic<int> scanDeadlineMs { 0 };
+    std::atomic<double> connectionLostAt { 0.0 };
 };
 
-std::unique_ptr<juce::KnownPluginList::CustomScanner> createIsolatedPluginScanner();
+// Discovers plug-ins on a pool of isolated scanner processes. Identifiers
+// from every format share one queue and each idle worker takes the next
+// one, so module loads overlap. A worker that crashes or disconnects
+// blacklists only the identifier it was scanning and is relaunched for the
+// rest of its batch. Every identifier in flight is listed in the dead man's
+// pedal file, so a crash of the host itself blacklists them on the next
+// launch. An identifier that overruns its deadline is blacklisted like a
+// crash and its process is replaced, so one hung constructor cannot stall
+// the scan and the total time stays bounded; it is recorded as timed out
+// only when the worker reports it or the coordinator kills the process.
+// Module files whose fingerprint matches the scan index are not queued at
+// all, and bundles whose metadata describes them are read without a
+// scanner process.
+class PluginScanPool final
+{
+public:
+    struct Job
+    {
+        juce::AudioPluginFormat* format = nullptr;
+        juce::String identifier;
+        PluginScanIndex::Fingerprint fingerprint;
+        bool hasFingerprint = false;
+    };
+
+    static constexpr int maxWorkers = 8;
+    static constexpr int maxBatchSize = 16;
+
+    // Deadline of 0 picks it from the scans seen so far: a multiple of the
+    // 90th percentile, within fixed bounds.
+    static constexpr double adaptiveDeadline = 0.0;
+    static constexpr double defaultDeadline = 30.0;
+    static constexpr double minimumAdaptiveDeadline = 10.0;
+    static constexpr double maximumAdaptiveDeadline = 120.0;
+    static constexpr double adaptiveDeadlineScale = 10.0;
+    static constexpr int minimumTimingSamples = 8;
+    // Extra time the coordinator allows for the process's own watchdog.
+    static constexpr double killGracePeriod = 2.0;
+
+    struct ScanTime
+    {
+        enum class Outcome
+        {
+            Scanned,
+            Crashed,
+            TimedOut
+        };
+
+        juce::String identifier;
+        double seconds = 0.0;
+        Outcome outcome = Outcome::Scanned;
+    };
+
+    PluginScanPool(juce::KnownPluginList& list, PluginScanIndex& index,
+                   const juce::File& deadMansPedal, int numWorkers);
+    ~PluginScanPool();
+
+    static int getDefaultWorkerCount();
+    static std::vector<Job> createJobs(juce::AudioPluginFormatManager& formats,
+                                       const juce::FileSearchPath& searchPath,
+                                       const juce::KnownPluginList& list,
+                                       PluginScanIndex& index, bool hashContents);
+
+    int getNumWorkers() const { return numWorkers; }
+    std::vector<Job> readMetadata(const std::vector<Job>& jobs, const juce::FileSearchPath& searchPath);
+    bool run(const std::vector<Job>& jobs);
+    void cancel();
+
+    void setDeadline(double seconds);
+    double getCurrentDeadline() const;
+
+    /**
+     * @brief 成功したスキャンの所要時間から適応的な期限を求める
+     * @param durations 所要時間（秒）
+     * @return 90パーセンタイルのadaptiveDeadlineScale倍を上下限に収めた秒数。
+     *         記録がminimumTimingSamples件に満たない場合はdefaultDeadline
+     */
+    static double getAdaptiveDeadline(std::vector<double> durations)
+    {
+        if (static_cast<int>(durations.size()) < minimumTimingSamples)
+            return defaultDeadline;
+
+        const auto percentile = durations.begin()
+                              + static_cast<std::ptrdiff_t>((durations.size() - 1) * 9 / 10);
+        std::nth_element(durations.begin(), percentile, durations.end());
+        return juce::jlimit(minimumAdaptiveDeadline, maximumAdaptiveDeadline,
+                            adaptiveDeadlineScale * *percentile);
+    }
+    std::vector<ScanTime> getScanTimes() const;
+
+    double getProgress() const;
+    juce::String getCurrentIdentifier() const;
+    juce::StringArray getFailedFiles() const;
+
+private:
+    struct Worker;
+
+    void setInProgress(const juce::String& identifier, bool isInProgress);
+    void replaceTypes(const juce::String& identifier,
+                      const juce::OwnedArray<juce::PluginDescription>& found);
+
+    juce::KnownPluginList& knownPlugins;
+    PluginScanIndex& scanIndex;
+    juce::File deadMansPedalFile;
+    int numWorkers = 1;
+    juce::WaitableEvent activity;
+    std::atomic<bool> cancelled { false };
+
+    mutable juce::CriticalSection stateLock;
+    juce::StringArray inProgress;
+    juce::StringArray failedFiles;
+    juce::String currentIdentifier;
+    std::vector<ScanTime> scanTimes;
+    std::atomic<double> deadline { adaptiveDeadline };
+    int completedJobs = 0;
+    int totalJobs = 0;
+
+    JUCE_DECLARE_NON_COPYABLE(PluginScanPool)
+};
 
@@ -0,0 +1,218 @@
+#include "PluginScanIndex.h"
+
+namespace
+{
+constexpr auto indexTag = "PLUGIN_SCAN_INDEX";
+constexpr auto moduleTag = "MODULE";
+constexpr juce::uint64 fnvOffsetBasis = 14695981039346656037ull;
+constexpr juce::uint64 fnvPrime = 1099511628211ull;
+
+/**
+ * @brief FNV-1a 64ビットハッシュへバイト列を加える
+ * @param hash 現在のハッシュ値
+ * @param data バイト列
+ * @param numBytes バイト数
+ */
+void hashBytes(juce::uint64& hash, const void* data, size_t numBytes)
+{
+    const auto* bytes = static_cast<const juce::uint8*>(data);
+    for (size_t i = 0; i < numBytes; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= fnvPrime;
+    }
+}
+
+/**
+ * @brief ファイルの内容をハッシュへ加える
+ * @param hash 現在のハッシュ値
+ * @param file 読み込むファイル
+ * @return ファイルを読み込めた場合はtrue
+ */
+bool hashFile(juce::uint64& hash, const juce::File& file)
+{
+    juce::FileInputStream stream(file);
+    if (!stream.openedOk())
+        return false;
+
+    juce::HeapBlock<char> buffer(1 << 16);
+    for (;;)
+    {
+        const auto bytesRead = stream.read(buffer.get(), 1 << 16);
+        if (bytesRead <= 0)
+            return true;
+        hashBytes(hash, buffer.get(), static_cast<size_t>(bytesRead));
+    }
+}
+}
+
+/**
+ * @brief モジュールのサイズ、更新時刻、必要に応じて内容のハッシュを取得
+ * @param identifier モジュールのパス
+ * @param hashContents trueの場合は内容のハッシュも計算する
+ * @param result 取得した指紋
+ * @return 識別子が既存のファイルまたはバンドルの場合はtrue
+ */
+bool PluginScanIndex::computeFingerprint(const juce::String& identifier, bool hashContents,
+                                         Fingerprint& result)
+{
+    if (!juce::File::isAbsolutePath(identifier))
+        return false;
+
+    const juce::File module(identifier);
+    juce::Array<juce::File> files;
+    if (module.isDirectory())
+        files = module.findChildFiles(juce::File::findFiles, true);
+    else if (module.existsAsFile())
+        files.add(module);
+    else
+        return false;
+
+    // A stable order keeps the hash independent of directory iteration.
+    files.sort();
+    result = {};
+    result.modificationTime = module.getLastModificationTime().toMilliseconds();
+    auto hash = fnvOffsetBasis;
+    for (const auto& file : files)
+    {
+        result.size += file.getSize();
+        result.modificationTime = juce::jmax(result.modificationTime,
+                                             file.getLastModificationTime().toMilliseconds());
+        if (hashContents)
+        {
+            const auto relativePath = file.getRelativePathFrom(module);
+            hashBytes(hash, relativePath.toRawUTF8(), relativePath.getNumBytesAsUTF8());
+            if (!hashFile(hash, file))
+                return false;
+        }
+    }
+    result.contentHash = hash;
+    result.hasContentHash = hashContents;
+    return true;
+}
+
+/**
+ * @brief 保存済みの索引を読み込む
+ * @param xml createXml()で作成した要素
+ */
+void PluginScanIndex::loadFromXml(const juce::XmlElement& xml)
+{
+    const juce::ScopedLock scopedLock(lock);
+    entries.clear();
+    if (!xml.hasTagName(indexTag))
+        return;
+
+    for (const auto* item : xml.getChildWithTagNameIterator(moduleTag))
+    {
+        Fingerprint fingerprint;
+        fingerprint.size = item->getStringAttribute("size").getLargeIntValue();
+        fingerprint.modificationTime = item->getStringAttribute("modified").getLargeIntValue();
+        fingerprint.hasContentHash = item->hasAttribute("hash");
+        if (fingerprint.hasContentHash)
+            fingerprint.contentHash = static_cast<juce::uint64>(
+                item->getStringAttribute("hash").getHexValue64());
+        entries[item->getStringAttribute("identifier")] = fingerprint;
+    }
+}
+
+/**
+ * @brief 索引を保存用のXMLへ変換
+ * @return 索引の要素
+ */
+std::unique_ptr<juce::XmlElement> PluginScanIndex::createXml() const
+{
+    const juce::ScopedLock scopedLock(lock);
+    auto xml = std::make_unique<juce::XmlElement>(indexTag);
+    for (const auto& [identifier, fingerprint] : entries)
+    {
+        auto* item = xml->createNewChildElement(moduleTag);
+        item->setAttribute("identifier", identifier);
+        item->setAttribute("size", juce::String(fingerprint.size));
+        item->setAttribute("modified", juce::String(fingerprint.modificationTime));
+        if (fingerprint.hasContentHash)
+            item->setAttribute("hash", juce::String::toHexString(
+                                           static_cast<juce::int64>(fingerprint.contentHash)));
+    }
+    return xml;
+}
+
+/**
+ * @brief モジュールの記録があるかを判定
+ * @param identifier モジュールのパス
+ * @return 指紋が記録されている場合はtrue
+ */
+bool PluginScanIndex::contains(const juce::String& identifier) const
+{
+    const juce::ScopedLock scopedLock(lock);
+    return entries.find(identifier) != entries.end();
+}
+
+/**
+ * @brief モジュールが前回のスキャンから変わっていないかを判定
+ * @param identifier モジュールのパス
+ * @param fingerprint 現在の指紋
+ * @return 同じ指紋が記録されている場合はtrue
+ */
+bool PluginScanIndex::isUnchanged(const juce::String& identifier, const Fingerprint& fingerprint) const
+{
+    const juce::ScopedLock scopedLock(lock);
+    const auto entry = entries.find(identifier);
+    return entry != entries.end() && entry->second.matches(fingerprint);
+}
+
+/**
+ * @brief モジュールが変わっていないかを判定し、記録に無い内容のハッシュを補う
+ * @param identifier モジュールのパス
+ * @param fingerprint 現在の指紋
+ * @return 同じ指紋が記録されている場合はtrue
+ */
+bool PluginScanIndex::confirmUnchanged(const juce::String& identifier, const Fingerprint& fingerprint)
+{
+    const juce::ScopedLock scopedLock(lock);
+    const auto entry = entries.find(identifier);
+    if (entry == entries.end() || !entry->second.matches(fingerprint))
+        return false;
+    if (!entry->second.hasContentHash && fingerprint.hasContentHash)
+        entry->second = fingerprint;
+    return true;
+}
+
+/**
+ * @brief スキャンを終えたモジュールの指紋を記録
+ * @param identifier モジュールのパス
+ * @param fingerprint スキャン前に取得した指紋
+ */
+void PluginScanIndex::update(const juce::String& identifier, const Fingerprint& fingerprint)
+{
+    const juce::ScopedLock scopedLock(lock);
+    entries[identifier] = fingerprint;
+}
+
+/**
+ * @brief モジュールの記録を削除（次回のスキャンで再度調べる）
+ * @param identifier モジュールのパス
+ */
+void PluginScanIndex::remove(const juce::String& identifier)
+{
+    const juce::ScopedLock scopedLock(lock);
+    entries.erase(identifier);
+}
+
+/**
+ * @brief すべての記録を削除
+ */
+void PluginScanIndex::clear()
+{
+    const juce::ScopedLock scopedLock(lock);
+    entries.clear();
+}
+
+/**
+ * @brief 記録されているモジュール数を取得
+ * @return モジュール数
+ */
+int PluginScanIndex::size() const
+{
+    const juce::ScopedLock scopedLock(lock);
+    return static_cast<int>(entries.size());
+}
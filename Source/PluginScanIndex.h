@@ -0,0 +1,50 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <map>
+
+// Persistent record of the modules a scan has already probed. Each module
+// path is keyed on its size, modification time and, optionally, a hash of
+// its contents; a rescan only probes modules whose record is missing or
+// different and keeps the cached descriptions of the rest. Bundles (VST3,
+// LV2, AU directories) are fingerprinted over every file inside them, so a
+// replaced binary is noticed even when the bundle directory is not touched.
+// Identifiers that are not files (for example LV2 URIs) have no fingerprint.
+class PluginScanIndex final
+{
+public:
+    struct Fingerprint
+    {
+        juce::int64 size = 0;
+        juce::int64 modificationTime = 0;
+        juce::uint64 contentHash = 0;
+        bool hasContentHash = false;
+
+        // Hashes are only compared when both sides have one.
+        bool matches(const Fingerprint& other) const
+        {
+            return size == other.size && modificationTime == other.modificationTime
+                && (!hasContentHash || !other.hasContentHash || contentHash == other.contentHash);
+        }
+    };
+
+    static bool computeFingerprint(const juce::String& identifier, bool hashContents,
+                                   Fingerprint& result);
+
+    void loadFromXml(const juce::XmlElement& xml);
+    std::unique_ptr<juce::XmlElement> createXml() const;
+
+    bool contains(const juce::String& identifier) const;
+    bool isUnchanged(const juce::String& identifier, const Fingerprint& fingerprint) const;
+    // Like isUnchanged, but an entry recorded without a content hash adopts
+    // the hash of a matching fingerprint, so later hashed scans compare it.
+    bool confirmUnchanged(const juce::String& identifier, const Fingerprint& fingerprint);
+    void update(const juce::String& identifier, const Fingerprint& fingerprint);
+    void remove(const juce::String& identifier);
+    void clear();
+    int size() const;
+
+private:
+    mutable juce::CriticalSection lock;
+    std::map<juce::String, Fingerprint> entries;
+};
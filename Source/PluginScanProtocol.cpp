@@ -0,0 +1,259 @@
+#include "PluginScanProtocol.h"
+
+namespace
+{
+// The smallest encodings: a one-byte job plus two empty strings, and seven
+// empty strings plus the fixed-size fields of a description.
+constexpr juce::int64 minimumScanRequestBytes = 3;
+constexpr juce::int64 descriptionFixedBytes = 8 + 8 + 4 * 4 + 1;
+constexpr juce::int64 minimumDescriptionBytes = 7 + descriptionFixedBytes;
+
+/**
+ * @brief 圧縮された整数を、途中で切れていないことを確かめてから読み込む
+ * @param stream 読み込み元
+ * @param value 読み込んだ値
+ * @return 値のバイトがすべて残っている場合はtrue
+ */
+bool readCompressedInt(juce::MemoryInputStream& stream, int& value)
+{
+    if (stream.getNumBytesRemaining() < 1)
+        return false;
+    const auto numBytes = static_cast<juce::uint8>(static_cast<const char*>(stream.getData())
+                                                       [stream.getPosition()]) & 0x7f;
+    if (numBytes > 4 || numBytes >= stream.getNumBytesRemaining())
+        return false;
+    value = stream.readCompressedInt();
+    return true;
+}
+
+/**
+ * @brief 要素数を読み込み、残りのバイト数で収まるかを確かめる
+ * @param stream 読み込み元
+ * @param minimumBytesPerItem 1要素の最小のバイト数
+ * @param count 読み込んだ要素数
+ * @return 要素数が0以上で、残りのバイト数を超えない場合はtrue
+ */
+bool readCount(juce::MemoryInputStream& stream, juce::int64 minimumBytesPerItem, int& count)
+{
+    return readCompressedInt(stream, count) && count >= 0
+        && count <= stream.getNumBytesRemaining() / minimumBytesPerItem;
+}
+
+/**
+ * @brief 先頭の種類のバイトを確かめる
+ * @param stream 読み込み元
+ * @param type 期待する種類
+ * @return 種類が一致する場合はtrue
+ */
+bool readMessageType(juce::MemoryInputStream& stream, PluginScanProtocol::MessageType type)
+{
+    return stream.getNumBytesRemaining() >= 1
+        && static_cast<PluginScanProtocol::MessageType>(stream.readByte()) == type;
+}
+}
+
+/**
+ * @brief ScanBatchメッセージを作成
+ * @param deadlineMs 1つの識別子に許す時間（ミリ秒）
+ * @param requests スキャンする順の作業
+ * @return メッセージ
+ */
+juce::MemoryBlock PluginScanProtocol::createScanBatch(int deadlineMs, const std::vector<ScanRequest>& requests)
+{
+    juce::MemoryBlock message;
+    {
+        juce::MemoryOutputStream stream(message, false);
+        stream.writeByte(static_cast<char>(MessageType::ScanBatch));
+        stream.writeCompressedInt(deadlineMs);
+        stream.writeCompressedInt(static_cast<int>(requests.size()));
+        for (const auto& request : requests)
+        {
+            stream.writeCompressedInt(request.job);
+            writeString(stream, request.formatName);
+            writeString(stream, request.identifier);
+        }
+    }
+    return message;
+}
+
+/**
+ * @brief ScanBatchメッセージを読み込む
+ * @param message メッセージ
+ * @param deadlineMs 1つの識別子に許す時間（ミリ秒）
+ * @param requests スキャンする順の作業
+ * @return 正しい形式の場合はtrue
+ */
+bool PluginScanProtocol::readScanBatch(const juce::MemoryBlock& message, int& deadlineMs,
+                                       std::vector<ScanRequest>& requests)
+{
+    juce::MemoryInputStream stream(message, false);
+    int count = 0;
+    if (!readMessageType(stream, MessageType::ScanBatch) || !readCompressedInt(stream, deadlineMs)
+        || !readCount(stream, minimumScanRequestBytes, count))
+        return false;
+
+    requests.assign(static_cast<size_t>(count), {});
+    for (auto& request : requests)
+        if (!readCompressedInt(stream, request.job) || !readString(stream, request.formatName)
+            || !readString(stream, request.identifier))
+            return false;
+    return stream.isExhausted();
+}
+
+/**
+ * @brief JobResultメッセージを作成
+ * @param job 作業の番号
+ * @param descriptions 見つかったプラグイン
+ * @return メッセージ
+ */
+juce::MemoryBlock PluginScanProtocol::createJobResult(int job,
+                                                      const juce::OwnedArray<juce::PluginDescription>& descriptions)
+{
+    juce::MemoryBlock message;
+    {
+        juce::MemoryOutputStream stream(message, false);
+        stream.writeByte(static_cast<char>(MessageType::JobResult));
+        stream.writeCompressedInt(job);
+        stream.writeCompressedInt(descriptions.size());
+        for (const auto* description : descriptions)
+            writeDescription(stream, *description);
+    }
+    return message;
+}
+
+/**
+ * @brief JobResultメッセージを読み込む
+ * @param message メッセージ
+ * @param job 作業の番号
+ * @param descriptions 見つかったプラグインの追加先
+ * @return 正しい形式の場合はtrue
+ */
+bool PluginScanProtocol::readJobResult(const juce::MemoryBlock& message, int& job,
+                                       juce::OwnedArray<juce::PluginDescription>& descriptions)
+{
+    juce::MemoryInputStream stream(message, false);
+    int count = 0;
+    if (!readMessageType(stream, MessageType::JobResult) || !readCompressedInt(stream, job)
+        || !readCount(stream, minimumDescriptionBytes, count))
+        return false;
+
+    for (int i = 0; i < count; ++i)
+    {
+        auto description = std::make_unique<juce::PluginDescription>();
+        if (!readDescription(stream, *description))
+            return false;
+        descriptions.add(description.release());
+    }
+    return stream.isExhausted();
+}
+
+/**
+ * @brief TimedOutメッセージを作成
+ * @param job 期限を過ぎた作業の番号
+ * @return メッセージ
+ */
+juce::MemoryBlock PluginScanProtocol::createTimedOut(int job)
+{
+    juce::MemoryBlock message;
+    {
+        juce::MemoryOutputStream stream(message, false);
+        stream.writeByte(static_cast<char>(MessageType::TimedOut));
+        stream.writeCompressedInt(job);
+    }
+    return message;
+}
+
+/**
+ * @brief TimedOutメッセージを読み込む
+ * @param message メッセージ
+ * @param job 期限を過ぎた作業の番号
+ * @return 正しい形式の場合はtrue
+ */
+bool PluginScanProtocol::readTimedOut(const juce::MemoryBlock& message, int& job)
+{
+    juce::MemoryInputStream stream(message, false);
+    return readMessageType(stream, MessageType::TimedOut) && readCompressedInt(stream, job)
+        && stream.isExhausted();
+}
+
+/**
+ * @brief 文字列をバイト数とUTF-8で書き込む
+ * @param stream 書き込み先
+ * @param text 書き込む文字列
+ */
+void PluginScanProtocol::writeString(juce::MemoryOutputStream& stream, const juce::String& text)
+{
+    const auto numBytes = text.getNumBytesAsUTF8();
+    stream.writeCompressedInt(static_cast<int>(numBytes));
+    stream.write(text.toRawUTF8(), numBytes);
+}
+
+/**
+ * @brief バイト数とUTF-8で書かれた文字列を読み込む
+ * @param stream 読み込み元
+ * @param text 読み込んだ文字列
+ * @return 文字列が途中で切れていない場合はtrue
+ */
+bool PluginScanProtocol::readString(juce::MemoryInputStream& stream, juce::String& text)
+{
+    int numBytes = 0;
+    if (!readCompressedInt(stream, numBytes) || numBytes < 0 || numBytes > stream.getNumBytesRemaining())
+        return false;
+    text = juce::String::fromUTF8(static_cast<const char*>(stream.getData()) + stream.getPosition(), numBytes);
+    stream.skipNextBytes(numBytes);
+    return true;
+}
+
+/**
+ * @brief プラグインの記述をバイナリ形式で書き込む
+ * @param stream 書き込み先
+ * @param description 書き込む記述
+ */
+void PluginScanProtocol::writeDescription(juce::MemoryOutputStream& stream,
+                                          const juce::PluginDescription& description)
+{
+    for (const auto* text : { &description.name, &description.descriptiveName,
+                              &description.pluginFormatName, &description.category,
+                              &description.manufacturerName, &description.version,
+                              &description.fileOrIdentifier })
+        writeString(stream, *text);
+    stream.writeInt64(description.lastFileModTime.toMilliseconds());
+    stream.writeInt64(description.lastInfoUpdateTime.toMilliseconds());
+    stream.writeInt(description.deprecatedUid);
+    stream.writeInt(description.uniqueId);
+    stream.writeInt(description.numInputChannels);
+    stream.writeInt(description.numOutputChannels);
+    stream.writeByte(static_cast<char>((description.isInstrument ? 1 : 0)
+                                       | (description.hasSharedContainer ? 2 : 0)
+                                       | (description.hasARAExtension ? 4 : 0)));
+}
+
+/**
+ * @brief バイナリ形式のプラグインの記述を読み込む
+ * @param stream 読み込み元
+ * @param description 読み込んだ記述
+ * @return メッセージが途中で切れていない場合はtrue
+ */
+bool PluginScanProtocol::readDescription(juce::MemoryInputStream& stream, juce::PluginDescription& description)
+{
+    for (auto* text : { &description.name, &description.descriptiveName,
+                        &description.pluginFormatName, &description.category,
+                        &description.manufacturerName, &description.version,
+                        &description.fileOrIdentifier })
+        if (!readString(stream, *text))
+            return false;
+
+    if (stream.getNumBytesRemaining() < descriptionFixedBytes)
+        return false;
+    description.lastFileModTime = juce::Time(stream.readInt64());
+    description.lastInfoUpdateTime = juce::Time(stream.readInt64());
+    description.deprecatedUid = stream.readInt();
+    description.uniqueId = stream.readInt();
+    description.numInputChannels = stream.readInt();
+    description.numOutputChannels = stream.readInt();
+    const auto flags = stream.readByte();
+    description.isInstrument = (flags & 1) != 0;
+    description.hasSharedContainer = (flags & 2) != 0;
+    description.hasARAExtension = (flags & 4) != 0;
+    return true;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+// Binary messages between PluginScanPool and its scanner processes. Every
+// message starts with a MessageType byte. Strings are a compressed byte count
+// followed by UTF-8; the child-process transport already frames each message,
+// so no other delimiters are needed. Readers never trust a count from the
+// other process: a message that is truncated, has trailing bytes or declares
+// more entries than it can hold is rejected before anything is allocated.
+class PluginScanProtocol final
+{
+public:
+    enum class MessageType : juce::uint8
+    {
+        ScanBatch = 1, // deadline (ms), count, then (job, format name, identifier) per entry
+        JobResult = 2, // job, description count, descriptions
+        TimedOut = 3   // job; the worker's watchdog sends it just before ending the process
+    };
+
+    struct ScanRequest
+    {
+        int job = -1;
+        juce::String formatName;
+        juce::String identifier;
+    };
+
+    static juce::MemoryBlock createScanBatch(int deadlineMs, const std::vector<ScanRequest>& requests);
+    static bool readScanBatch(const juce::MemoryBlock& message, int& deadlineMs,
+                              std::vector<ScanRequest>& requests);
+
+    static juce::MemoryBlock createJobResult(int job, const juce::OwnedArray<juce::PluginDescription>& descriptions);
+    static bool readJobResult(const juce::MemoryBlock& message, int& job,
+                              juce::OwnedArray<juce::PluginDescription>& descriptions);
+
+    static juce::MemoryBlock createTimedOut(int job);
+    static bool readTimedOut(const juce::MemoryBlock& message, int& job);
+
+    static void writeString(juce::MemoryOutputStream& stream, const juce::String& text);
+    static bool readString(juce::MemoryInputStream& stream, juce::String& text);
+    static void writeDescription(juce::MemoryOutputStream& stream, const juce::PluginDescription& description);
+    static bool readDescription(juce::MemoryInputStream& stream, juce::PluginDescription& description);
+};
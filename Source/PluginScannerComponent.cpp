@@ -1,8 +1,58 @@
 #include "PluginScannerComponent.h"
 
+#include <algorithm>
+
 namespace
 {
 constexpr auto pluginListKey = "knownPluginList";
+constexpr auto scanIndexKey = "pluginScanIndex";
+constexpr auto hashModulesKey = "hashPluginModules";
+constexpr auto scanDeadlineKey = "pluginScanDeadline";
+
+/**
+ * @brief 識別子を表示用に短くする（ファイルパスの場合はファイル名）
+ * @param identifier プラグインの識別子
+ * @return 表示名
+ */
+juce::String getDisplayName(const juce::String& identifier)
+{
+    return juce::File::isAbsolutePath(identifier) ? juce::File(identifier).getFileName() : identifier;
+}
+
+/**
+ * @brief スキャン時間の中央値、95パーセンタイル、最も遅い識別子、期限切れの数をまとめる
+ * @param times 識別子ごとのスキャン時間
+ * @return 表示用の文字列
+ */
+juce::String describeScanTimes(const std::vector<PluginScanPool::ScanTime>& times)
+{
+    if (times.empty())
+        return "No modules probed";
+
+    std::vector<double> seconds;
+    const PluginScanPool::ScanTime* slowest = nullptr;
+    int timedOut = 0;
+    int crashed = 0;
+    for (const auto& time : times)
+    {
+        seconds.push_back(time.seconds);
+        if (slowest == nullptr || time.seconds > slowest->seconds)
+            slowest = &time;
+        timedOut += time.outcome == PluginScanPool::ScanTime::Outcome::TimedOut ? 1 : 0;
+        crashed += time.outcome == PluginScanPool::ScanTime::Outcome::Crashed ? 1 : 0;
+    }
+    std::sort(seconds.begin(), seconds.end());
+    auto percentile = [&seconds](size_t percent)
+    {
+        return seconds[(seconds.size() - 1) * percent / 100];
+    };
+
+    return juce::String(static_cast<int>(times.size())) + " probed · median "
+         + juce::String(percentile(50), 2) + " s · p95 " + juce::String(percentile(95), 2)
+         + " s · slowest " + getDisplayName(slowest->identifier) + " ("
+         + juce::String(slowest->seconds, 1) + " s) · " + juce::String(timedOut)
+         + " timed out · " + juce::String(crashed) + " crashed";
+}
 
 /**
  * @brief
@@ -35,10 +85,11 @@ PluginScannerComponent::PluginScannerComponent(const juce::StringArray& scanPath
     : juce::Thread("Plugin scanner"),
       pathsToScan(scanPaths),
       properties(settings),
-      progressBar(displayedProgress)
+      progressBar(displayedProgress),
+      scanPool(scanResults, scanIndex, getDeadMansPedalFile(),
+               PluginScanPool::getDefaultWorkerCount())
 {
     addPluginFormats(formatManager);
-    scanResults.setCustomScanner(createIsolatedPluginScanner());
     loadPersistedList();
 
     addAndMakeVisible(pluginList);
@@ -59,12 +110,44 @@ PluginScannerComponent::PluginScannerComponent(const juce::StringArray& scanPath
         blacklistLabel.setText("Blacklist: empty", juce::dontSendNotification);
     };
 
+    // Size and modification time catch normal updates; hashing also catches
+    // modules replaced with their timestamps preserved, at the cost of
+    // reading every module on each scan.
+    addAndMakeVisible(verifyContentsButton);
+    hashContents.store(properties.getBoolValue(hashModulesKey, false));
+    verifyContentsButton.setToggleState(hashContents.load(), juce::dontSendNotification);
+    verifyContentsButton.onClick = [this]
+    {
+        hashContents.store(verifyContentsButton.getToggleState());
+        properties.setValue(hashModulesKey, verifyContentsButton.getToggleState());
+    };
+
+    // Adaptive picks the deadline from the scans seen so far; a fixed one
+    // bounds unattended rescans to (modules / workers) × deadline.
+    addAndMakeVisible(deadlineBox);
+    deadlineBox.addItem("Deadline: adaptive", 1);
+    for (auto seconds : { 10, 30, 60, 120, 300 })
+        deadlineBox.addItem("Deadline: " + juce::String(seconds) + " s", seconds + 1);
+    const auto savedDeadline = properties.getIntValue(scanDeadlineKey, 0);
+    deadlineBox.setSelectedId(deadlineBox.indexOfItemId(savedDeadline + 1) >= 0 ? savedDeadline + 1 : 1,
+                              juce::dontSendNotification);
+    scanPool.setDeadline(deadlineBox.getSelectedId() - 1);
+    deadlineBox.onChange = [this]
+    {
+        const auto seconds = deadlineBox.getSelectedId() - 1;
+        scanPool.setDeadline(seconds);
+        properties.setValue(scanDeadlineKey, seconds);
+    };
+
     addAndMakeVisible(progressBar);
     addAndMakeVisible(statusLabel);
     statusLabel.setColour(juce::Label::textColourId, juce::Colours::white);
     statusLabel.setText("Ready — " + juce::String(knownPluginList.getNumTypes())
                         + " plug-ins", juce::dontSendNotification);
 
+    addAndMakeVisible(scanTimeLabel);
+    scanTimeLabel.setColour(juce::Label::textColourId, juce::Colours::lightgrey);
+
     addAndMakeVisible(blacklistLabel);
     blacklistLabel.setColour(juce::Label::textColourId, juce::Colours::orange);
     blacklistLabel.setText("Blacklist: "
@@ -77,6 +160,7 @@ PluginScannerComponent::PluginScannerComponent(const juce::StringArray& scanPath
 PluginScannerComponent::~PluginScannerComponent()
 {
     stopTimer();
+    scanPool.cancel();
     signalThreadShouldExit();
     stopThread(5000);
     scanResults.scanFinished();
@@ -101,9 +185,12 @@ void PluginScannerComponent::resized()
     auto buttons = area.removeFromTop(34);
     scanButton.setBounds(buttons.removeFromLeft(150).reduced(2));
     clearBlacklistButton.setBounds(buttons.removeFromLeft(150).reduced(2));
+    verifyContentsButton.setBounds(buttons.removeFromLeft(130).reduced(2));
+    deadlineBox.setBounds(buttons.removeFromLeft(160).reduced(2));
     blacklistLabel.setBounds(buttons.reduced(4));
     progressBar.setBounds(area.removeFromTop(22).reduced(2));
     statusLabel.setBounds(area.removeFromTop(28).reduced(2));
+    scanTimeLabel.setBounds(area.removeFromTop(24).reduced(2));
     pluginList.setBounds(area.reduced(2));
 }
 
@@ -134,10 +221,20 @@ void PluginScannerComponent::paintListBoxItem(int row, juce::Graphics& g,
     if (juce::isPositiveAndBelow(row, types.size()))
     {
         const auto& type = types.getReference(row);
+        auto textWidth = width - 12;
+        // Probe time from the last scan, for modules that were loaded.
+        const auto seconds = scanSeconds.find(type.fileOrIdentifier);
+        if (seconds != scanSeconds.end())
+        {
+            g.setColour(juce::Colours::grey);
+            g.drawText(juce::String(seconds->second, 2) + " s", width - 76, 0, 70, height,
+                       juce::Justification::centredRight, false);
+            textWidth -= 76;
+        }
         g.setColour(juce::Colours::white);
         g.drawText(type.name + "  ·  " + type.manufacturerName
                    + "  (" + type.pluginFormatName + ")",
-                   6, 0, width - 12, height, juce::Justification::centredLeft, true);
+                   6, 0, textWidth, height, juce::Justification::centredLeft, true);
     }
 }
 
@@ -163,13 +260,14 @@ void PluginScannerComponent::startScan()
     scanResults.clear();
     if (auto saved = properties.getXmlValue(pluginListKey))
         scanResults.recreateFromXml(*saved);
-    scanResults.setCustomScanner(createIsolatedPluginScanner());
+    scanIndex.clear();
+    if (auto saved = properties.getXmlValue(scanIndexKey))
+        scanIndex.loadFromXml(*saved);
     juce::PluginDirectoryScanner::applyBlacklistingsFromDeadMansPedal(
         scanResults, getDeadMansPedalFile());
 
-    progress.store(0.0);
+    displayedProgress = 0.0;
     scanFinished.store(false);
-    failedFiles.clear();
     scanButton.setEnabled(false);
     pluginList.setEnabled(false);
     statusLabel.setText("Preparing scan…", juce::dontSendNotification);
@@ -186,35 +284,16 @@ void PluginScannerComponent::run()
     for (const auto& path : pathsToScan)
         searchPath.add(juce::File(path));
 
-    // Empty user paths still use each format's platform defaults.
-    for (auto* format : formatManager.getFormats())
-    {
-        auto formatPaths = searchPath;
-        if (formatPaths.getNumPaths() == 0)
-            formatPaths = format->getDefaultLocationsToSearch();
-
-        juce::PluginDirectoryScanner scanner(scanResults, *format, formatPaths, true,
-                                             getDeadMansPedalFile(), false);
-        juce::String name;
-        while (!threadShouldExit() && scanner.scanNextFile(true, name))
-        {
-            {
-                const juce::ScopedLock lock(stateLock);
-                currentPlugin = name;
-            }
-            progress.store(scanner.getProgress(), std::memory_order_release);
-        }
-
-        {
-            const juce::ScopedLock lock(stateLock);
-            failedFiles.addArray(scanner.getFailedFiles());
-        }
-        if (threadShouldExit())
-            return;
-    }
+    // Empty user paths still use each format's platform defaults. Every
+    // format's identifiers go into one queue shared by the scanner pool;
+    // bundles that describe themselves never reach it.
+    const auto jobs = scanPool.readMetadata(
+        PluginScanPool::createJobs(formatManager, searchPath, scanResults, scanIndex, hashContents.load()),
+        searchPath);
+    if (!scanPool.run(jobs))
+        return;
 
     scanResults.scanFinished();
-    progress.store(1.0, std::memory_order_release);
     scanFinished.store(true, std::memory_order_release);
 }
 
@@ -223,13 +302,13 @@ void PluginScannerComponent::run()
  */
 void PluginScannerComponent::timerCallback()
 {
-    displayedProgress = progress.load(std::memory_order_acquire);
+    displayedProgress = scanPool.getProgress();
     progressBar.repaint();
-    {
-        const juce::ScopedLock lock(stateLock);
-        if (isThreadRunning())
-            statusLabel.setText("Scanning: " + currentPlugin, juce::dontSendNotification);
-    }
+    if (isThreadRunning())
+        statusLabel.setText("Scanning (" + juce::String(scanPool.getNumWorkers()) + " workers, "
+                            + juce::String(scanPool.getCurrentDeadline(), 0) + " s deadline): "
+                            + scanPool.getCurrentIdentifier(),
+                            juce::dontSendNotification);
 
     if (scanFinished.exchange(false, std::memory_order_acq_rel))
         publishFinishedScan();
@@ -256,10 +335,15 @@ void PluginScannerComponent::publishFinishedScan()
     {
         knownPluginList.recreateFromXml(*xml);
         properties.setValue(pluginListKey, xml.get());
-        properties.saveIfNeeded();
     }
+    properties.setValue(scanIndexKey, scanIndex.createXml().get());
+    properties.saveIfNeeded();
 
-    const auto failedCount = failedFiles.size();
+    const auto failedCount = scanPool.getFailedFiles().size();
+    const auto times = scanPool.getScanTimes();
+    scanTimeLabel.setText(describeScanTimes(times), juce::dontSendNotification);
+    for (const auto& time : times)
+        scanSeconds[time.identifier] = time.seconds;
     statusLabel.setText("Complete — " + juce::String(knownPluginList.getNumTypes())
                         + " plug-ins, " + juce::String(failedCount) + " failed",
                         juce::dontSendNotification);
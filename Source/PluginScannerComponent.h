@@ -2,6 +2,7 @@
 
 #include <JuceHeader.h>
 #include "PluginScanIPC.h"
+#include <map>
 
 class PluginScannerComponent final : public juce::Component,
                                      public juce::ListBoxModel,
@@ -35,20 +36,23 @@ private:
     juce::ListBox pluginList;
     juce::TextButton scanButton { "Scan Plugins" };
     juce::TextButton clearBlacklistButton { "Clear Blacklist" };
+    juce::ToggleButton verifyContentsButton { "Verify contents" };
+    juce::ComboBox deadlineBox;
     juce::ProgressBar progressBar;
     juce::Label statusLabel;
     juce::Label blacklistLabel;
+    juce::Label scanTimeLabel;
 
     juce::AudioPluginFormatManager formatManager;
     juce::KnownPluginList knownPluginList;
     juce::KnownPluginList scanResults;
+    PluginScanIndex scanIndex;
+    PluginScanPool scanPool;
 
-    std::atomic<double> progress { 0.0 };
+    std::map<juce::String, double> scanSeconds;
     double displayedProgress = 0.0;
     std::atomic<bool> scanFinished { false };
-    juce::CriticalSection stateLock;
-    juce::String currentPlugin;
-    juce::StringArray failedFiles;
+    std::atomic<bool> hashContents { false };
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PluginScannerComponent)
 };
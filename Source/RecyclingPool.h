@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// A single-writer pool of shared objects that are reused once every reader
+// has released them. The writer fills an acquired slot and hands out copies
+// of its shared_ptr; copying only bumps the existing control block, so
+// publishing never allocates. A slot is free again when the pool holds the
+// only reference. Metadata stays with the slot across reuses, so the writer
+// can remember what the slot already contains.
+template <typename Value, typename Metadata>
+class RecyclingPool
+{
+public:
+    struct Slot
+    {
+        std::shared_ptr<Value> value;
+        Metadata metadata {};
+    };
+
+    explicit RecyclingPool(size_t initialCapacity)
+    {
+        slots.reserve(initialCapacity);
+        while (slots.size() < initialCapacity)
+            slots.push_back({ std::make_shared<Value>() });
+    }
+
+    /**
+     * @brief 読み手が参照していないスロットを取得
+     *
+     * すべてのスロットが使用中の場合だけ新しいスロットを確保する。
+     * 書き手のスレッドからのみ呼び出すこと。
+     * @return 書き込み可能なスロット
+     */
+    Slot& acquire()
+    {
+        for (size_t attempt = 0; attempt < slots.size(); ++attempt)
+        {
+            auto& slot = slots[nextSlot];
+            nextSlot = (nextSlot + 1) % slots.size();
+            if (slot.value.use_count() == 1)
+            {
+                // Pairs with the release in the last reader's reference drop,
+                // so its reads finish before the slot is overwritten.
+                std::atomic_thread_fence(std::memory_order_acquire);
+                return slot;
+            }
+        }
+
+        slots.push_back({ std::make_shared<Value>() });
+        return slots.back();
+    }
+
+    size_t getCapacity() const { return slots.size(); }
+
+private:
+    std::vector<Slot> slots;
+    size_t nextSlot = 0;
+};
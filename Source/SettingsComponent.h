@@ -27,10 +27,10 @@ public:
         fftOrderLabel.setText("FFT Size", juce::dontSendNotification);
         fftOrderLabel.setColour(juce::Label::textColourId, juce::Colours::white);
         addAndMakeVisible(fftOrderCombo);
-        for (int order = 9; order <= 14; ++order)
+        for (int order = 9; order <= 20; ++order)
             fftOrderCombo.addItem(juce::String(1 << order) + " (2^" + juce::String(order) + ")",
                                   order - 8);
-        fftOrderCombo.setSelectedId(juce::jlimit(1, 6, settings.fftOrder - 8),
+        fftOrderCombo.setSelectedId(juce::jlimit(1, 12, settings.fftOrder - 8),
                                     juce::dontSendNotification);
 
         addAndMakeVisible(pluginPathsLabel);
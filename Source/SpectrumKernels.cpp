@@ -0,0 +1,494 @@
+#include "SpectrumKernels.h"
+
+#include <cfloat>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+ #define PLUGIN_ANALYZER_X86_KERNELS 1
+ #include <immintrin.h>
+ #if defined(__GNUC__) || defined(__clang__)
+  #define PLUGIN_ANALYZER_AVX2_TARGET __attribute__((target("avx2")))
+ #else
+  #define PLUGIN_ANALYZER_AVX2_TARGET
+ #endif
+#else
+ #define PLUGIN_ANALYZER_X86_KERNELS 0
+#endif
+
+namespace
+{
+using DivideKernel = void (*)(const float*, const float*, const float*, float*, int, float, float);
+using DecibelKernel = void (*)(const float*, float*, float*, int, float);
+
+constexpr float pi = juce::MathConstants<float>::pi;
+constexpr float halfPi = juce::MathConstants<float>::halfPi;
+constexpr float sqrt2 = 1.41421356f;
+constexpr float ln2 = 0.693147181f;
+constexpr float inverseLn10 = 0.434294482f;
+// Minimax polynomial for atan(a) on [0, 1] in powers of a^2.
+constexpr float atanCoefficients[] = { 0.99997726f, -0.33262347f, 0.19354346f,
+                                       -0.11643287f, 0.05265332f, -0.01172120f };
+
+/**
+ * @brief 1ビンの複素除算と回転
+ */
+inline void divideBin(const float* numerator, const float* denominator, const float* rotation,
+                      float* result, int bin, float powerThreshold, float fallbackScale)
+{
+    const auto re = static_cast<size_t>(2 * bin);
+    const auto nr = numerator[re], ni = numerator[re + 1];
+    const auto dr = denominator[re], di = denominator[re + 1];
+    const auto power = dr * dr + di * di;
+    if (power > powerThreshold)
+    {
+        auto qr = (nr * dr + ni * di) / power;
+        auto qi = (ni * dr - nr * di) / power;
+        if (rotation != nullptr)
+        {
+            const auto cr = rotation[re], ci = rotation[re + 1];
+            const auto rotatedReal = qr * cr - qi * ci;
+            qi = qr * ci + qi * cr;
+            qr = rotatedReal;
+        }
+        result[re] = qr;
+        result[re + 1] = qi;
+    }
+    else
+    {
+        result[re] = nr * fallbackScale;
+        result[re + 1] = ni * fallbackScale;
+    }
+}
+
+/**
+ * @brief 1ビンの振幅（dB）と位相
+ */
+inline void decibelsAndPhaseBin(const float* spectrum, float* magnitudes, float* phases,
+                                int bin, float floorDecibels)
+{
+    const auto re = spectrum[static_cast<size_t>(2 * bin)];
+    const auto im = spectrum[static_cast<size_t>(2 * bin + 1)];
+    const auto power = re * re + im * im;
+    magnitudes[bin] = power > 0.0f && power <= FLT_MAX
+        ? juce::jmax(floorDecibels, 10.0f * std::log10(power))
+        : floorDecibels;
+    phases[bin] = std::atan2(im, re);
+}
+
+void divideScalar(const float* numerator, const float* denominator, const float* rotation,
+                  float* result, int bins, float powerThreshold, float fallbackScale)
+{
+    for (int bin = 0; bin < bins; ++bin)
+        divideBin(numerator, denominator, rotation, result, bin, powerThreshold, fallbackScale);
+}
+
+void decibelsAndPhaseScalar(const float* spectrum, float* magnitudes, float* phases,
+                            int bins, float floorDecibels)
+{
+    for (int bin = 0; bin < bins; ++bin)
+        decibelsAndPhaseBin(spectrum, magnitudes, phases, bin, floorDecibels);
+}
+
+#if PLUGIN_ANALYZER_X86_KERNELS
+//==============================================================================
+// SSE2: four bins per iteration.
+inline void deinterleave(const float* data, __m128& re, __m128& im)
+{
+    const auto low = _mm_loadu_ps(data);
+    const auto high = _mm_loadu_ps(data + 4);
+    re = _mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0));
+    im = _mm_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+inline void interleave(float* data, __m128 re, __m128 im)
+{
+    _mm_storeu_ps(data, _mm_unpacklo_ps(re, im));
+    _mm_storeu_ps(data + 4, _mm_unpackhi_ps(re, im));
+}
+
+inline __m128 select(__m128 mask, __m128 whenTrue, __m128 whenFalse)
+{
+    return _mm_or_ps(_mm_and_ps(mask, whenTrue), _mm_andnot_ps(mask, whenFalse));
+}
+
+// log10 of positive, normal values: the exponent is read from the bits and
+// ln(m) for m in [sqrt(1/2), sqrt(2)) comes from the atanh series.
+inline __m128 log10Positive(__m128 x)
+{
+    const auto bits = _mm_castps_si128(x);
+    auto exponent = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+    auto mantissa = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)),
+                                                  _mm_set1_epi32(0x3f800000)));
+    const auto large = _mm_cmpgt_ps(mantissa, _mm_set1_ps(sqrt2));
+    mantissa = select(large, _mm_mul_ps(mantissa, _mm_set1_ps(0.5f)), mantissa);
+    exponent = _mm_add_ps(exponent, _mm_and_ps(large, _mm_set1_ps(1.0f)));
+
+    const auto one = _mm_set1_ps(1.0f);
+    const auto t = _mm_div_ps(_mm_sub_ps(mantissa, one), _mm_add_ps(mantissa, one));
+    const auto t2 = _mm_mul_ps(t, t);
+    auto series = _mm_add_ps(_mm_set1_ps(1.0f / 5.0f), _mm_mul_ps(t2, _mm_set1_ps(1.0f / 7.0f)));
+    series = _mm_add_ps(_mm_set1_ps(1.0f / 3.0f), _mm_mul_ps(t2, series));
+    series = _mm_add_ps(one, _mm_mul_ps(t2, series));
+    const auto logMantissa = _mm_mul_ps(_mm_add_ps(t, t), series);
+    return _mm_mul_ps(_mm_add_ps(_mm_mul_ps(exponent, _mm_set1_ps(ln2)), logMantissa),
+                      _mm_set1_ps(inverseLn10));
+}
+
+inline __m128 atan2Approx(__m128 y, __m128 x)
+{
+    const auto signMask = _mm_set1_ps(-0.0f);
+    const auto ax = _mm_andnot_ps(signMask, x);
+    const auto ay = _mm_andnot_ps(signMask, y);
+    const auto largest = _mm_max_ps(ax, ay);
+    const auto ratio = _mm_and_ps(_mm_cmpgt_ps(largest, _mm_setzero_ps()),
+                                  _mm_div_ps(_mm_min_ps(ax, ay), largest));
+    const auto s = _mm_mul_ps(ratio, ratio);
+    auto polynomial = _mm_set1_ps(atanCoefficients[5]);
+    for (int index = 4; index >= 0; --index)
+        polynomial = _mm_add_ps(_mm_set1_ps(atanCoefficients[index]), _mm_mul_ps(s, polynomial));
+    auto angle = _mm_mul_ps(ratio, polynomial);
+    angle = select(_mm_cmpgt_ps(ay, ax), _mm_sub_ps(_mm_set1_ps(halfPi), angle), angle);
+    angle = select(_mm_cmplt_ps(x, _mm_setzero_ps()), _mm_sub_ps(_mm_set1_ps(pi), angle), angle);
+    return _mm_or_ps(angle, _mm_and_ps(signMask, y));
+}
+
+void divideSSE2(const float* numerator, const float* denominator, const float* rotation,
+                float* result, int bins, float powerThreshold, float fallbackScale)
+{
+    const auto threshold = _mm_set1_ps(powerThreshold);
+    const auto scale = _mm_set1_ps(fallbackScale);
+    int bin = 0;
+    for (; bin + 4 <= bins; bin += 4)
+    {
+        __m128 nr, ni, dr, di;
+        deinterleave(numerator + 2 * bin, nr, ni);
+        deinterleave(denominator + 2 * bin, dr, di);
+        const auto power = _mm_add_ps(_mm_mul_ps(dr, dr), _mm_mul_ps(di, di));
+        const auto valid = _mm_cmpgt_ps(power, threshold);
+        const auto divisor = select(valid, power, _mm_set1_ps(1.0f));
+        auto qr = _mm_div_ps(_mm_add_ps(_mm_mul_ps(nr, dr), _mm_mul_ps(ni, di)), divisor);
+        auto qi = _mm_div_ps(_mm_sub_ps(_mm_mul_ps(ni, dr), _mm_mul_ps(nr, di)), divisor);
+        if (rotation != nullptr)
+        {
+            __m128 cr, ci;
+            deinterleave(rotation + 2 * bin, cr, ci);
+            const auto rotatedReal = _mm_sub_ps(_mm_mul_ps(qr, cr), _mm_mul_ps(qi, ci));
+            qi = _mm_add_ps(_mm_mul_ps(qr, ci), _mm_mul_ps(qi, cr));
+            qr = rotatedReal;
+        }
+        interleave(result + 2 * bin,
+                   select(valid, qr, _mm_mul_ps(nr, scale)),
+                   select(valid, qi, _mm_mul_ps(ni, scale)));
+    }
+    for (; bin < bins; ++bin)
+        divideBin(numerator, denominator, rotation, result, bin, powerThreshold, fallbackScale);
+}
+
+void decibelsAndPhaseSSE2(const float* spectrum, float* magnitudes, float* phases,
+                          int bins, float floorDecibels)
+{
+    const auto floor = _mm_set1_ps(floorDecibels);
+    int bin = 0;
+    for (; bin + 4 <= bins; bin += 4)
+    {
+        __m128 re, im;
+        deinterleave(spectrum + 2 * bin, re, im);
+        const auto power = _mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im));
+        const auto valid = _mm_and_ps(_mm_cmpgt_ps(power, _mm_setzero_ps()),
+                                      _mm_cmple_ps(power, _mm_set1_ps(FLT_MAX)));
+        const auto decibels = _mm_mul_ps(_mm_set1_ps(10.0f),
+                                         log10Positive(select(valid, power, _mm_set1_ps(1.0f))));
+        _mm_storeu_ps(magnitudes + bin, select(valid, _mm_max_ps(decibels, floor), floor));
+        _mm_storeu_ps(phases + bin, atan2Approx(im, re));
+    }
+    for (; bin < bins; ++bin)
+        decibelsAndPhaseBin(spectrum, magnitudes, phases, bin, floorDecibels);
+}
+
+//==============================================================================
+// AVX2: eight bins per iteration, with the same approximations as SSE2.
+PLUGIN_ANALYZER_AVX2_TARGET inline void deinterleave(const float* data, __m256& re, __m256& im)
+{
+    const auto low = _mm256_loadu_ps(data);
+    const auto high = _mm256_loadu_ps(data + 8);
+    // Shuffles stay inside 128-bit lanes; the permute restores bin order.
+    const auto realLanes = _mm256_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0));
+    const auto imaginaryLanes = _mm256_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1));
+    re = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(realLanes), _MM_SHUFFLE(3, 1, 2, 0)));
+    im = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(imaginaryLanes), _MM_SHUFFLE(3, 1, 2, 0)));
+}
+
+PLUGIN_ANALYZER_AVX2_TARGET inline void interleave(float* data, __m256 re, __m256 im)
+{
+    const auto low = _mm256_unpacklo_ps(re, im);
+    const auto high = _mm256_unpackhi_ps(re, im);
+    _mm256_storeu_ps(data, _mm256_permute2f128_ps(low, high, 0x20));
+    _mm256_storeu_ps(data + 8, _mm256_permute2f128_ps(low, high, 0x31));
+}
+
+PLUGIN_ANALYZER_AVX2_TARGET inline __m256 select(__m256 mask, __m256 whenTrue, __m256 whenFalse)
+{
+    return _mm256_blendv_ps(whenFalse, whenTrue, mask);
+}
+
+PLUGIN_ANALYZER_AVX2_TARGET inline __m256 log10Positive(__m256 x)
+{
+    const auto bits = _mm256_castps_si256(x);
+    auto exponent = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23),
+                                                        _mm256_set1_epi32(127)));
+    auto mantissa = _mm256_castsi256_ps(_mm256_or_si256(
+        _mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)), _mm256_set1_epi32(0x3f800000)));
+    const auto large = _mm256_cmp_ps(mantissa, _mm256_set1_ps(sqrt2), _CMP_GT_OQ);
+    mantissa = select(large, _mm256_mul_ps(mantissa, _mm256_set1_ps(0.5f)), mantissa);
+    exponent = _mm256_add_ps(exponent, _mm256_and_ps(large, _mm256_set1_ps(1.0f)));
+
+    const auto one = _mm256_set1_ps(1.0f);
+    const auto t = _mm256_div_ps(_mm256_sub_ps(mantissa, one), _mm256_add_ps(mantissa, one));
+    const auto t2 = _mm256_mul_ps(t, t);
+    auto series = _mm256_add_ps(_mm256_set1_ps(1.0f / 5.0f), _mm256_mul_ps(t2, _mm256_set1_ps(1.0f / 7.0f)));
+    series = _mm256_add_ps(_mm256_set1_ps(1.0f / 3.0f), _mm256_mul_ps(t2, series));
+    series = _mm256_add_ps(one, _mm256_mul_ps(t2, series));
+    const auto logMantissa = _mm256_mul_ps(_mm256_add_ps(t, t), series);
+    return _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(exponent, _mm256_set1_ps(ln2)), logMantissa),
+                         _mm256_set1_ps(inverseLn10));
+}
+
+PLUGIN_ANALYZER_AVX2_TARGET inline __m256 atan2Approx(__m256 y, __m256 x)
+{
+    const auto signMask = _mm256_set1_ps(-0.0f);
+    const auto zero = _mm256_setzero_ps();
+    const auto ax = _mm256_andnot_ps(signMask, x);
+    const auto ay = _mm256_andnot_ps(signMask, y);
+    const auto largest = _mm256_max_ps(ax, ay);
+    const auto ratio = _mm256_and_ps(_mm256_cmp_ps(largest, zero, _CMP_GT_OQ),
+                                     _mm256_div_ps(_mm256_min_ps(ax, ay), largest));
+    const auto s = _mm256_mul_ps(ratio, ratio);
+    auto polynomial = _mm256_set1_ps(atanCoefficients[5]);
+    for (int index = 4; index >= 0; --index)
+        polynomial = _mm256_add_ps(_mm256_set1_ps(atanCoefficients[index]), _mm256_mul_ps(s, polynomial));
+    auto angle = _mm256_mul_ps(ratio, polynomial);
+    angle = select(_mm256_cmp_ps(ay, ax, _CMP_GT_OQ), _mm256_sub_ps(_mm256_set1_ps(halfPi), angle), angle);
+    angle = select(_mm256_cmp_ps(x, zero, _CMP_LT_OQ), _mm256_sub_ps(_mm256_set1_ps(pi), angle), angle);
+    return _mm256_or_ps(angle, _mm256_and_ps(signMask, y));
+}
+
+PLUGIN_ANALYZER_AVX2_TARGET
+void divideAVX2(const float* numerator, const float* denominator, const float* rotation,
+                float* result, int bins, float powerThreshold, float fallbackScale)
+{
+    const auto threshold = _mm256_set1_ps(powerThreshold);
+    const auto scale = _mm256_set1_ps(fallbackScale);
+    int bin = 0;
+    for (; bin + 8 <= bins; bin += 8)
+    {
+        __m256 nr, ni, dr, di;
+        deinterleave(numerator + 2 * bin, nr, ni);
+        deinterleave(denominator + 2 * bin, dr, di);
+        const auto power = _mm256_add_ps(_mm256_mul_ps(dr, dr), _mm256_mul_ps(di, di));
+        const auto valid = _mm256_cmp_ps(power, threshold, _CMP_GT_OQ);
+        const auto divisor = select(valid, power, _mm256_set1_ps(1.0f));
+        auto qr = _mm256_div_ps(_mm256_add_ps(_mm256_mul_ps(nr, dr), _mm256_mul_ps(ni, di)), divisor);
+        auto qi = _mm256_div_ps(_mm256_sub_ps(_mm256_mul_ps(ni, dr), _mm256_mul_ps(nr, di)), divisor);
+        if (rotation != nullptr)
+        {
+            __m256 cr, ci;
+            deinterleave(rotation + 2 * bin, cr, ci);
+            const auto rotatedReal = _mm256_sub_ps(_mm256_mul_ps(qr, cr), _mm256_mul_ps(qi, ci));
+            qi = _mm256_add_ps(_mm256_mul_ps(qr, ci), _mm256_mul_ps(qi, cr));
+            qr = rotatedReal;
+        }
+        interleave(result + 2 * bin,
+                   select(valid, qr, _mm256_mul_ps(nr, scale)),
+                   select(valid, qi, _mm256_mul_ps(ni, scale)));
+    }
+    for (; bin < bins; ++bin)
+        divideBin(numerator, denominator, rotation, result, bin, powerThreshold, fallbackScale);
+}
+
+PLUGIN_ANALYZER_AVX2_TARGET
+void decibelsAndPhaseAVX2(const float* spectrum, float* magnitudes, float* phases,
+                          int bins, float floorDecibels)
+{
+    const auto floor = _mm256_set1_ps(floorDecibels);
+    int bin = 0;
+    for (; bin + 8 <= bins; bin += 8)
+    {
+        __m256 re, im;
+        deinterleave(spectrum + 2 * bin, re, im);
+        const auto power = _mm256_add_ps(_mm256_mul_ps(re, re), _mm256_mul_ps(im, im));
+        const auto valid = _mm256_and_ps(_mm256_cmp_ps(power, _mm256_setzero_ps(), _CMP_GT_OQ),
+                                         _mm256_cmp_ps(power, _mm256_set1_ps(FLT_MAX), _CMP_LE_OQ));
+        const auto decibels = _mm256_mul_ps(_mm256_set1_ps(10.0f),
+                                            log10Positive(select(valid, power, _mm256_set1_ps(1.0f))));
+        _mm256_storeu_ps(magnitudes + bin, select(valid, _mm256_max_ps(decibels, floor), floor));
+        _mm256_storeu_ps(phases + bin, atan2Approx(im, re));
+    }
+    for (; bin < bins; ++bin)
+        decibelsAndPhaseBin(spectrum, magnitudes, phases, bin, floorDecibels);
+}
+#endif
+
+struct KernelTable
+{
+    SpectrumKernels::InstructionSet instructionSet = SpectrumKernels::InstructionSet::Scalar;
+    DivideKernel divide = divideScalar;
+    DecibelKernel decibelsAndPhase = decibelsAndPhaseScalar;
+};
+
+/**
+ * @brief 命令セットのカーネルを取得
+ * @param instructionSet 命令セット
+ * @return カーネル。このビルドまたはCPUで使えない場合はスカラー版
+ */
+KernelTable getKernelsFor(SpectrumKernels::InstructionSet instructionSet)
+{
+   #if PLUGIN_ANALYZER_X86_KERNELS
+    if (instructionSet == SpectrumKernels::InstructionSet::AVX2 && juce::SystemStats::hasAVX2())
+        return { SpectrumKernels::InstructionSet::AVX2, divideAVX2, decibelsAndPhaseAVX2 };
+    if (instructionSet == SpectrumKernels::InstructionSet::SSE2 && juce::SystemStats::hasSSE2())
+        return { SpectrumKernels::InstructionSet::SSE2, divideSSE2, decibelsAndPhaseSSE2 };
+   #else
+    juce::ignoreUnused(instructionSet);
+   #endif
+    return {};
+}
+
+/**
+ * @brief 実行中のCPUで使える最速のカーネルを一度だけ選択
+ */
+const KernelTable& getKernels()
+{
+    static const auto table = []
+    {
+        for (const auto instructionSet : { SpectrumKernels::InstructionSet::AVX2,
+                                           SpectrumKernels::InstructionSet::SSE2 })
+            if (SpectrumKernels::isAvailable(instructionSet))
+                return getKernelsFor(instructionSet);
+        return KernelTable {};
+    }();
+    return table;
+}
+}
+
+/**
+ * @brief このビルドと実行中のCPUで命令セットを使えるかを判定
+ * @param instructionSet 命令セット
+ * @return 使える場合はtrue（スカラー版は常にtrue）
+ */
+bool SpectrumKernels::isAvailable(InstructionSet instructionSet)
+{
+    return getKernelsFor(instructionSet).instructionSet == instructionSet;
+}
+
+/**
+ * @brief 実行時に選択された命令セットを取得
+ * @return 命令セット
+ */
+SpectrumKernels::InstructionSet SpectrumKernels::getInstructionSet()
+{
+    return getKernels().instructionSet;
+}
+
+/**
+ * @brief 命令セットの表示名を取得
+ * @param instructionSet 命令セット
+ * @return 表示名
+ */
+const char* SpectrumKernels::getInstructionSetName(InstructionSet instructionSet)
+{
+    switch (instructionSet)
+    {
+        case InstructionSet::Scalar: return "Scalar";
+        case InstructionSet::SSE2: return "SSE2";
+        case InstructionSet::AVX2: return "AVX2";
+    }
+    return "Scalar";
+}
+
+/**
+ * @brief 伝達関数の複素除算とレイテンシ補正の回転
+ * @param numerator 出力スペクトル（インターリーブ複素数）
+ * @param denominator 入力スペクトル（インターリーブ複素数）
+ * @param rotation ビンごとの回転（インターリーブ複素数）。不要な場合はnullptr
+ * @param result 結果の格納先（numeratorと同じでもよい）
+ * @param bins ビン数
+ * @param powerThreshold 除算を行う入力パワーの下限
+ * @param fallbackScale 除算しないビンに掛けるスケール
+ */
+void SpectrumKernels::divide(const float* numerator, const float* denominator,
+                             const float* rotation, float* result, int bins,
+                             float powerThreshold, float fallbackScale)
+{
+    getKernels().divide(numerator, denominator, rotation, result, bins,
+                        powerThreshold, fallbackScale);
+}
+
+/**
+ * @brief 指定した命令セットで伝達関数の複素除算とレイテンシ補正の回転
+ * @param instructionSet 命令セット（使えない場合はスカラー版で計算）
+ * @param numerator 出力スペクトル（インターリーブ複素数）
+ * @param denominator 入力スペクトル（インターリーブ複素数）
+ * @param rotation ビンごとの回転（インターリーブ複素数）。不要な場合はnullptr
+ * @param result 結果の格納先（numeratorと同じでもよい）
+ * @param bins ビン数
+ * @param powerThreshold 除算を行う入力パワーの下限
+ * @param fallbackScale 除算しないビンに掛けるスケール
+ */
+void SpectrumKernels::divide(InstructionSet instructionSet, const float* numerator, const float* denominator,
+                             const float* rotation, float* result, int bins,
+                             float powerThreshold, float fallbackScale)
+{
+    getKernelsFor(instructionSet).divide(numerator, denominator, rotation, result, bins,
+                                         powerThreshold, fallbackScale);
+}
+
+/**
+ * @brief レイテンシ補正の回転テーブルを作成
+ * @param rotation 格納先（インターリーブ複素数、bins個）
+ * @param bins ビン数
+ * @param delaySamples 補正するレイテンシ（サンプル）
+ * @param fftSize FFTサイズ
+ */
+void SpectrumKernels::createRotation(float* rotation, int bins, int delaySamples, int fftSize)
+{
+    for (int bin = 0; bin < bins; ++bin)
+    {
+        // Reducing the phase modulo the FFT size keeps it exact for long delays.
+        const auto turns = (static_cast<std::int64_t>(bin) * delaySamples) % fftSize;
+        const auto value = std::polar(1.0, juce::MathConstants<double>::twoPi
+                                           * static_cast<double>(turns) / fftSize);
+        rotation[2 * bin] = static_cast<float>(value.real());
+        rotation[2 * bin + 1] = static_cast<float>(value.imag());
+    }
+}
+
+/**
+ * @brief 複素スペクトルを振幅（dB）と位相へ変換
+ * @param spectrum 入力スペクトル（インターリーブ複素数）
+ * @param magnitudes 振幅（dB）の格納先
+ * @param phases 位相（ラジアン）の格納先
+ * @param bins ビン数
+ * @param floorDecibels 振幅の下限（dB）
+ */
+void SpectrumKernels::toDecibelsAndPhase(const float* spectrum, float* magnitudes,
+                                         float* phases, int bins, float floorDecibels)
+{
+    getKernels().decibelsAndPhase(spectrum, magnitudes, phases, bins, floorDecibels);
+}
+
+/**
+ * @brief 指定した命令セットで複素スペクトルを振幅（dB）と位相へ変換
+ * @param instructionSet 命令セット（使えない場合はスカラー版で計算）
+ * @param spectrum 入力スペクトル（インターリーブ複素数）
+ * @param magnitudes 振幅（dB）の格納先
+ * @param phases 位相（ラジアン）の格納先
+ * @param bins ビン数
+ * @param floorDecibels 振幅の下限（dB）
+ */
+void SpectrumKernels::toDecibelsAndPhase(InstructionSet instructionSet, const float* spectrum,
+                                         float* magnitudes, float* phases, int bins, float floorDecibels)
+{
+    getKernelsFor(instructionSet).decibelsAndPhase(spectrum, magnitudes, phases, bins, floorDecibels);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Vectorised per-bin post-processing of the analysis spectra. Every kernel
+// works on JUCE's interleaved complex layout (re, im per bin) and is selected
+// once at run time: AVX2 or SSE2 on x86, otherwise a portable scalar loop.
+// The SIMD paths use polynomial log10/atan2 approximations that stay within
+// 5e-5 dB and 3e-6 rad of the standard library.
+class SpectrumKernels final
+{
+public:
+    enum class InstructionSet
+    {
+        Scalar,
+        SSE2,
+        AVX2
+    };
+
+    static InstructionSet getInstructionSet();
+    static const char* getInstructionSetName(InstructionSet instructionSet);
+    static bool isAvailable(InstructionSet instructionSet);
+
+    // result = numerator / denominator * rotation for every bin whose
+    // denominator power exceeds powerThreshold, otherwise numerator * fallbackScale.
+    // rotation may be null; result may alias numerator.
+    static void divide(const float* numerator, const float* denominator,
+                       const float* rotation, float* result, int bins,
+                       float powerThreshold, float fallbackScale);
+
+    // Fills rotation with exp(i * 2pi * bin * delay / fftSize).
+    static void createRotation(float* rotation, int bins, int delaySamples, int fftSize);
+
+    // Magnitudes in dB floored at floorDecibels (non-finite bins included)
+    // and phases in radians.
+    static void toDecibelsAndPhase(const float* spectrum, float* magnitudes,
+                                   float* phases, int bins, float floorDecibels);
+
+    // The same kernels on one instruction set, so each path can be checked
+    // on its own; an unavailable set runs the scalar loop.
+    static void divide(InstructionSet instructionSet, const float* numerator, const float* denominator,
+                       const float* rotation, float* result, int bins,
+                       float powerThreshold, float fallbackScale);
+    static void toDecibelsAndPhase(InstructionSet instructionSet, const float* spectrum, float* magnitudes,
+                                   float* phases, int bins, float floorDecibels);
+};
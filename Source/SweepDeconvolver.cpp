@@ -0,0 +1,196 @@
+#include "SweepDeconvolver.h"
+#include "TestSignalGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+// Regularises the spectral division outside the swept band, relative to the
+// strongest excitation bin. The ESS spectrum falls by 30 dB across 20 Hz to
+// 20 kHz, so this stays well below every in-band bin.
+constexpr double divisionRegularisation = 1.0e-6;
+}
+
+/**
+ * @brief 同期スイープの測定を準備
+ * @param sampleRate サンプリング周波数
+ * @param startFrequency スイープ開始周波数
+ * @param endFrequencyToUse スイープ終了周波数
+ * @param sweepSeconds スイープの目標の長さ（秒）
+ * @param tailSeconds スイープ後に録音する残響・レイテンシの最小長（秒）
+ */
+void SweepDeconvolver::prepare(double sampleRate, double startFrequency,
+                               double endFrequencyToUse, double sweepSeconds,
+                               double tailSeconds)
+{
+    currentSampleRate = sampleRate;
+    endFrequency = endFrequencyToUse;
+    sweepRate = TestSignalGenerator::getSynchronizedSweepRate(startFrequency, endFrequency,
+                                                              sweepSeconds);
+    const auto sweepLength = TestSignalGenerator::getSynchronizedSweepLength(
+        startFrequency, endFrequency, sweepSeconds, sampleRate);
+    const auto length = juce::nextPowerOfTwo(sweepLength + juce::roundToInt(tailSeconds * sampleRate));
+
+    if (length != captureLength)
+    {
+        captureLength = length;
+        captureFFT = std::make_unique<juce::dsp::FFT>(
+            juce::findHighestSetBit(static_cast<juce::uint32>(length)));
+        // JUCE's real-only transforms work in place on 2 * N floats.
+        capturedInput.resize(static_cast<size_t>(length * 2));
+        capturedOutputL.resize(static_cast<size_t>(length * 2));
+        capturedOutputR.resize(static_cast<size_t>(length * 2));
+    }
+    std::fill(capturedInput.begin(), capturedInput.end(), 0.0f);
+    std::fill(capturedOutputL.begin(), capturedOutputL.end(), 0.0f);
+    std::fill(capturedOutputR.begin(), capturedOutputR.end(), 0.0f);
+    capturedSamples = 0;
+}
+
+/**
+ * @brief 励振信号と出力を録音
+ * @param input 励振信号
+ * @param outputL 左チャンネル出力
+ * @param outputR 右チャンネル出力
+ * @param numSamples サンプル数
+ * @return 録音したサンプル数。録音バッファが満杯になると numSamples より少なくなる
+ */
+int SweepDeconvolver::addSamples(const float* input, const float* outputL,
+                                 const float* outputR, int numSamples)
+{
+    const auto count = juce::jmin(numSamples, captureLength - capturedSamples);
+    if (count <= 0)
+        return 0;
+
+    const auto offset = static_cast<size_t>(capturedSamples);
+    juce::FloatVectorOperations::copy(capturedInput.data() + offset, input, count);
+    juce::FloatVectorOperations::copy(capturedOutputL.data() + offset, outputL, count);
+    juce::FloatVectorOperations::copy(capturedOutputR.data() + offset, outputR, count);
+    capturedSamples += count;
+    return count;
+}
+
+/**
+ * @brief 録音を逆畳み込みし、高調波ごとの周波数応答を求める
+ * @param responseOrder 各応答のFFT次数
+ * @param latencySamples プラグインの報告レイテンシ。0以下の場合は線形応答のピークから検出
+ * @return 使用したレイテンシ（サンプル）
+ */
+int SweepDeconvolver::deconvolve(int responseOrder, int latencySamples)
+{
+    jassert(capturedSamples == captureLength);
+    captureFFT->performRealOnlyForwardTransform(capturedInput.data(), true);
+
+    double peakPower = 0.0;
+    for (int bin = 0; bin <= captureLength / 2; ++bin)
+        peakPower = juce::jmax(peakPower, std::norm(std::complex<double>(
+            capturedInput[static_cast<size_t>(2 * bin)],
+            capturedInput[static_cast<size_t>(2 * bin + 1)])));
+    const auto regularisation = juce::jmax(peakPower * divisionRegularisation, 1.0e-30);
+
+    // Multiplying by conj(X) / (|X|^2 + e) is the frequency-domain form of
+    // Farina's inverse filter, built from the excitation that was actually played.
+    for (auto* output : { &capturedOutputL, &capturedOutputR })
+    {
+        auto& data = *output;
+        captureFFT->performRealOnlyForwardTransform(data.data(), true);
+        for (int bin = 0; bin <= captureLength / 2; ++bin)
+        {
+            const auto re = static_cast<size_t>(2 * bin);
+            const std::complex<double> excitation(capturedInput[re], capturedInput[re + 1]);
+            const std::complex<double> response(data[re], data[re + 1]);
+            const auto transfer = response * std::conj(excitation)
+                                / (std::norm(excitation) + regularisation);
+            data[re] = static_cast<float>(transfer.real());
+            data[re + 1] = static_cast<float>(transfer.imag());
+        }
+        captureFFT->performRealOnlyInverseTransform(data.data());
+    }
+
+    auto latency = latencySamples;
+    if (latency <= 0)
+    {
+        const auto begin = capturedOutputL.begin();
+        latency = static_cast<int>(std::distance(begin, std::max_element(
+            begin, begin + captureLength / 2,
+            [](float a, float b) { return std::abs(a) < std::abs(b); })));
+    }
+
+    responseSize = 1 << responseOrder;
+    if (responseFFT == nullptr || responseFFT->getSize() != responseSize)
+        responseFFT = std::make_unique<juce::dsp::FFT>(responseOrder);
+    responseBuffer.resize(static_cast<size_t>(responseSize * 2));
+
+    // Harmonic k arrives L*ln(k) seconds early. Each window reaches halfway to
+    // its neighbours so that adjacent harmonics never overlap. A response FFT
+    // longer than the capture zero-pads instead of reading the circular
+    // impulse twice.
+    const auto windowSize = juce::jmin(responseSize, captureLength);
+    const auto delayOf = [this](int harmonic)
+    {
+        return sweepRate * std::log(static_cast<double>(harmonic)) * currentSampleRate;
+    };
+    for (int harmonic = 1; harmonic <= maxHarmonics; ++harmonic)
+    {
+        const auto delay = delayOf(harmonic);
+        const auto halfGapBefore = static_cast<int>((delayOf(harmonic + 1) - delay) * 0.5);
+        const auto before = juce::jmin(harmonic == 1 ? windowSize / 4 : windowSize / 2,
+                                       halfGapBefore);
+        const auto after = harmonic == 1
+            ? windowSize - before
+            : juce::jmin(windowSize - before,
+                         static_cast<int>((delay - delayOf(harmonic - 1)) * 0.5));
+        extractResponse(capturedOutputL, latency - delay, before, after,
+                        harmonicResponses[static_cast<size_t>(harmonic - 1)]);
+        if (harmonic == 1)
+            extractResponse(capturedOutputR, latency, before, after, linearResponseR);
+    }
+    return latency;
+}
+
+/**
+ * @brief インパルス応答の一部を切り出して周波数応答へ変換
+ * @param impulse 逆畳み込み済みのインパルス応答（循環）
+ * @param centre 切り出す応答の時間原点（サンプル、小数可）
+ * @param before 原点より前に含めるサンプル数
+ * @param after 原点以降に含めるサンプル数
+ * @param response 周波数応答の格納先
+ */
+void SweepDeconvolver::extractResponse(const std::vector<float>& impulse, double centre,
+                                       int before, int after,
+                                       std::vector<std::complex<double>>& response)
+{
+    std::fill(responseBuffer.begin(), responseBuffer.end(), 0.0f);
+    const auto origin = static_cast<int>(std::floor(centre));
+    const auto fadeBefore = juce::jmax(1, before / 4);
+    const auto fadeAfter = juce::jmax(1, after / 4);
+    for (int offset = -before; offset < after; ++offset)
+    {
+        // Half-Hann tapers at both window edges limit truncation ripple.
+        auto gain = 1.0;
+        if (offset < fadeBefore - before)
+            gain = 0.5 - 0.5 * std::cos(juce::MathConstants<double>::pi
+                                        * (offset + before) / fadeBefore);
+        else if (offset >= after - fadeAfter)
+            gain = 0.5 - 0.5 * std::cos(juce::MathConstants<double>::pi
+                                        * (after - offset) / fadeAfter);
+
+        const auto source = ((origin + offset) % captureLength + captureLength) % captureLength;
+        responseBuffer[static_cast<size_t>((offset + responseSize) % responseSize)] =
+            static_cast<float>(impulse[static_cast<size_t>(source)] * gain);
+    }
+    responseFFT->performRealOnlyForwardTransform(responseBuffer.data(), true);
+
+    // The window starts on a whole sample; restore the fractional advance so
+    // the harmonic phases stay referenced to the true arrival time.
+    const auto fraction = centre - origin;
+    response.resize(static_cast<size_t>(responseSize / 2));
+    for (int bin = 0; bin < responseSize / 2; ++bin)
+    {
+        const std::complex<double> value(responseBuffer[static_cast<size_t>(2 * bin)],
+                                         responseBuffer[static_cast<size_t>(2 * bin + 1)]);
+        response[static_cast<size_t>(bin)] = value * std::polar(
+            1.0, juce::MathConstants<double>::twoPi * bin * fraction / responseSize);
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <complex>
+#include <memory>
+#include <vector>
+
+// Exponential sine sweep measurement (Farina) with the synchronised sweep of
+// Novak et al. Deconvolving one capture places the k-th harmonic impulse
+// response L*ln(k) seconds before the linear one, so each harmonic can be cut
+// out with its own time window and H1..H10 are measured from a single sweep.
+class SweepDeconvolver
+{
+public:
+    static constexpr int maxHarmonics = 10;
+
+    void prepare(double sampleRate, double startFrequency, double endFrequency,
+                 double sweepSeconds, double tailSeconds);
+    int addSamples(const float* input, const float* outputL, const float* outputR,
+                   int numSamples);
+    bool isCaptureComplete() const { return capturedSamples == captureLength; }
+    int deconvolve(int responseOrder, int latencySamples);
+
+    int getCaptureLength() const { return captureLength; }
+    int getCapturedSamples() const { return capturedSamples; }
+    double getEndFrequency() const { return endFrequency; }
+
+    // Indexed by output frequency bin of the response FFT; H_k(f) is the k-th
+    // harmonic produced at f by a fundamental of f / k.
+    const std::vector<std::complex<double>>& getHarmonicResponse(int harmonic) const
+    {
+        return harmonicResponses[static_cast<size_t>(harmonic - 1)];
+    }
+    const std::vector<std::complex<double>>& getLinearResponseRight() const
+    {
+        return linearResponseR;
+    }
+
+private:
+    void extractResponse(const std::vector<float>& impulse, double centre,
+                         int before, int after,
+                         std::vector<std::complex<double>>& response);
+
+    double currentSampleRate = 44100.0;
+    double sweepRate = 0.0;
+    double endFrequency = 20000.0;
+    int captureLength = 0;
+    int capturedSamples = 0;
+    int responseSize = 0;
+
+    std::unique_ptr<juce::dsp::FFT> captureFFT;
+    std::unique_ptr<juce::dsp::FFT> responseFFT;
+    std::vector<float> capturedInput, capturedOutputL, capturedOutputR;
+    std::vector<float> responseBuffer;
+    std::array<std::vector<std::complex<double>>, maxHarmonics> harmonicResponses;
+    std::vector<std::complex<double>> linearResponseR;
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "Domain/MultitonePlan.h"
 
 class TestSignalGenerator
 {
@@ -9,9 +10,11 @@ public:
     {
         Impulse,
         SineSweep,
+        SynchronizedSweep,
         WhiteNoise,
         Sine,
         IMDDualTone,
+        Multitone,
         Ramp,
         AttackRelease
     };
@@ -52,12 +55,18 @@ public:
         case SignalType::IMDDualTone:
             generateIMDDualTone(writePointer, numSamples);
             break;
+        case SignalType::Multitone:
+            generateMultitone(writePointer, numSamples);
+            break;
         case SignalType::WhiteNoise:
             generateWhiteNoise(writePointer, numSamples);
             break;
         case SignalType::SineSweep:
             generateSineSweep(writePointer, numSamples);
             break;
+        case SignalType::SynchronizedSweep:
+            generateSynchronizedSweep(writePointer, numSamples);
+            break;
         case SignalType::Ramp:
             generateRamp(writePointer, numSamples);
             break;
@@ -80,6 +89,7 @@ public:
         sweepSampleCount = 0;
         imdPhase1 = 0.0;
         imdPhase2 = 0.0;
+        multitoneSampleCount = 0;
         rampSampleCount = 0;
         attackReleaseSampleCount = 0;
         isInAttackPhase = true;
@@ -102,6 +112,17 @@ public:
         imdAmplitudeRatio = juce::jmax(0.01, lowToHighRatio);
     }
 
+    /**
+     * @brief マルチトーン刺激を設定
+     * @param plan 再生する計画。ジェネレーターより長く存続すること
+     * @param framesPerSet 各セットを再生するFFTフレーム数
+     */
+    void setMultitone(const plugin_analyzer::domain::MultitonePlan* plan, int framesPerSet)
+    {
+        multitonePlan = plan;
+        multitoneFramesPerSet = juce::jmax(1, framesPerSet);
+    }
+
     void setSweepParameters(double startFreq, double endFreq, double duration)
     {
         sweepStartFreq = startFreq;
@@ -109,6 +130,50 @@ public:
         sweepDuration = duration;
     }
 
+    /**
+     * @brief 同期スイープの範囲と長さを設定（サインスイープの設定とは独立）
+     * @param startFreq 開始周波数
+     * @param endFreq 終了周波数
+     * @param duration 目標の長さ（秒）
+     */
+    void setSynchronizedSweepParameters(double startFreq, double endFreq, double duration)
+    {
+        synchronizedSweepStartFreq = startFreq;
+        synchronizedSweepEndFreq = endFreq;
+        synchronizedSweepDuration = duration;
+    }
+
+    /**
+     * @brief 同期スイープのスイープレートLを取得
+     *
+     * Lをf1の逆数の整数倍に丸めると、k次高調波のスイープが基本波スイープを
+     * L*ln(k)秒進めた信号と一致し、各高調波の位相が保たれる。
+     * @param startFreq 開始周波数
+     * @param endFreq 終了周波数
+     * @param duration 目標の長さ（秒）
+     * @return スイープレートL（秒）
+     */
+    static double getSynchronizedSweepRate(double startFreq, double endFreq, double duration)
+    {
+        const auto octaves = std::log(endFreq / startFreq);
+        return juce::jmax(1.0, std::round(startFreq * duration / octaves)) / startFreq;
+    }
+
+    /**
+     * @brief 同期スイープの長さを取得
+     * @param startFreq 開始周波数
+     * @param endFreq 終了周波数
+     * @param duration 目標の長さ（秒）
+     * @param sampleRate サンプリング周波数
+     * @return スイープのサンプル数
+     */
+    static int getSynchronizedSweepLength(double startFreq, double endFreq,
+                                          double duration, double sampleRate)
+    {
+        const auto rate = getSynchronizedSweepRate(startFreq, endFreq, duration);
+        return static_cast<int>(std::ceil(rate * std::log(endFreq / startFreq) * sampleRate));
+    }
+
     void setRampParameters(double duration, float startLevel, float endLevel)
     {
         rampDuration = duration;
@@ -143,6 +208,11 @@ private:
     double sweepEndFreq = 20000.0;
     double sweepDuration = 5.0;
 
+	// 同期スイープ状態（サンプル位置はサインスイープと共有）
+    double synchronizedSweepStartFreq = 20.0;
+    double synchronizedSweepEndFreq = 20000.0;
+    double synchronizedSweepDuration = 5.0;
+
 	// IMD状態
     double imdPhase1 = 0.0;
     double imdPhase2 = 0.0;
@@ -150,6 +220,11 @@ private:
     double imdFreq2 = 8000.0;
     double imdAmplitudeRatio = 1.0;
 
+	// マルチトーン状態
+    const plugin_analyzer::domain::MultitonePlan* multitonePlan = nullptr;
+    int multitoneFramesPerSet = 1;
+    int multitoneSampleCount = 0;
+
 	// ランプ状態
     int rampSampleCount = 0;
     double rampDuration = 2.0;
@@ -231,6 +306,34 @@ private:
         }
     }
 
+    /**
+     * @brief マルチトーンの各セットを順に再生
+     *
+     * セットはFFTフレームの境界で切り替わり、最後のセットはそのまま繰り返す。
+     * @param buffer 出力バッファ
+     * @param numSamples サンプル数
+     */
+    void generateMultitone(float* buffer, int numSamples)
+    {
+        if (multitonePlan == nullptr || multitonePlan->sets.empty())
+        {
+            juce::FloatVectorOperations::clear(buffer, numSamples);
+            return;
+        }
+
+        const auto period = multitonePlan->fftSize;
+        const auto lastSet = static_cast<int>(multitonePlan->sets.size()) - 1;
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto set = juce::jmin(lastSet, multitoneSampleCount / (period * multitoneFramesPerSet));
+            const auto& waveform = multitonePlan->sets[static_cast<size_t>(set)].waveform;
+            buffer[i] = amplitude * waveform[static_cast<size_t>(multitoneSampleCount % period)];
+            // Wrap by whole periods inside the final set so the counter cannot overflow.
+            if (++multitoneSampleCount >= (lastSet + 1) * period * multitoneFramesPerSet)
+                multitoneSampleCount -= period;
+        }
+    }
+
     /**
 	 * @brief サインスイープ信号を生成
 	 * @param buffer 出力バッファ
@@ -264,6 +367,40 @@ private:
         }
     }
 
+    /**
+     * @brief 同期指数スイープを1回だけ生成し、その後は無音を出力
+     * @param buffer 出力バッファ
+     * @param numSamples サンプル数
+     */
+    void generateSynchronizedSweep(float* buffer, int numSamples)
+    {
+        const auto rate = getSynchronizedSweepRate(synchronizedSweepStartFreq, synchronizedSweepEndFreq,
+                                                   synchronizedSweepDuration);
+        const auto length = getSynchronizedSweepLength(synchronizedSweepStartFreq, synchronizedSweepEndFreq,
+                                                       synchronizedSweepDuration, currentSampleRate);
+        // A short fade-out keeps the final step from adding a broadband click.
+        const auto fadeLength = juce::jmax(1, juce::roundToInt(0.005 * currentSampleRate));
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            if (sweepSampleCount >= length)
+            {
+                buffer[i] = 0.0f;
+                continue;
+            }
+
+            const auto time = sweepSampleCount / currentSampleRate;
+            const auto sweepPhase = juce::MathConstants<double>::twoPi * synchronizedSweepStartFreq * rate
+                                  * (std::exp(time / rate) - 1.0);
+            const auto remaining = length - sweepSampleCount;
+            const auto fade = remaining < fadeLength
+                ? 0.5 - 0.5 * std::cos(juce::MathConstants<double>::pi * remaining / fadeLength)
+                : 1.0;
+            buffer[i] = static_cast<float>(amplitude * fade * std::sin(sweepPhase));
+            ++sweepSampleCount;
+        }
+    }
+
     /**
 	 * @brief ランプ信号を生成
 	 * @param buffer 出力バッファ
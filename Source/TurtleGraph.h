@@ -0,0 +1,435 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Just enough of the Turtle grammar for LV2 manifests and plug-in data:
+// prefixes, relative IRIs, nested blank nodes, literals and collections
+// (which are read but not expanded). Triples from several files can be
+// added to one graph. Blank nodes and collections nest at most maxNesting
+// deep, so a hostile file cannot exhaust the stack.
+class TurtleGraph
+{
+public:
+    static constexpr const char* rdfType = "http://www.w3.org/1999/02/22-rdf-syntax-ns#type";
+    static constexpr int maxNesting = 64;
+
+    struct Term
+    {
+        std::string value;
+        bool isLiteral = false;
+    };
+
+    /**
+     * @brief Turtle文書を読み込み、トリプルを追加
+     * @param text 文書
+     * @param baseUri 相対IRIの基準となる文書のURI
+     * @return 文法どおりに読み込めた場合はtrue
+     */
+    bool parse(const std::string& text, const std::string& baseUri)
+    {
+        base = baseUri;
+        prefixes.clear();
+        tokens.clear();
+        position = 0;
+        nesting = 0;
+        ++documentCount;
+        if (!tokenise(text))
+            return false;
+
+        while (peek().type != TokenType::End)
+            if (!parseStatement())
+                return false;
+        return true;
+    }
+
+    std::vector<Term> getObjects(const std::string& subject, const std::string& predicate) const
+    {
+        std::vector<Term> objects;
+        for (const auto& triple : triples)
+            if (triple.subject == subject && triple.predicate == predicate)
+                objects.push_back(triple.object);
+        return objects;
+    }
+
+    std::string getLiteral(const std::string& subject, const std::string& predicate) const
+    {
+        for (const auto& object : getObjects(subject, predicate))
+            if (object.isLiteral)
+                return object.value;
+        return {};
+    }
+
+    bool hasType(const std::string& subject, const std::string& type) const
+    {
+        for (const auto& object : getObjects(subject, rdfType))
+            if (!object.isLiteral && object.value == type)
+                return true;
+        return false;
+    }
+
+    std::vector<std::string> getSubjectsOfType(const std::string& type) const
+    {
+        std::vector<std::string> subjects;
+        for (const auto& triple : triples)
+            if (triple.predicate == rdfType && !triple.object.isLiteral && triple.object.value == type)
+                subjects.push_back(triple.subject);
+        return subjects;
+    }
+
+private:
+    enum class TokenType
+    {
+        Iri,
+        PrefixedName,
+        BlankLabel,
+        Literal,
+        Punctuation,
+        Keyword,
+        End
+    };
+
+    struct Token
+    {
+        TokenType type = TokenType::End;
+        std::string text;
+    };
+
+    struct Triple
+    {
+        std::string subject;
+        std::string predicate;
+        Term object;
+    };
+
+    static bool isDelimiter(char c)
+    {
+        return std::isspace(static_cast<unsigned char>(c)) != 0
+            || std::string_view("<>\"'()[];,#").find(c) != std::string_view::npos;
+    }
+
+    /**
+     * @brief 文書を字句に分割
+     * @param text 文書
+     * @return 閉じていないIRIや文字列が無い場合はtrue
+     */
+    bool tokenise(const std::string& text)
+    {
+        size_t i = 0;
+        const auto size = text.size();
+        auto add = [this](TokenType type, std::string value)
+        {
+            tokens.push_back({ type, std::move(value) });
+        };
+
+        while (i < size)
+        {
+            const auto c = text[i];
+            if (std::isspace(static_cast<unsigned char>(c)))
+            {
+                ++i;
+            }
+            else if (c == '#')
+            {
+                while (i < size && text[i] != '\n')
+                    ++i;
+            }
+            else if (c == '<')
+            {
+                const auto end = text.find('>', i + 1);
+                if (end == std::string::npos)
+                    return false;
+                add(TokenType::Iri, text.substr(i + 1, end - i - 1));
+                i = end + 1;
+            }
+            else if (c == '"' || c == '\'')
+            {
+                std::string value;
+                const auto isLong = text.compare(i, 3, std::string(3, c)) == 0;
+                const auto quote = std::string(isLong ? 3 : 1, c);
+                i += quote.size();
+                for (;;)
+                {
+                    if (i >= size || (!isLong && text[i] == '\n'))
+                        return false;
+                    if (text.compare(i, quote.size(), quote) == 0)
+                        break;
+                    if (text[i] == '\\' && i + 1 < size)
+                    {
+                        const auto escaped = text[i + 1];
+                        value += escaped == 'n' ? '\n' : escaped == 't' ? '\t' : escaped == 'r' ? '\r' : escaped;
+                        i += 2;
+                        continue;
+                    }
+                    value += text[i++];
+                }
+                i += quote.size();
+                // Language tags and datatypes do not matter here.
+                if (i < size && text[i] == '@')
+                {
+                    ++i;
+                    while (i < size && (std::isalnum(static_cast<unsigned char>(text[i])) || text[i] == '-'))
+                        ++i;
+                }
+                else if (text.compare(i, 2, "^^") == 0)
+                {
+                    i += 2;
+                    if (i < size && text[i] == '<')
+                        i = text.find('>', i);
+                    else
+                        while (i < size && !isDelimiter(text[i]))
+                            ++i;
+                    if (i == std::string::npos)
+                        return false;
+                    if (i < size && text[i] == '>')
+                        ++i;
+                }
+                add(TokenType::Literal, std::move(value));
+            }
+            else if (std::string_view("()[];,").find(c) != std::string_view::npos)
+            {
+                add(TokenType::Punctuation, std::string(1, c));
+                ++i;
+            }
+            else if (c == '.' && (i + 1 >= size || !std::isdigit(static_cast<unsigned char>(text[i + 1]))))
+            {
+                add(TokenType::Punctuation, ".");
+                ++i;
+            }
+            else
+            {
+                auto end = i;
+                while (end < size && !isDelimiter(text[end]))
+                    ++end;
+                // A statement's final dot may follow a name without a space.
+                while (end > i + 1 && text[end - 1] == '.')
+                    --end;
+                const auto word = text.substr(i, end - i);
+                i = end;
+
+                auto lower = word;
+                std::transform(lower.begin(), lower.end(), lower.begin(),
+                               [](unsigned char letter) { return static_cast<char>(std::tolower(letter)); });
+                if (word == "a")
+                    add(TokenType::Keyword, "a");
+                else if (lower == "@prefix" || lower == "@base")
+                    add(TokenType::Keyword, lower);
+                else if (lower == "prefix" || lower == "base")
+                    add(TokenType::Keyword, lower);
+                else if (word.compare(0, 2, "_:") == 0)
+                    add(TokenType::BlankLabel, word.substr(2));
+                else if (word.find(':') != std::string::npos)
+                    add(TokenType::PrefixedName, word);
+                else if (word == "true" || word == "false"
+                         || std::isdigit(static_cast<unsigned char>(word[0])) || word[0] == '-'
+                         || word[0] == '+' || word[0] == '.')
+                    add(TokenType::Literal, word);
+                else
+                    return false;
+            }
+        }
+        add(TokenType::End, {});
+        return true;
+    }
+
+    const Token& peek() const { return tokens[position]; }
+
+    bool accept(const char* punctuation)
+    {
+        if (peek().type != TokenType::Punctuation || peek().text != punctuation)
+            return false;
+        ++position;
+        return true;
+    }
+
+    std::string createBlankNode()
+    {
+        return "_:" + std::to_string(documentCount) + ":b" + std::to_string(++blankNodeCount);
+    }
+
+    /**
+     * @brief IRI、接頭辞付きの名前、空白ノードのラベルを絶対的な名前へ変換
+     * @param token 変換する字句
+     * @param result 変換した名前
+     * @return 名前を表す字句で、接頭辞が定義済みの場合はtrue
+     */
+    bool resolve(const Token& token, std::string& result) const
+    {
+        switch (token.type)
+        {
+            case TokenType::Iri:
+            {
+                const auto& iri = token.text;
+                const auto colon = iri.find(':');
+                if (colon != std::string::npos && iri.find('/') > colon)
+                    result = iri;
+                else if (iri.empty() || iri[0] == '#')
+                    result = base.substr(0, base.find('#')) + iri;
+                else if (iri[0] == '/')
+                    result = base.substr(0, base.find('/', base.find("//") + 2)) + iri;
+                else
+                    result = base.substr(0, base.rfind('/') + 1) + iri;
+                return true;
+            }
+            case TokenType::PrefixedName:
+            {
+                const auto colon = token.text.find(':');
+                const auto prefix = prefixes.find(token.text.substr(0, colon));
+                if (prefix == prefixes.end())
+                    return false;
+                std::string local;
+                for (auto i = colon + 1; i < token.text.size(); ++i)
+                    if (token.text[i] != '\\')
+                        local += token.text[i];
+                result = prefix->second + local;
+                return true;
+            }
+            case TokenType::BlankLabel:
+                result = "_:" + std::to_string(documentCount) + ":" + token.text;
+                return true;
+            case TokenType::Literal:
+            case TokenType::Punctuation:
+            case TokenType::Keyword:
+            case TokenType::End:
+                break;
+        }
+        return false;
+    }
+
+    bool parseStatement()
+    {
+        const auto token = peek();
+        if (token.type == TokenType::Keyword && token.text != "a")
+        {
+            ++position;
+            const auto isPrefix = token.text == "@prefix" || token.text == "prefix";
+            std::string name;
+            if (isPrefix)
+            {
+                if (peek().type != TokenType::PrefixedName || peek().text.back() != ':')
+                    return false;
+                name = peek().text.substr(0, peek().text.size() - 1);
+                ++position;
+            }
+            if (peek().type != TokenType::Iri)
+                return false;
+            std::string iri;
+            resolve(peek(), iri);
+            ++position;
+            if (isPrefix)
+                prefixes[name] = iri;
+            else
+                base = iri;
+            // Only the '@' forms end with a dot.
+            return token.text[0] != '@' || accept(".");
+        }
+
+        std::string subject;
+        if (accept("["))
+        {
+            subject = createBlankNode();
+            if (!accept("]"))
+            {
+                if (!parsePredicateObjectList(subject) || !accept("]"))
+                    return false;
+            }
+            if (accept("."))
+                return true;
+        }
+        else if (peek().type == TokenType::Punctuation && peek().text == "(")
+        {
+            Term collection;
+            if (!parseObject(collection))
+                return false;
+            subject = collection.value;
+        }
+        else
+        {
+            if (!resolve(peek(), subject))
+                return false;
+            ++position;
+        }
+        return parsePredicateObjectList(subject) && accept(".");
+    }
+
+    bool parsePredicateObjectList(const std::string& subject)
+    {
+        for (;;)
+        {
+            std::string predicate;
+            if (peek().type == TokenType::Keyword && peek().text == "a")
+                predicate = rdfType;
+            else if (!resolve(peek(), predicate))
+                return false;
+            ++position;
+
+            do
+            {
+                Term object;
+                if (!parseObject(object))
+                    return false;
+                triples.push_back({ subject, predicate, std::move(object) });
+            }
+            while (accept(","));
+
+            if (!accept(";"))
+                return true;
+            while (accept(";"))
+            {
+            }
+            if (peek().type == TokenType::Punctuation && (peek().text == "." || peek().text == "]"))
+                return true;
+        }
+    }
+
+    bool parseObject(Term& result)
+    {
+        if (peek().type == TokenType::Literal)
+        {
+            result = { peek().text, true };
+            ++position;
+            return true;
+        }
+        if (accept("["))
+        {
+            if (++nesting > maxNesting)
+                return false;
+            result = { createBlankNode(), false };
+            const auto closed = accept("]") || (parsePredicateObjectList(result.value) && accept("]"));
+            --nesting;
+            return closed;
+        }
+        if (accept("("))
+        {
+            if (++nesting > maxNesting)
+                return false;
+            result = { createBlankNode(), false };
+            while (!accept(")"))
+            {
+                Term item;
+                if (peek().type == TokenType::End || !parseObject(item))
+                    return false;
+            }
+            --nesting;
+            return true;
+        }
+        result.isLiteral = false;
+        if (!resolve(peek(), result.value))
+            return false;
+        ++position;
+        return true;
+    }
+
+    std::vector<Token> tokens;
+    size_t position = 0;
+    int nesting = 0;
+    std::string base;
+    std::map<std::string, std::string> prefixes;
+    int documentCount = 0;
+    int blankNodeCount = 0;
+    std::vector<Triple> triples;
+};
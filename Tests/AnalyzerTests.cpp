@@ -1,11 +1,28 @@
 #include <JuceHeader.h>
 #include "../Source/AnalyzerEngine.h"
 #include "../Source/Application/AnalysisSession.h"
+#include "../Source/BatchAnalysis.h"
+#include "../Source/BlockTimer.h"
+#include "../Source/CurvePyramid.h"
+#include "../Source/Domain/ScopeCapture.h"
+#include "../Source/FFTBackend.h"
+#include "../Source/PluginMetadataReader.h"
+#include "../Source/PluginScanIndex.h"
+#include "../Source/PluginScanIPC.h"
+#include "../Source/PluginScanProtocol.h"
+#include "../Source/RecyclingPool.h"
+#include "../Source/SpectrumKernels.h"
 #include "../Source/TestSignalGenerator.h"
+#include "../Source/TurtleGraph.h"
+#include <algorithm>
 #include <atomic>
 #include <cmath>
+#include <complex>
 #include <iostream>
+#include <limits>
 #include <memory>
+#include <numeric>
+#include <set>
 #include <stdexcept>
 #include <thread>
 
@@ -51,7 +68,7 @@ struct ProcessorStats
 class FakeProcessor final : public juce::AudioProcessor
 {
 public:
-    enum class Kind { Gain, Delay, Clipper, Waveshaper, Compressor };
+    enum class Kind { Gain, Delay, Clipper, Waveshaper, Compressor, SoftClipper };
 
     FakeProcessor(Kind processorKind, float valueToUse,
                   std::shared_ptr<ProcessorStats> sharedStats = {})
@@ -67,7 +84,8 @@ public:
     const juce::String getName() const override
     {
         static const char* names[] = { "Fake Gain", "Fake Delay", "Fake Clipper",
-                                      "Fake Waveshaper", "Fake Compressor" };
+                                      "Fake Waveshaper", "Fake Compressor",
+                                      "Fake Soft Clipper" };
         return names[static_cast<size_t>(kind)];
     }
 
@@ -133,6 +151,9 @@ public:
                     case Kind::Waveshaper:
                         samples[i] = x + value * x * x;
                         break;
+                    case Kind::SoftClipper:
+                        samples[i] = x - value * x * x * x;
+                        break;
                     case Kind::Compressor:
                     {
                         const auto threshold = value;
@@ -221,6 +242,28 @@ void testSignalGeneration()
                 0.3, 0.002, "IMD low tone amplitude is incorrect");
     requireNear(toneAmplitude(signal.getReadPointer(0), signal.getNumSamples(), 6000.0),
                 0.3, 0.002, "IMD high tone amplitude is incorrect");
+
+    // The sine sweep and the synchronised sweep keep separate settings, so
+    // running one measurement does not change the other's stimulus.
+    TestSignalGenerator sweepOnly, synchronizedOnly, both;
+    juce::AudioBuffer<float> expected(1, 4096);
+    for (auto* sweeper : { &sweepOnly, &synchronizedOnly, &both })
+        sweeper->prepare(testSampleRate, 4096);
+    sweepOnly.setSweepParameters(200.0, 2000.0, 1.0);
+    synchronizedOnly.setSynchronizedSweepParameters(20.0, 20000.0, 5.0);
+    both.setSweepParameters(200.0, 2000.0, 1.0);
+    both.setSynchronizedSweepParameters(20.0, 20000.0, 5.0);
+    sweepOnly.fillBuffer(expected, TestSignalGenerator::SignalType::SineSweep, 0);
+    both.fillBuffer(signal, TestSignalGenerator::SignalType::SineSweep, 0);
+    for (int i = 0; i < signal.getNumSamples(); ++i)
+        require(signal.getSample(0, i) == expected.getSample(0, i),
+                "Synchronised sweep settings changed the sine sweep");
+    both.reset();
+    synchronizedOnly.fillBuffer(expected, TestSignalGenerator::SignalType::SynchronizedSweep, 0);
+    both.fillBuffer(signal, TestSignalGenerator::SignalType::SynchronizedSweep, 0);
+    for (int i = 0; i < signal.getNumSamples(); ++i)
+        require(signal.getSample(0, i) == expected.getSample(0, i),
+                "Sine sweep settings changed the synchronised sweep");
 }
 
 void testFakeProcessors()
@@ -267,6 +310,12 @@ void testLinearFFTAndLifecycle()
     requireNear(gainSnapshot->magnitudeSpectrumL[static_cast<size_t>(bin)],
                 juce::Decibels::gainToDecibels(2.0f), 0.15,
                 "Linear transfer magnitude is inaccurate");
+    engine.setDisplayResolution(300);
+    require(waitFor([&] { return engine.getAnalysisSnapshot()->display.magnitudeL.size() == 300; }),
+            "Display resolution change was not republished");
+    const auto& display = engine.getAnalysisSnapshot()->display;
+    requireNear(display.magnitudeL[150], juce::Decibels::gainToDecibels(2.0f), 0.15,
+                "Display transfer magnitude is inaccurate");
 
     engine.prepare(44100.0, 128);
     processBlocks(engine, 24, 128);
@@ -305,6 +354,19 @@ void testDistortionMeasurements()
     engine.setAnalysisMode(AnalyzerEngine::AnalysisMode::Harmonic);
     engine.setTestFrequency(1500.0);
     engine.setInputAmplitude(0.5f);
+    // Band powers come from linear power, so the harmonics of a clean path
+    // read their true level far below -100 dB instead of exactly zero.
+    require(engine.loadProcessor(std::make_unique<FakeProcessor>(
+                FakeProcessor::Kind::Gain, 1.0f)),
+            "Fake gain could not be loaded");
+    processBlocks(engine, 48);
+    require(waitFor([&] { return engine.getAnalysisSnapshot()->frameCount > 4; }),
+            "Clean THD measurement did not complete");
+    const auto clean = engine.getAnalysisSnapshot();
+    require(clean->thd > 0.0f && clean->thd < 0.001f,
+            "Clean THD was clamped or is above the float noise floor");
+    engine.unloadPlugin();
+
     require(engine.loadProcessor(std::make_unique<FakeProcessor>(
                 FakeProcessor::Kind::Waveshaper, 0.5f)),
             "Fake waveshaper could not be loaded");
@@ -334,19 +396,1194 @@ void testDistortionMeasurements()
             "IMD measurement did not detect intermodulation products");
 }
 
+void testOfflineRendering()
+{
+    AnalyzerEngine engine;
+    engine.prepare(testSampleRate, testBlockSize);
+    engine.setFFTOrder(11);
+    engine.setNonRealtime(true);
+    engine.setAnalysisMode(AnalyzerEngine::AnalysisMode::Harmonic);
+    engine.setTestFrequency(1500.0);
+    engine.setInputAmplitude(0.5f);
+    auto stats = std::make_shared<ProcessorStats>();
+    require(engine.loadProcessor(std::make_unique<FakeProcessor>(
+                FakeProcessor::Kind::Waveshaper, 0.5f, stats)),
+            "Offline waveshaper could not be loaded");
+
+    // Twice the analysis FIFO capacity, rendered without pacing or sleeps.
+    const auto samples = 1 << 18;
+    require(engine.renderOffline(samples) == samples, "Offline render was truncated");
+    require(stats->processCalls == samples / testBlockSize,
+            "Offline render skipped processor blocks");
+    const auto snapshot = engine.getAnalysisSnapshot();
+    require(snapshot->performance.droppedAnalysisSamples == 0,
+            "Offline render dropped analysis samples");
+    requireNear(snapshot->thd, 12.5, 1.0, "Offline THD is outside tolerance");
+
+    // A suspended worker frees no FIFO space; offline rendering must fail
+    // instead of waiting for it.
+    engine.suspendAnalysis();
+    processBlocks(engine, samples / testBlockSize);
+    require(engine.renderOffline(samples) == 0, "Render without a worker reported success");
+    require(!engine.waitForAnalysisIdle(), "Idle wait without a worker reported success");
+    engine.resumeAnalysis();
+    require(engine.renderOffline(testBlockSize) == testBlockSize,
+            "Offline render did not recover after the worker resumed");
+    require(engine.getAnalysisSnapshot()->performance.droppedAnalysisSamples > 0,
+            "Blocks queued without a worker were not counted as dropped");
+}
+
+void testLowFrequencyTHD()
+{
+    // At 2^11 points a 25 Hz tone lands in bin 1, where the fundamental and
+    // H2 share FFT bins; the zoomed bands still separate them.
+    AnalyzerEngine engine;
+    engine.prepare(testSampleRate, testBlockSize);
+    engine.setFFTOrder(11);
+    engine.setNonRealtime(true);
+    engine.setAnalysisMode(AnalyzerEngine::AnalysisMode::Harmonic);
+    engine.setTestFrequency(25.0);
+    engine.setInputAmplitude(0.5f);
+    require(engine.loadProcessor(std::make_unique<FakeProcessor>(
+                FakeProcessor::Kind::Waveshaper, 0.5f)),
+            "Low-frequency waveshaper could not be loaded");
+
+    const auto samples = 1 << 18;
+    require(engine.renderOffline(samples) == samples, "Low-frequency render was truncated");
+    const auto snapshot = engine.getAnalysisSnapshot();
+    requireNear(snapshot->thd, 12.5, 0.5, "Low-frequency THD is outside tolerance");
+    requireNear(snapshot->harmonicLevels[0], -18.06, 0.5,
+                "Low-frequency second harmonic level is outside tolerance");
+    require(snapshot->harmonicLevels[1] < -80.0f,
+            "Low-frequency third harmonic picked up the neighbouring harmonics");
+}
+
+void testHarmonicTracking()
+{
+    AnalyzerEngine engine;
+    engine.prepare(testSampleRate, testBlockSize);
+    engine.setFFTOrder(13);
+    engine.setNonRealtime(true);
+    engine.setHarmonicTrackingInterval(10.0);
+    engine.setAnalysisMode(AnalyzerEngine::AnalysisMode::Harmonic);
+    engine.setTestFrequency(1500.0);
+    engine.setInputAmplitude(0.5f);
+    require(engine.loadProcessor(std::make_unique<FakeProcessor>(
+                FakeProcessor::Kind::Waveshaper, 0.5f)),
+            "Tracked waveshaper could not be loaded");
+
+    // One FFT frame fills the sliding window; the next 10 ms publish again.
+    const auto frame = 1 << 13;
+    require(engine.renderOffline(frame + 512) == frame + 512, "Tracked render was truncated");
+    const auto first = engine.getAnalysisSnapshot();
+    require(engine.renderOffline(512) == 512, "Tracked render was truncated");
+    const auto second = engine.getAnalysisSnapshot();
+    require(second->frameCount == 1 && second != first,
+            "Harmonic tracking did not publish between FFT frames");
+    requireNear(second->thd, 12.5, 0.2, "Tracked THD is outside tolerance");
+    requireNear(second->thdPlusN, 12.5, 0.2, "Tracked THD+N is outside tolerance");
+    requireNear(second->harmonicLevels[0], -18.06, 0.2,
+                "Tracked second harmonic level is outside tolerance");
+}
+
+void testHighResolutionFFT()
+{
+    AnalyzerEngine engine;
+    engine.prepare(testSampleRate, testBlockSize);
+    engine.setFFTOrder(17);
+    engine.setNonRealtime(true);
+    require(engine.loadProcessor(std::make_unique<FakeProcessor>(
+                FakeProcessor::Kind::Delay, 37.0f)),
+            "High-resolution delay could not be loaded");
+
+    const auto samples = 1 << 19;
+    require(engine.renderOffline(samples) == samples, "High-resolution render was truncated");
+    const auto snapshot = engine.getAnalysisSnapshot();
+    require(snapshot->frameCount > 0, "Order 17 FFT did not complete a frame");
+    require(snapshot->spectrumDecimation == 4
+                && snapshot->magnitudeSpectrumL.size() == static_cast<size_t>(AnalyzerEngine::maxPublishedBins),
+            "Order 17 spectrum was not decimated to the published size");
+    require(snapshot->latencySamples == 37, "Order 17 frame did not measure latency");
+    const auto point = static_cast<size_t>(juce::roundToInt(1000.0 * (1 << 17) / testSampleRate) / 4);
+    requireNear(snapshot->magnitudeSpectrumL[point], 0.0, 0.15,
+                "Decimated transfer magnitude is inaccurate");
+}
+
+void testSpectrumKernels()
+{
+    // 37 bins exercise both the vector body and the scalar tail.
+    constexpr int bins = 37;
+    std::vector<float> output(bins * 2), input(bins * 2), rotation(bins * 2), result(bins * 2);
+    juce::Random random(7);
+    for (int bin = 0; bin < bins; ++bin)
+    {
+        output[2 * bin] = (random.nextFloat() - 0.5f) * std::pow(10.0f, static_cast<float>(bin % 9 - 4));
+        output[2 * bin + 1] = random.nextFloat() - 0.5f;
+        input[2 * bin] = random.nextFloat() - 0.5f;
+        input[2 * bin + 1] = random.nextFloat() - 0.5f;
+    }
+    input[10] = input[11] = 0.0f;
+    output[4] = output[5] = 0.0f;
+    output[6] = std::numeric_limits<float>::infinity();
+
+    SpectrumKernels::createRotation(rotation.data(), bins, 37, 1024);
+    require(SpectrumKernels::isAvailable(SpectrumKernels::InstructionSet::Scalar)
+                && SpectrumKernels::isAvailable(SpectrumKernels::getInstructionSet()),
+            "Selected spectrum kernels are not available");
+
+    // Every path this CPU can run is checked on its own, not just the one
+    // selected at run time.
+    for (const auto instructionSet : { SpectrumKernels::InstructionSet::Scalar,
+                                       SpectrumKernels::InstructionSet::SSE2,
+                                       SpectrumKernels::InstructionSet::AVX2 })
+    {
+        if (!SpectrumKernels::isAvailable(instructionSet))
+            continue;
+        const std::string name = SpectrumKernels::getInstructionSetName(instructionSet);
+
+        SpectrumKernels::divide(instructionSet, output.data(), input.data(), rotation.data(), result.data(),
+                                bins, 1.0e-20f, 0.25f);
+        for (int bin = 0; bin < bins; ++bin)
+        {
+            const std::complex<double> numerator(output[2 * bin], output[2 * bin + 1]);
+            const std::complex<double> denominator(input[2 * bin], input[2 * bin + 1]);
+            const auto expected = std::norm(denominator) > 1.0e-20
+                ? numerator / denominator * std::polar(1.0, juce::MathConstants<double>::twoPi * bin * 37 / 1024.0)
+                : numerator * 0.25;
+            if (!std::isfinite(std::abs(expected)))
+                continue;
+            requireNear(result[2 * bin], expected.real(), 1.0e-5 * (1.0 + std::abs(expected)),
+                        (name + " spectrum kernel transfer division is wrong").c_str());
+            requireNear(result[2 * bin + 1], expected.imag(), 1.0e-5 * (1.0 + std::abs(expected)),
+                        (name + " spectrum kernel transfer division is wrong").c_str());
+        }
+
+        std::vector<float> magnitudes(bins), phases(bins);
+        SpectrumKernels::toDecibelsAndPhase(instructionSet, output.data(), magnitudes.data(), phases.data(),
+                                            bins, -160.0f);
+        for (int bin = 0; bin < bins; ++bin)
+        {
+            const std::complex<double> value(output[2 * bin], output[2 * bin + 1]);
+            const auto gain = std::isfinite(std::abs(value)) ? std::abs(value) : 0.0;
+            requireNear(magnitudes[static_cast<size_t>(bin)],
+                        juce::Decibels::gainToDecibels(static_cast<float>(gain), -160.0f), 5.0e-5,
+                        (name + " spectrum kernel magnitude is wrong").c_str());
+            if (std::isfinite(std::abs(value)))
+                requireNear(phases[static_cast<size_t>(bin)], std::arg(value), 3.0e-6,
+                            (name + " spectrum kernel phase is wrong").c_str());
+        }
+    }
+
+    // The dispatching entry points use the selected path.
+    std::vector<float> selected(bins * 2), explicitResult(bins * 2);
+    SpectrumKernels::divide(output.data(), input.data(), rotation.data(), selected.data(), bins, 1.0e-20f, 0.25f);
+    SpectrumKernels::divide(SpectrumKernels::getInstructionSet(), output.data(), input.data(), rotation.data(),
+                            explicitResult.data(), bins, 1.0e-20f, 0.25f);
+    require(std::equal(selected.begin(), selected.end(), explicitResult.begin(),
+                       [](float a, float b) { return a == b || (std::isnan(a) && std::isnan(b)); }),
+            "Spectrum kernel dispatch differs from the selected instruction set");
+}
+
+void testFFTBackends()
+{
+    juce::Random random(7);
+    for (const auto kind : { FFTBackend::Kind::Juce, FFTBackend::Kind::Stockham,
+                             FFTBackend::Kind::FFTW })
+    {
+        if (!FFTBackend::isAvailable(kind))
+            continue;
+        // Odd and even orders exercise the trailing radix-2 stage.
+        for (const auto order : { 1, 2, 3, 8, 9 })
+        {
+            const auto size = 1 << order;
+            std::vector<float> input(static_cast<size_t>(size));
+            for (auto& sample : input)
+                sample = random.nextFloat() * 2.0f - 1.0f;
+            std::vector<float> data(static_cast<size_t>(size * 2), 0.0f);
+            std::copy(input.begin(), input.end(), data.begin());
+            FFTBackend::create(kind, order)->performRealForward(data.data());
+
+            double error = 0.0;
+            for (int bin = 0; bin < size; ++bin)
+            {
+                std::complex<double> expected;
+                for (int n = 0; n < size; ++n)
+                    expected += static_cast<double>(input[static_cast<size_t>(n)])
+                              * std::polar(1.0, -2.0 * juce::MathConstants<double>::pi * bin * n / size);
+                const std::complex<double> actual(data[static_cast<size_t>(2 * bin)],
+                                                  data[static_cast<size_t>(2 * bin + 1)]);
+                error = std::max(error, std::abs(actual - expected));
+            }
+            require(error < 1.0e-5 * size, "FFT backend does not match the reference DFT");
+        }
+    }
+
+    FFTPlanCache cache(FFTBackend::Kind::Stockham);
+    const auto* plan = cache.get(10).fft.get();
+    require(cache.get(10).fft.get() == plan && plan->getSize() == 1024
+                && cache.get(10).window.size() == 1024,
+            "FFT plan cache rebuilt a cached order");
+}
+
+void testHammersteinSweep()
+{
+    auto measure = [](FakeProcessor::Kind kind, float value)
+    {
+        auto engine = std::make_unique<AnalyzerEngine>();
+        engine->prepare(testSampleRate, testBlockSize);
+        engine->setFFTOrder(12);
+        engine->setNonRealtime(true);
+        engine->setTestFrequency(1000.0);
+        engine->setInputAmplitude(0.5f);
+        require(engine->loadProcessor(std::make_unique<FakeProcessor>(kind, value)),
+                "Hammerstein processor could not be loaded");
+        engine->setAnalysisMode(AnalyzerEngine::AnalysisMode::Hammerstein);
+        // One synchronised sweep plus its tail fits in 2^18 samples at 48 kHz.
+        for (int block = 0; block < 80 && !engine->getAnalysisSnapshot()->measurementComplete; ++block)
+            engine->renderOffline(engine->getFFTSize());
+        return engine;
+    };
+
+    const auto waveshaper = measure(FakeProcessor::Kind::Waveshaper, 0.5f);
+    const auto snapshot = waveshaper->getAnalysisSnapshot();
+    require(snapshot->measurementComplete && snapshot->harmonicResponses.size() == 10,
+            "Hammerstein sweep did not complete");
+    // x + 0.5x^2 at 0.5 amplitude: H2 is 0.125 of the fundamental, H3 is absent.
+    requireNear(snapshot->thd, 12.5, 1.0, "Hammerstein THD is outside tolerance");
+    requireNear(snapshot->harmonicLevels[0], -18.06, 1.0, "Hammerstein H2 level is wrong");
+    require(snapshot->harmonicLevels[1] < -50.0f, "Hammerstein reported a spurious H3");
+    const auto bin100Hz = static_cast<size_t>(std::lround(100.0 * waveshaper->getFFTSize() / testSampleRate));
+    const auto bin5kHz = static_cast<size_t>(std::lround(5000.0 * waveshaper->getFFTSize() / testSampleRate));
+    requireNear(snapshot->harmonicResponses[1][bin100Hz] - snapshot->harmonicResponses[0][bin100Hz],
+                -18.06, 1.0, "Hammerstein H2 is not flat at 100 Hz");
+    requireNear(snapshot->harmonicResponses[1][bin5kHz] - snapshot->harmonicResponses[0][bin5kHz],
+                -18.06, 1.0, "Hammerstein H2 is not flat at 5 kHz");
+
+    const auto delay = measure(FakeProcessor::Kind::Delay, 64.0f);
+    const auto delayed = delay->getAnalysisSnapshot();
+    require(delayed->measurementComplete && delayed->latencySamples == 64,
+            "Hammerstein sweep did not detect the processor latency");
+    requireNear(delayed->magnitudeSpectrumL[bin5kHz], 0.0, 0.5,
+                "Hammerstein linear response of a delay is not flat");
+}
+
+void testMultitoneDistortion()
+{
+    using plugin_analyzer::domain::MultitonePlanner;
+    constexpr int order = 12;
+    const auto& plan = MultitonePlanner::forOrder(order);
+    require(plan.sets.size() == MultitonePlanner::setCount, "Multitone plan has no tone sets");
+    for (const auto& set : plan.sets)
+    {
+        const auto peak = std::abs(*std::max_element(set.waveform.begin(), set.waveform.end(),
+            [](float a, float b) { return std::abs(a) < std::abs(b); }));
+        requireNear(peak, 1.0, 1.0e-4, "Multitone waveform is not peak-normalised");
+        for (const auto tone : set.toneBins)
+            for (int harmonic = 2; harmonic <= MultitonePlanner::maxHarmonic; ++harmonic)
+                for (const auto other : set.toneBins)
+                    require(std::abs(MultitonePlanner::harmonicBin(tone, harmonic, plan.fftSize) - other) >= 2,
+                            "Multitone harmonic overlaps another tone");
+    }
+
+    // Third-order products of every tone triple stay off the measured bins
+    // too, so odd-order nonlinearities are not read as harmonics.
+    for (const auto& set : plan.sets)
+    {
+        std::vector<int> measured;
+        for (const auto tone : set.toneBins)
+            for (int harmonic = 1; harmonic <= MultitonePlanner::maxHarmonic; ++harmonic)
+                measured.push_back(MultitonePlanner::harmonicBin(tone, harmonic, plan.fftSize));
+        const auto clear = [&](int frequency)
+        {
+            const auto product = MultitonePlanner::harmonicBin(std::abs(frequency), 1, plan.fftSize);
+            return std::none_of(measured.begin(), measured.end(),
+                                [product](int bin) { return std::abs(bin - product) < 2; });
+        };
+        const auto& tones = set.toneBins;
+        for (size_t a = 0; a < tones.size(); ++a)
+            for (size_t b = a + 1; b < tones.size(); ++b)
+            {
+                for (const auto product : { tones[a] + tones[b], tones[a] - tones[b],
+                                            2 * tones[a] + tones[b], 2 * tones[a] - tones[b],
+                                            tones[a] + 2 * tones[b], tones[a] - 2 * tones[b] })
+                    require(clear(product), "Multitone intermodulation lands on a measured bin");
+                for (size_t c = b + 1; c < tones.size(); ++c)
+                    for (const auto product : { tones[a] + tones[b] + tones[c], tones[a] + tones[b] - tones[c],
+                                                tones[a] - tones[b] + tones[c], tones[a] - tones[b] - tones[c] })
+                        require(clear(product), "Multitone intermodulation lands on a measured bin");
+            }
+    }
+
+    size_t toneCount = 0;
+    for (const auto& set : plan.sets)
+        toneCount += set.toneBins.size();
+
+    const auto measure = [&](FakeProcessor::Kind kind, float value)
+    {
+        AnalyzerEngine engine;
+        engine.prepare(testSampleRate, testBlockSize);
+        engine.setFFTOrder(order);
+        engine.setNonRealtime(true);
+        engine.setInputAmplitude(0.5f);
+        require(engine.loadProcessor(std::make_unique<FakeProcessor>(kind, value)),
+                "Multitone processor could not be loaded");
+        engine.setAnalysisMode(AnalyzerEngine::AnalysisMode::THDSweep);
+        const auto frames = MultitonePlanner::setCount * MultitonePlanner::framesPerSet;
+        engine.renderOffline(frames * engine.getFFTSize());
+        require(engine.waitForAnalysisIdle(5000), "Multitone analysis did not drain");
+
+        const auto snapshot = engine.getAnalysisSnapshot();
+        require(snapshot->measurementComplete, "Multitone measurement did not complete in its frame budget");
+        require(snapshot->thdSweepFrequencies.size() == toneCount
+                    && std::is_sorted(snapshot->thdSweepFrequencies.begin(), snapshot->thdSweepFrequencies.end()),
+                "Multitone THD curve is incomplete");
+
+        // The finished measurement stops the stimulus.
+        const auto completedFrames = snapshot->frameCount;
+        engine.renderOffline(engine.getFFTSize() * 2);
+        engine.waitForAnalysisIdle(5000);
+        require(engine.getAnalysisSnapshot()->frameCount == completedFrames,
+                "Multitone measurement kept running after completion");
+        return snapshot;
+    };
+    const auto thdAt = [&plan](const auto& snapshot, int tone)
+    {
+        const auto frequency = static_cast<float>(tone * testSampleRate / plan.fftSize);
+        const auto position = std::find(snapshot->thdSweepFrequencies.begin(),
+                                        snapshot->thdSweepFrequencies.end(), frequency);
+        require(position != snapshot->thdSweepFrequencies.end(), "Multitone tone is missing");
+        return static_cast<double>(snapshot->thdSweepValues[static_cast<size_t>(
+            std::distance(snapshot->thdSweepFrequencies.begin(), position))]);
+    };
+
+    // x + 0.5x^2 gives each tone of amplitude a an H2 of 0.25a relative to it;
+    // any intermodulation product landing on a harmonic bin would show here.
+    const auto waveshaper = measure(FakeProcessor::Kind::Waveshaper, 0.5f);
+    for (const auto& set : plan.sets)
+    {
+        const auto expected = 25.0 * 0.5 * set.toneAmplitude;
+        for (const auto tone : set.toneBins)
+            requireNear(thdAt(waveshaper, tone), expected, expected * 0.02,
+                        "Multitone THD is outside tolerance");
+    }
+
+    // x - 4x^3 gives each tone an H3 of a^3 and compresses its fundamental
+    // by 3a^3 (1 + 2(n - 1)) through itself and the other n - 1 tones.
+    constexpr auto cubic = 4.0;
+    const auto clipped = measure(FakeProcessor::Kind::SoftClipper, static_cast<float>(cubic));
+    for (const auto& set : plan.sets)
+    {
+        const auto amplitude = 0.5 * set.toneAmplitude;
+        const auto others = static_cast<double>(set.toneBins.size() - 1);
+        const auto fundamental = amplitude - cubic * amplitude * amplitude * amplitude
+                                                 * (0.75 + 1.5 * others);
+        for (const auto tone : set.toneBins)
+        {
+            const auto expected = 3 * tone < plan.fftSize / 2
+                ? 100.0 * cubic * amplitude * amplitude * amplitude / 4.0 / std::abs(fundamental)
+                : 0.0;
+            requireNear(thdAt(clipped, tone), expected, expected * 0.02 + 1.0e-3,
+                        "Multitone soft-clipper THD is outside tolerance");
+        }
+    }
+}
+
+void testBatchAnalysis()
+{
+    BatchAnalysisOptions options;
+    juce::String error;
+    require(BatchAnalyzer::isBatchCommandLine("--analyze \"My Plugin.vst3\" --modes linear,harmonic"),
+            "Batch command line was not detected");
+    require(BatchAnalyzer::parseArguments(
+                "--analyze \"My Plugin.vst3\" --modes linear,harmonic --fft-order 11 --frequency 1500",
+                options, error),
+            "Batch arguments were rejected");
+    require(options.pluginPath == "My Plugin.vst3" && options.modes.size() == 2
+                && options.fftOrder == 11 && options.frequency == 1500.0,
+            "Batch arguments were parsed incorrectly");
+    BatchAnalysisOptions invalid;
+    require(!BatchAnalyzer::parseArguments("--analyze a.vst3 --modes bogus", invalid, error),
+            "Unknown batch mode was accepted");
+
+    BatchAnalysisOptions library;
+    require(BatchAnalyzer::parseArguments("--analyze-all --jobs 4 --timeout 90 --modes imd", library, error)
+                && library.analyseKnownPlugins && library.jobs == 4 && library.timeout == 90.0,
+            "Parallel batch arguments were rejected");
+    BatchAnalysisOptions noTimeout;
+    require(!BatchAnalyzer::parseArguments("--analyze-all --timeout 0", noTimeout, error),
+            "A zero batch timeout was accepted");
+    require(ParallelBatchRunner::getJobCount(library) == 4,
+            "Parallel batch job count was not honoured");
+    juce::PluginDescription description;
+    description.fileOrIdentifier = "/plugins/Shell.vst3";
+    auto childArguments = ParallelBatchRunner::createChildArguments(
+        library, description, juce::File("/tmp/0.xml"), juce::File("/tmp/0.json"));
+    childArguments.remove(0);
+    BatchAnalysisOptions child;
+    require(BatchAnalyzer::parseArguments(childArguments.joinIntoString(" "), child, error)
+                && !child.analyseKnownPlugins && child.modes.size() == 1
+                && child.pluginDescriptionFile.getFullPathName() == "/tmp/0.xml",
+            "Parallel batch child arguments do not round-trip");
+
+    AnalyzerEngine engine;
+    engine.prepare(testSampleRate, testBlockSize);
+    engine.setNonRealtime(true);
+    require(engine.loadProcessor(std::make_unique<FakeProcessor>(
+                FakeProcessor::Kind::Waveshaper, 0.5f, std::make_shared<ProcessorStats>())),
+            "Batch waveshaper could not be loaded");
+    const auto results = BatchAnalyzer::analyse(engine, options);
+    const auto linear = results["linear"];
+    const auto harmonic = results["harmonic"];
+    require(static_cast<bool>(linear["complete"]) && static_cast<bool>(harmonic["complete"]),
+            "Batch analysis did not complete every mode");
+    require(linear["magnitudeL"].size() == engine.getFFTSize() / 2,
+            "Batch linear result has the wrong spectrum size");
+    requireNear(static_cast<double>(harmonic["thd"]), 12.5, 1.0,
+                "Batch THD is outside tolerance");
+}
+
+void testPluginScanIndex()
+{
+    const auto root = juce::File::getSpecialLocation(juce::File::tempDirectory)
+                          .getNonexistentChildFile("PluginScanIndexTest", {}, false);
+    const auto bundle = root.getChildFile("Test.vst3");
+    const auto binary = bundle.getChildFile("Contents/x86_64-linux/Test.so");
+    const auto resource = bundle.getChildFile("Contents/Resources/moduleinfo.json");
+    require(binary.getParentDirectory().createDirectory() && resource.getParentDirectory().createDirectory()
+                && binary.replaceWithText("AAAA1111") && resource.replaceWithText("{}"),
+            "Scan index fixture could not be written");
+
+    // Rewriting a file in place with the same size and timestamp is only
+    // visible to the content hash.
+    const juce::Time modified(1700000000000);
+    const auto touchBundle = [&]
+    {
+        for (const auto& file : { binary, resource })
+            file.setLastModificationTime(modified);
+    };
+    touchBundle();
+    PluginScanIndex::Fingerprint plain, hashed, rewrittenPlain, rewrittenHashed;
+    require(PluginScanIndex::computeFingerprint(bundle.getFullPathName(), false, plain)
+                && PluginScanIndex::computeFingerprint(bundle.getFullPathName(), true, hashed),
+            "Bundle fingerprint could not be computed");
+    require(plain.size == 10 && plain.modificationTime >= modified.toMilliseconds()
+                && !plain.hasContentHash && hashed.hasContentHash,
+            "Bundle fingerprint does not cover every file");
+    require(binary.replaceWithText("BBBB2222"), "Scan index fixture could not be rewritten");
+    touchBundle();
+    require(PluginScanIndex::computeFingerprint(bundle.getFullPathName(), false, rewrittenPlain)
+                && PluginScanIndex::computeFingerprint(bundle.getFullPathName(), true, rewrittenHashed),
+            "Rewritten bundle fingerprint could not be computed");
+    require(plain.matches(rewrittenPlain), "Size and time fingerprints saw an identical-looking rewrite");
+    require(hashed.contentHash != rewrittenHashed.contentHash && !hashed.matches(rewrittenHashed),
+            "Content hash missed a rewritten inner file");
+    require(hashed.matches(rewrittenPlain) && rewrittenPlain.matches(hashed),
+            "Hashes were compared against a fingerprint without one");
+    auto resized = plain;
+    ++resized.size;
+    require(!plain.matches(resized) && !hashed.matches(resized), "A size change was not detected");
+    PluginScanIndex::Fingerprint unused;
+    require(!PluginScanIndex::computeFingerprint("Test.vst3", true, unused)
+                && !PluginScanIndex::computeFingerprint(root.getChildFile("Missing.vst3").getFullPathName(),
+                                                        false, unused),
+            "Relative or missing modules produced a fingerprint");
+
+    PluginScanIndex index;
+    const auto bundlePath = bundle.getFullPathName();
+    PluginScanIndex::Fingerprint highBits = plain;
+    highBits.contentHash = 0xfedcba9876543210ull;
+    highBits.hasContentHash = true;
+    index.update(bundlePath, hashed);
+    index.update("/plugins/Plain.vst3", plain);
+    index.update("/plugins/HighBits.vst3", highBits);
+    require(index.contains(bundlePath) && !index.contains("/plugins/Other.vst3"),
+            "Scan index membership is wrong");
+    require(index.isUnchanged(bundlePath, hashed) && !index.isUnchanged(bundlePath, rewrittenHashed),
+            "Scan index did not compare fingerprints");
+
+    // An entry recorded without a hash takes one from the first hashed scan
+    // that finds it unchanged, so a later in-place rewrite is noticed.
+    PluginScanIndex upgraded;
+    upgraded.update(bundlePath, plain);
+    require(upgraded.confirmUnchanged(bundlePath, hashed) && !upgraded.isUnchanged(bundlePath, rewrittenHashed)
+                && !upgraded.confirmUnchanged(bundlePath, rewrittenHashed)
+                && !upgraded.confirmUnchanged("/plugins/Other.vst3", hashed),
+            "Scan index did not adopt the content hash of an unchanged module");
+
+    PluginScanIndex restored;
+    restored.loadFromXml(*index.createXml());
+    require(restored.size() == 3 && restored.isUnchanged(bundlePath, hashed)
+                && !restored.isUnchanged(bundlePath, rewrittenHashed)
+                && restored.isUnchanged("/plugins/HighBits.vst3", highBits),
+            "Scan index did not survive an XML round trip");
+    auto otherHash = highBits;
+    otherHash.contentHash = 1;
+    require(restored.isUnchanged("/plugins/Plain.vst3", otherHash)
+                && !restored.isUnchanged("/plugins/HighBits.vst3", otherHash),
+            "Scan index XML did not preserve which entries carry a hash");
+    restored.remove(bundlePath);
+    require(!restored.contains(bundlePath) && restored.size() == 2, "Scan index entry was not removed");
+    restored.loadFromXml(juce::XmlElement("SOMETHING_ELSE"));
+    require(restored.size() == 0, "Scan index accepted a foreign XML element");
+
+    root.deleteRecursively();
+}
+
+void testPluginScanProtocol()
+{
+    const std::vector<PluginScanProtocol::ScanRequest> requests {
+        { 0, "VST3", "/plugins/Fixture.vst3" },
+        { 300, "LV2", juce::String::fromUTF8("urn:fixture:d\xc3\xa9lai") },
+        { 7, "AudioUnit", {} }
+    };
+    const auto batch = PluginScanProtocol::createScanBatch(45000, requests);
+    int deadlineMs = 0;
+    std::vector<PluginScanProtocol::ScanRequest> decodedRequests;
+    require(PluginScanProtocol::readScanBatch(batch, deadlineMs, decodedRequests) && deadlineMs == 45000
+                && decodedRequests.size() == requests.size(),
+            "Scan batch did not round-trip");
+    for (size_t i = 0; i < requests.size(); ++i)
+        require(decodedRequests[i].job == requests[i].job && decodedRequests[i].formatName == requests[i].formatName
+                    && decodedRequests[i].identifier == requests[i].identifier,
+                "Scan batch entry did not round-trip");
+
+    juce::OwnedArray<juce::PluginDescription> descriptions;
+    auto* synth = new juce::PluginDescription();
+    synth->name = "Fixture Synth";
+    synth->descriptiveName = "Fixture Synth (Stereo)";
+    synth->pluginFormatName = "VST3";
+    synth->category = "Instrument|Synth";
+    synth->manufacturerName = "Fixture Audio";
+    synth->version = "1.2.3";
+    synth->fileOrIdentifier = "/plugins/Fixture.vst3";
+    synth->lastFileModTime = juce::Time(1700000000123);
+    synth->lastInfoUpdateTime = juce::Time(1700000456789);
+    synth->deprecatedUid = -762640467;
+    synth->uniqueId = 641455008;
+    synth->numInputChannels = 0;
+    synth->numOutputChannels = 2;
+    synth->isInstrument = true;
+    synth->hasSharedContainer = true;
+    descriptions.add(synth);
+    auto* effect = new juce::PluginDescription();
+    effect->name = "Fixture Delay";
+    effect->hasARAExtension = true;
+    descriptions.add(effect);
+
+    const auto result = PluginScanProtocol::createJobResult(300, descriptions);
+    int job = -1;
+    juce::OwnedArray<juce::PluginDescription> decoded;
+    require(PluginScanProtocol::readJobResult(result, job, decoded) && job == 300 && decoded.size() == 2,
+            "Job result did not round-trip");
+    const auto& decodedSynth = *decoded[0];
+    require(decodedSynth.name == synth->name && decodedSynth.descriptiveName == synth->descriptiveName
+                && decodedSynth.pluginFormatName == synth->pluginFormatName
+                && decodedSynth.category == synth->category
+                && decodedSynth.manufacturerName == synth->manufacturerName
+                && decodedSynth.version == synth->version
+                && decodedSynth.fileOrIdentifier == synth->fileOrIdentifier
+                && decodedSynth.lastFileModTime == synth->lastFileModTime
+                && decodedSynth.lastInfoUpdateTime == synth->lastInfoUpdateTime
+                && decodedSynth.deprecatedUid == synth->deprecatedUid && decodedSynth.uniqueId == synth->uniqueId
+                && decodedSynth.numInputChannels == 0 && decodedSynth.numOutputChannels == 2
+                && decodedSynth.isInstrument && decodedSynth.hasSharedContainer && !decodedSynth.hasARAExtension,
+            "Plug-in description did not round-trip");
+    require(decoded[1]->name == "Fixture Delay" && decoded[1]->hasARAExtension && !decoded[1]->isInstrument,
+            "Plug-in description flags did not round-trip");
+
+    // Every strict prefix of a message is truncated and must be rejected.
+    for (size_t size = 0; size < batch.getSize(); ++size)
+    {
+        std::vector<PluginScanProtocol::ScanRequest> partial;
+        require(!PluginScanProtocol::readScanBatch(juce::MemoryBlock(batch.getData(), size), deadlineMs, partial),
+                "Truncated scan batch was accepted");
+    }
+    for (size_t size = 0; size < result.getSize(); ++size)
+    {
+        juce::OwnedArray<juce::PluginDescription> partial;
+        require(!PluginScanProtocol::readJobResult(juce::MemoryBlock(result.getData(), size), job, partial),
+                "Truncated job result was accepted");
+    }
+
+    auto trailing = batch;
+    trailing.append("x", 1);
+    require(!PluginScanProtocol::readScanBatch(trailing, deadlineMs, decodedRequests),
+            "Scan batch with trailing bytes was accepted");
+    juce::OwnedArray<juce::PluginDescription> unused;
+    require(!PluginScanProtocol::readJobResult(batch, job, unused)
+                && !PluginScanProtocol::readScanBatch(result, deadlineMs, decodedRequests),
+            "Message of the wrong type was accepted");
+
+    // A count larger than the message could hold is rejected before the
+    // reader sizes anything from it.
+    juce::MemoryBlock oversized;
+    {
+        juce::MemoryOutputStream stream(oversized, false);
+        stream.writeByte(static_cast<char>(PluginScanProtocol::MessageType::ScanBatch));
+        stream.writeCompressedInt(1000);
+        stream.writeCompressedInt(std::numeric_limits<int>::max());
+        stream.writeCompressedInt(0);
+        PluginScanProtocol::writeString(stream, "VST3");
+        PluginScanProtocol::writeString(stream, "/plugins/Fixture.vst3");
+    }
+    require(!PluginScanProtocol::readScanBatch(oversized, deadlineMs, decodedRequests),
+            "Scan batch with an impossible count was accepted");
+    juce::MemoryBlock negative;
+    {
+        juce::MemoryOutputStream stream(negative, false);
+        stream.writeByte(static_cast<char>(PluginScanProtocol::MessageType::JobResult));
+        stream.writeCompressedInt(0);
+        stream.writeCompressedInt(-1);
+    }
+    require(!PluginScanProtocol::readJobResult(negative, job, unused), "Job result with a negative count was accepted");
+
+    // A timeout report names the job and is distinct from every other reply.
+    const auto timedOut = PluginScanProtocol::createTimedOut(300);
+    require(PluginScanProtocol::readTimedOut(timedOut, job) && job == 300,
+            "Timeout report did not round-trip");
+    require(!PluginScanProtocol::readTimedOut(result, job) && !PluginScanProtocol::readTimedOut(batch, job)
+                && !PluginScanProtocol::readJobResult(timedOut, job, unused)
+                && !PluginScanProtocol::readTimedOut(juce::MemoryBlock(timedOut.getData(), 1), job),
+            "Timeout report was confused with another message");
+}
+
+void testScanDeadline()
+{
+    // Ten times the 90th percentile of successful scans, between 10 s and
+    // 120 s, once eight scans have been timed.
+    const auto deadlineFor = [](std::vector<double> durations)
+    {
+        return PluginScanPool::getAdaptiveDeadline(std::move(durations));
+    };
+    requireNear(deadlineFor({}), PluginScanPool::defaultDeadline, 0.0,
+                "Untimed scans did not use the default deadline");
+    requireNear(deadlineFor({ 5.0, 5.0, 5.0, 5.0, 5.0, 5.0, 5.0 }), PluginScanPool::defaultDeadline, 0.0,
+                "Seven timed scans already set the deadline");
+    requireNear(deadlineFor({ 8.0, 1.0, 7.0, 2.0, 6.0, 3.0, 5.0, 4.0 }), 70.0, 1.0e-9,
+                "Adaptive deadline is not ten times the 90th percentile");
+    std::vector<double> twenty;
+    for (int i = 20; i > 0; --i)
+        twenty.push_back(0.1 * i);
+    requireNear(deadlineFor(twenty), 18.0, 1.0e-9, "Adaptive deadline picked the wrong percentile");
+    requireNear(deadlineFor(std::vector<double>(8, 0.1)), PluginScanPool::minimumAdaptiveDeadline, 0.0,
+                "Adaptive deadline is below its minimum");
+    requireNear(deadlineFor(std::vector<double>(8, 20.0)), PluginScanPool::maximumAdaptiveDeadline, 0.0,
+                "Adaptive deadline is above its maximum");
+}
+
+void testTurtleGraph()
+{
+    const std::string lv2 = "http://lv2plug.in/ns/lv2core#";
+    const std::string doap = "http://usefulinc.com/ns/doap#";
+    const std::string base = "file:///plugins/delay.lv2/delay.ttl";
+    const std::string plugin = "file:///plugins/delay.lv2/plugin";
+    TurtleGraph graph;
+    require(graph.parse(R"ttl(
+        @prefix lv2: <http://lv2plug.in/ns/lv2core#> .
+        PREFIX doap: <http://usefulinc.com/ns/doap#>
+        @PREFIX xsd: <http://www.w3.org/2001/XMLSchema#> .
+        # Relative IRIs resolve against the document.
+        <plugin> a lv2:Plugin , lv2:DelayPlugin ;
+            doap:name "Verzögerung"@de-AT , "Delay" ;
+            lv2:minorVersion "2"^^xsd:integer ;
+            lv2:microVersion "5"^^<http://www.w3.org/2001/XMLSchema#integer> ;
+            doap:license </licenses/isc> ;
+            lv2:project <#project> ;
+            lv2:port [
+                a lv2:AudioPort , lv2:InputPort ;
+                lv2:index 0 ;
+                lv2:designation [ a lv2:Thing ; doap:name 'inner' ] ;
+            ] , [ a lv2:AudioPort , lv2:OutputPort ; lv2:index 1 ] ;
+            doap:description """Two
+lines""" ;
+        .
+        _:shared doap:name "shared" .
+        )ttl", base),
+            "Turtle document was rejected");
+
+    require(graph.hasType(plugin, lv2 + "Plugin") && graph.hasType(plugin, lv2 + "DelayPlugin"),
+            "Turtle relative subject or type list was not resolved");
+    require(graph.getLiteral(plugin, doap + "name") == "Verzögerung"
+                && graph.getObjects(plugin, doap + "name").size() == 2,
+            "Turtle language-tagged literal was not read");
+    require(graph.getLiteral(plugin, lv2 + "minorVersion") == "2"
+                && graph.getLiteral(plugin, lv2 + "microVersion") == "5",
+            "Turtle typed literals were not read");
+    require(graph.getLiteral(plugin, doap + "description") == "Two\nlines", "Turtle long string was not read");
+    const auto license = graph.getObjects(plugin, doap + "license");
+    const auto project = graph.getObjects(plugin, lv2 + "project");
+    require(license.size() == 1 && license[0].value == "file:///licenses/isc"
+                && project.size() == 1 && project[0].value == "file:///plugins/delay.lv2/delay.ttl#project",
+            "Turtle absolute-path or fragment IRI was not resolved");
+
+    const auto ports = graph.getObjects(plugin, lv2 + "port");
+    require(ports.size() == 2 && !ports[0].isLiteral && ports[0].value != ports[1].value,
+            "Turtle blank node list was not read");
+    require(graph.hasType(ports[0].value, lv2 + "InputPort") && graph.hasType(ports[1].value, lv2 + "OutputPort")
+                && graph.getLiteral(ports[1].value, lv2 + "index") == "1",
+            "Turtle blank node properties were not read");
+    const auto designation = graph.getObjects(ports[0].value, lv2 + "designation");
+    require(designation.size() == 1 && graph.getLiteral(designation[0].value, doap + "name") == "inner",
+            "Turtle nested blank node was not read");
+    require(graph.getSubjectsOfType(lv2 + "Plugin") == std::vector<std::string> { plugin },
+            "Turtle subjects of a type are wrong");
+
+    for (const auto* malformed : { "<plugin> a <type>",
+                                   "<plugin a <type> .",
+                                   "undeclared:plugin a <type> .",
+                                   "<plugin> <name> \"open .",
+                                   "<plugin> <port> [ <index> 0 .",
+                                   "@prefix lv2: <http://lv2plug.in/ns/lv2core#>",
+                                   "<plugin> <index> bogus ." })
+    {
+        TurtleGraph rejected;
+        require(!rejected.parse(malformed, base), "Malformed Turtle was accepted");
+    }
+
+    // Blank nodes and collections may nest maxNesting deep; deeper documents
+    // are rejected instead of recursing without bound.
+    const auto nested = [](int depth, const char* open, const char* close)
+    {
+        std::string text = "<plugin> <p> ";
+        for (int level = 0; level < depth; ++level)
+            text += std::string(open) + (open[0] == '[' ? " <p> " : " ");
+        text += "0";
+        for (int level = 0; level < depth; ++level)
+            text += std::string(" ") + close;
+        return text + " .";
+    };
+    for (const auto& [open, close] : { std::pair { "[", "]" }, std::pair { "(", ")" } })
+    {
+        TurtleGraph shallow, deep, hostile;
+        require(shallow.parse(nested(TurtleGraph::maxNesting, open, close), base),
+                "Turtle nested to the limit was rejected");
+        require(!deep.parse(nested(TurtleGraph::maxNesting + 1, open, close), base)
+                    && !hostile.parse(nested(100000, open, close), base),
+                "Turtle nested beyond the limit was accepted");
+    }
+}
+
+void testPluginMetadataReader()
+{
+    // uniqueId hashes the class ID as four big-endian longs on every
+    // platform; deprecatedUid hashes the in-memory TUID, whose first eight
+    // bytes are swapped on Windows and whose chars may be signed.
+    int uniqueId = 0, deprecatedUid = 0;
+    require(PluginMetadataReader::getVST3Ids("5653544D79506C75676953796E746831", false, uniqueId, deprecatedUid)
+                && uniqueId == 641455008 && deprecatedUid == -762640467,
+            "VST3 IDs differ from JUCE's for the plain layout");
+    require(PluginMetadataReader::getVST3Ids("5653544D79506C75676953796E746831", true, uniqueId, deprecatedUid)
+                && uniqueId == 641455008 && deprecatedUid == -1134735935,
+            "VST3 IDs differ from JUCE's for the COM layout");
+    constexpr auto signedChars = std::numeric_limits<char>::is_signed;
+    require(PluginMetadataReader::getVST3Ids("d39d5b69d6af42fa1234567890abcdef", false, uniqueId, deprecatedUid)
+                && uniqueId == -2118307096 && deprecatedUid == (signedChars ? 2125064778 : -953062582),
+            "VST3 IDs with high bytes differ from JUCE's for the plain layout");
+    require(PluginMetadataReader::getVST3Ids("d39d5b69d6af42fa1234567890abcdef", true, uniqueId, deprecatedUid)
+                && uniqueId == -2118307096 && deprecatedUid == (signedChars ? 2029503768 : -1173789672),
+            "VST3 IDs with high bytes differ from JUCE's for the COM layout");
+    require(!PluginMetadataReader::getVST3Ids("5653544D79506C75676953796E7468", false, uniqueId, deprecatedUid)
+                && !PluginMetadataReader::getVST3Ids("5653544D79506C75676953796E74683G", false, uniqueId,
+                                                     deprecatedUid),
+            "A malformed VST3 class ID was accepted");
+
+    const auto root = juce::File::getSpecialLocation(juce::File::tempDirectory)
+                          .getNonexistentChildFile("PluginMetadataReaderTest", {}, false);
+    const auto vst3 = root.getChildFile("Fixture.vst3");
+    const auto moduleInfo = vst3.getChildFile("Contents/Resources/moduleinfo.json");
+    require(moduleInfo.getParentDirectory().createDirectory()
+                && moduleInfo.replaceWithText(R"json({
+                    "Name": "Fixture",
+                    "Factory Info": { "Vendor": "Fixture Audio", "URL": "", "E-Mail": "" },
+                    "Classes": [
+                        { "CID": "5653544D79506C75676953796E746831", "Category": "Audio Module Class",
+                          "Name": "Fixture Synth", "Vendor": "", "Version": "1.2.3",
+                          "Sub Categories": [ "Instrument", "Synth" ] },
+                        { "CID": "D39D5B69D6AF42FA1234567890ABCDEF", "Category": "Audio Module Class",
+                          "Name": "Fixture Delay", "Vendor": "Other Vendor", "Version": "2.0",
+                          "Sub Categories": [ "Fx", "Delay" ] },
+                        { "CID": "00000000000000000000000000000001", "Category": "Component Controller Class",
+                          "Name": "Fixture Controller" }
+                    ]
+                })json"),
+            "VST3 metadata fixture could not be written");
+
+    juce::OwnedArray<juce::PluginDescription> vst3Results;
+    require(PluginMetadataReader::readVST3Bundle(vst3, vst3Results) && vst3Results.size() == 2,
+            "VST3 moduleinfo.json was not read");
+    const auto& synth = *vst3Results[0];
+    const auto& delay = *vst3Results[1];
+    require(synth.name == "Fixture Synth" && synth.pluginFormatName == "VST3" && synth.isInstrument
+                && synth.category == "Instrument|Synth" && synth.manufacturerName == "Fixture Audio"
+                && synth.version == "1.2.3" && synth.fileOrIdentifier == vst3.getFullPathName(),
+            "VST3 metadata description is wrong");
+    require(delay.manufacturerName == "Other Vendor" && !delay.isInstrument, "VST3 class vendor was ignored");
+    PluginMetadataReader::getVST3Ids("5653544D79506C75676953796E746831", JUCE_WINDOWS != 0,
+                                     uniqueId, deprecatedUid);
+    require(synth.uniqueId == uniqueId && synth.deprecatedUid == deprecatedUid,
+            "VST3 metadata IDs do not use the platform layout");
+
+    juce::OwnedArray<juce::PluginDescription> rejected;
+    require(moduleInfo.replaceWithText(R"json({ "Classes": [ { "CID": "1234", "Category": "Audio Module Class",
+                                                               "Name": "Broken" } ] })json")
+                && !PluginMetadataReader::readVST3Bundle(vst3, rejected)
+                && !PluginMetadataReader::readVST3Bundle(root.getChildFile("Missing.vst3"), rejected)
+                && rejected.isEmpty(),
+            "Broken VST3 metadata was accepted");
+
+    // The manifest points at the plug-in data with a relative rdfs:seeAlso.
+    const auto lv2 = root.getChildFile("Fixture Delay.lv2");
+    require(lv2.createDirectory()
+                && lv2.getChildFile("manifest.ttl").replaceWithText(R"ttl(
+                    @prefix lv2: <http://lv2plug.in/ns/lv2core#> .
+                    @prefix rdfs: <http://www.w3.org/2000/01/rdf-schema#> .
+                    <urn:fixture:delay> a lv2:Plugin ; rdfs:seeAlso <delay.ttl> .
+                    <urn:fixture:broken> a lv2:Plugin ; rdfs:seeAlso <broken.ttl> .
+                    <urn:fixture:huge> a lv2:Plugin ; rdfs:seeAlso <huge.ttl> .
+                    )ttl")
+                && lv2.getChildFile("delay.ttl").replaceWithText(R"ttl(
+                    @prefix lv2: <http://lv2plug.in/ns/lv2core#> .
+                    @prefix doap: <http://usefulinc.com/ns/doap#> .
+                    @prefix foaf: <http://xmlns.com/foaf/0.1/> .
+                    <urn:fixture:delay> a lv2:Plugin , lv2:DelayPlugin ;
+                        doap:name "Fixture Delay"@en ;
+                        doap:maintainer [ foaf:name "Fixture Audio" ] ;
+                        lv2:minorVersion 2 ; lv2:microVersion 5 ;
+                        lv2:port [ a lv2:AudioPort , lv2:InputPort ; lv2:index 0 ] ,
+                                 [ a lv2:AudioPort , lv2:OutputPort ; lv2:index 1 ] ,
+                                 [ a lv2:ControlPort , lv2:InputPort ; lv2:index 2 ] ;
+                    .
+                    )ttl")
+                && lv2.getChildFile("broken.ttl").replaceWithText("<urn:fixture:broken> <name> \"open .")
+                && lv2.getChildFile("huge.ttl").replaceWithText(
+                       "<urn:fixture:huge> <http://usefulinc.com/ns/doap#name> \"Huge\" .\n"
+                       + juce::String::repeatedString("# padding\n", 500000)),
+            "LV2 metadata fixture could not be written");
+
+    juce::OwnedArray<juce::PluginDescription> lv2Results;
+    require(PluginMetadataReader::readLV2Bundle(lv2, "urn:fixture:delay", "LV2", lv2Results)
+                && lv2Results.size() == 1,
+            "LV2 rdfs:seeAlso data was not read");
+    const auto& lv2Delay = *lv2Results[0];
+    require(lv2Delay.name == "Fixture Delay" && lv2Delay.pluginFormatName == "LV2"
+                && lv2Delay.fileOrIdentifier == "urn:fixture:delay" && lv2Delay.category == "Delay"
+                && lv2Delay.manufacturerName == "Fixture Audio" && lv2Delay.version == "2.5"
+                && lv2Delay.numInputChannels == 1 && lv2Delay.numOutputChannels == 1
+                && !lv2Delay.isInstrument,
+            "LV2 metadata description is wrong");
+    require(!PluginMetadataReader::readLV2Bundle(lv2, "urn:fixture:broken", "LV2", rejected)
+                && !PluginMetadataReader::readLV2Bundle(lv2, "urn:fixture:missing", "LV2", rejected)
+                && rejected.isEmpty(),
+            "Malformed or missing LV2 metadata was accepted");
+    require(!PluginMetadataReader::readLV2Bundle(lv2, "urn:fixture:huge", "LV2", rejected) && rejected.isEmpty(),
+            "Oversized LV2 metadata was read");
+
+    root.deleteRecursively();
+}
+
+void testLogSpectrumResampler()
+{
+    using plugin_analyzer::domain::LogSpectrumResampler;
+    constexpr double binWidth = 10.0;
+    const std::vector<float> flat(2048, 0.0f);
+    const std::vector<float> phases(2048, 1.0f);
+    std::vector<float> magnitudes, outPhases;
+
+    LogSpectrumResampler resampler;
+    resampler.prepare(256, 3);
+    require(resampler.getFrequencies().size() == 256
+                && std::abs(resampler.getFrequencies().front() - 20.0f) < 0.01f
+                && std::abs(resampler.getFrequencies().back() - 20000.0f) < 1.0f,
+            "Display points do not span 20 Hz to 20 kHz");
+    resampler.process(flat, phases, binWidth, magnitudes, outPhases);
+    require(magnitudes.size() == 256 && outPhases.size() == 256, "Display curves have the wrong size");
+    for (size_t point = 0; point < magnitudes.size(); ++point)
+    {
+        requireNear(magnitudes[point], 0.0, 1.0e-3, "Smoothing changed a flat spectrum");
+        requireNear(outPhases[point], 1.0, 1.0e-4, "Smoothing changed a constant phase");
+    }
+
+    // A +20 dB bin at 1 kHz is spread over wider windows as the fraction
+    // falls, and the average power never exceeds the spike.
+    auto spike = flat;
+    spike[100] = 20.0f;
+    const std::vector<float> noPhases;
+    auto peakFor = [&](int fraction)
+    {
+        resampler.prepare(256, fraction);
+        resampler.process(spike, noPhases, binWidth, magnitudes, outPhases);
+        require(outPhases.empty(), "Magnitude-only curves produced phases");
+        return *std::max_element(magnitudes.begin(), magnitudes.end());
+    };
+    const auto narrow = peakFor(48);
+    const auto third = peakFor(3);
+    const auto octave = peakFor(1);
+    require(narrow <= 20.0f && narrow > third && third > octave && octave > 0.0f,
+            "Fractional-octave smoothing width is not ordered");
+    requireNear(third, 10.0 * std::log10((22.0 + 100.0) / 23.0), 0.5,
+                "Third-octave average power is incorrect");
+}
+
+void testCurvePyramid()
+{
+    // A single-point spike in 1000 flat points must survive every level.
+    std::vector<float> values(1000, -60.0f);
+    values[777] = 6.0f;
+    CurvePyramid pyramid;
+    pyramid.build(values);
+    require(pyramid.getNumPoints() == 1000 && pyramid.getNumLevels() == 11,
+            "Curve pyramid has the wrong number of levels");
+    for (int level = 1; level < pyramid.getNumLevels(); ++level)
+    {
+        const auto& entries = pyramid.getLevel(level);
+        require(entries.size() == (pyramid.getLevel(level - 1).size() + 1) / 2,
+                "Curve pyramid level does not halve the point count");
+        const auto peak = std::max_element(entries.begin(), entries.end(),
+                                           [](const auto& a, const auto& b) { return a.maximum < b.maximum; });
+        require(peak->maximum == 6.0f && static_cast<size_t>(peak - entries.begin()) == (777u >> level)
+                    && peak->minimum == -60.0f,
+                "Curve pyramid lost the spike");
+    }
+    require(pyramid.chooseLevel(0.5) == 0 && pyramid.chooseLevel(1.0) == 0
+                && pyramid.chooseLevel(3.0) == 2 && pyramid.chooseLevel(1.0e6) == 10,
+            "Curve pyramid chose the wrong level");
+}
+
+void testScopeCapture()
+{
+    using plugin_analyzer::domain::ScopeCapture;
+    using plugin_analyzer::domain::ScopeSettings;
+    using plugin_analyzer::domain::ScopeTrigger;
+    // 100 Hz in a 10 ms window: one period per frame. The half-sample phase
+    // keeps every zero crossing off a sample; the right channel is inverted
+    // so both channels are checked.
+    std::vector<float> left(48000), right(48000);
+    for (size_t i = 0; i < left.size(); ++i)
+    {
+        left[i] = static_cast<float>(std::sin(juce::MathConstants<double>::twoPi * 100.0 * (i + 123.5)
+                                              / testSampleRate));
+        right[i] = -left[i];
+    }
+
+    ScopeSettings settings;
+    settings.columns = 48;
+    ScopeCapture capture;
+    auto frames = [&](double holdOff, double minimumInterval)
+    {
+        settings.holdOff = holdOff;
+        capture.prepare(testSampleRate, settings, minimumInterval);
+        const auto first = capture.getFrame().sequence;
+        capture.push(left.data(), right.data(), static_cast<int>(left.size()));
+        return capture.getFrame().sequence - first;
+    };
+
+    // Rising-edge frames start at the zero crossing wherever the block began.
+    require(frames(0.0, 0.0) == 99, "Triggered scope missed frames");
+    const auto& frame = capture.getFrame();
+    require(frame.triggered && frame.windowSamples == 480 && frame.minimumL.size() == 48,
+            "Triggered scope frame has the wrong layout");
+    require(frame.minimumL.front() >= -0.01f && frame.maximumL.front() < 0.15f
+                && frame.maximumL[12] > 0.99f && frame.minimumL[36] < -0.99f
+                && frame.maximumR[36] > 0.99f,
+            "Scope frame is not aligned to the rising edge");
+
+    settings.trigger = ScopeTrigger::Falling;
+    frames(0.0, 0.0);
+    require(frame.maximumL.front() <= 0.01f && frame.minimumL[12] < -0.99f,
+            "Scope frame is not aligned to the falling edge");
+
+    // A 5 ms hold-off skips every other period; so does the 60 Hz frame
+    // rate limit without a hold-off.
+    settings.trigger = ScopeTrigger::Rising;
+    require(frames(0.005, 0.0) == 50, "Scope hold-off was not applied");
+    require(frames(0.0, 1.0 / 60.0) == 50, "Scope frame rate was not limited");
+
+    settings.trigger = ScopeTrigger::Free;
+    settings.timeSpan = 0.5;
+    settings.columns = 1000;
+    require(frames(0.0, 0.0) == 2 && !frame.triggered && frame.minimumL.size() == 1000
+                && frame.xyLeft.size() == 2000 && frame.xyRight[10] == -frame.xyLeft[10],
+            "Free-running scope frame is wrong");
+}
+
+void testEnvelopeTracker()
+{
+    using plugin_analyzer::domain::EnvelopeTracker;
+    using plugin_analyzer::domain::HistoryRing;
+    HistoryRing<float> ring(4);
+    std::vector<float> ordered;
+    for (int value = 0; value < 6; ++value)
+        ring.push(static_cast<float>(value));
+    ring.copyTo(ordered);
+    require(ordered == std::vector<float> { 2.0f, 3.0f, 4.0f, 5.0f } && ring[0] == 2.0f,
+            "History ring did not keep the newest values in order");
+
+    // Linear attack over 100 points and release over 200 points, 1 ms apart,
+    // in a ring too small to hold the whole event.
+    EnvelopeTracker tracker(128);
+    auto time = 0.0f;
+    const auto push = [&tracker, &time](float value)
+    {
+        tracker.push(time, value);
+        time += 0.001f;
+    };
+    for (int i = 0; i <= 100; ++i)
+        push(static_cast<float>(i) / 100.0f);
+    for (int i = 0; i < 50; ++i)
+        push(1.0f);
+    for (int i = 1; i <= 200; ++i)
+        push(1.0f - static_cast<float>(i) / 200.0f);
+    requireNear(tracker.getAttackTime(), 0.080, 0.0015, "Envelope attack time is wrong");
+    requireNear(tracker.getReleaseTime(), 0.160, 0.0015, "Envelope release time is wrong");
+
+    plugin_analyzer::domain::EnvelopeData envelope;
+    tracker.copyTo(envelope);
+    require(envelope.envelopeValues.size() == 128 && envelope.timePoints.size() == 128
+                && envelope.timePoints.back() > envelope.timePoints.front(),
+            "Envelope history was not published in time order");
+}
+
+void testLatencyHistogram()
+{
+    using plugin_analyzer::domain::LatencyHistogram;
+    LatencyHistogram histogram;
+    // 100k blocks at 1.000..1.999 ms plus one 40 ms dropout.
+    for (int block = 0; block < 100000; ++block)
+        histogram.record(1.0 + (block % 1000) * 0.001, false);
+    histogram.record(40.0, true);
+    requireNear(histogram.getPercentile(0.5), 1.5, 1.5 * 0.03, "Histogram p50 is outside tolerance");
+    requireNear(histogram.getPercentile(0.99), 1.99, 1.99 * 0.03, "Histogram p99 is outside tolerance");
+    requireNear(histogram.getMax(), 40.0, 1.0e-9, "Histogram lost the exact maximum");
+    require(histogram.getCount() == 100001 && histogram.getMissCount() == 1,
+            "Histogram block or deadline-miss count is wrong");
+
+    LatencyHistogram windowed(1000);
+    windowed.record(40.0, true);
+    for (int block = 0; block < 1000; ++block)
+        windowed.record(0.010, false);
+    require(windowed.getCount() == 1000 && windowed.getMissCount() == 0,
+            "Histogram window did not evict the oldest block");
+    requireNear(windowed.getMax(), 0.010, 0.010 * 0.04, "Histogram window kept an evicted maximum");
+}
+
+void testBlockTimer()
+{
+    // Spinning is all CPU time; sleeping is almost all off-CPU time and
+    // yields the thread voluntarily.
+    const auto spinStart = BlockTimer::readThread();
+    auto spinEnd = spinStart;
+    volatile double sink = 0.0;
+    while (spinEnd.wallNanoseconds - spinStart.wallNanoseconds < 20000000)
+    {
+        for (int i = 0; i < 1000; ++i)
+            sink = sink + std::sqrt(static_cast<double>(i));
+        spinEnd = BlockTimer::readThread();
+    }
+    const auto sleepStart = BlockTimer::readThread();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    const auto sleepEnd = BlockTimer::readThread();
+
+    require(sleepEnd.wallNanoseconds - sleepStart.wallNanoseconds >= 19000000,
+            "Block timer wall clock is not in nanoseconds");
+    if (BlockTimer::hasThreadCpuTime())
+    {
+        require(spinEnd.cpuNanoseconds - spinStart.cpuNanoseconds > 5000000,
+                "Block timer missed CPU time spent spinning");
+        require(sleepEnd.cpuNanoseconds - sleepStart.cpuNanoseconds < 5000000,
+                "Block timer counted sleeping as CPU time");
+    }
+    if (BlockTimer::hasContextSwitches())
+        require(sleepEnd.voluntarySwitches > sleepStart.voluntarySwitches,
+                "Block timer missed the voluntary context switch of a sleep");
+
+    // The averages cover the same window of blocks as the percentiles.
+    constexpr size_t window = 8;
+    AnalyzerEngine engine;
+    engine.prepare(testSampleRate, testBlockSize);
+    engine.setNonRealtime(true);
+    engine.setPerformanceWindow(window);
+    require(engine.loadProcessor(std::make_unique<FakeProcessor>(FakeProcessor::Kind::Gain, 1.0f)),
+            "Performance processor could not be loaded");
+    engine.setAnalysisMode(AnalyzerEngine::AnalysisMode::Performance);
+    engine.renderOffline(testBlockSize * 40);
+    require(engine.waitForAnalysisIdle(5000), "Performance records did not drain");
+    const auto& performance = engine.getAnalysisSnapshot()->performance;
+    const auto& history = performance.processingTimeHistory;
+    require(performance.measuredBlocks == window && history.size() >= window,
+            "Performance window holds the wrong number of blocks");
+    const auto windowSum = std::accumulate(history.end() - static_cast<std::ptrdiff_t>(window), history.end(), 0.0);
+    requireNear(performance.averageProcessingTime, windowSum / window, 1.0e-4 + windowSum / window * 1.0e-4,
+                "Average processing time does not cover the histogram window");
+    require(performance.averageProcessingTime <= performance.peakProcessingTime * 1.04f,
+            "Average processing time exceeds the windowed maximum");
+}
+
+void testSnapshotPublishing()
+{
+    RecyclingPool<int, int> pool(2);
+    auto& first = pool.acquire();
+    std::shared_ptr<const int> held = first.value;
+    auto& second = pool.acquire();
+    require(second.value != first.value, "Recycling pool reused a slot that is still referenced");
+    require(&pool.acquire() == &second && pool.getCapacity() == 2,
+            "Recycling pool did not reuse a released slot");
+    std::shared_ptr<const int> alsoHeld = second.value;
+    pool.acquire();
+    require(pool.getCapacity() == 3, "Recycling pool did not grow while every slot was referenced");
+
+    AnalyzerEngine engine;
+    engine.prepare(testSampleRate, testBlockSize);
+    engine.setNonRealtime(true);
+    engine.setAnalysisMode(AnalyzerEngine::AnalysisMode::Harmonic);
+    engine.renderOffline(engine.getFFTSize() * 2);
+    const auto kept = engine.getAnalysisSnapshot();
+    const auto keptFrames = kept->frameCount;
+    const auto keptSpectrum = kept->magnitudeSpectrumL;
+
+    // Once readers let go, publishing cycles through a few recycled snapshots.
+    std::set<const AnalyzerEngine::AnalysisSnapshot*> published;
+    engine.setTestFrequency(3000.0);
+    for (int frame = 0; frame < 24; ++frame)
+    {
+        engine.renderOffline(engine.getFFTSize());
+        published.insert(engine.getAnalysisSnapshot().get());
+    }
+    require(published.size() <= 8, "Snapshot publishing did not recycle snapshots");
+    require(kept->frameCount == keptFrames && kept->magnitudeSpectrumL == keptSpectrum,
+            "A recycled snapshot was modified while a reader held it");
+    require(engine.getAnalysisSnapshot()->frameCount > 0
+                && engine.getAnalysisSnapshot()->magnitudeSpectrumL != keptSpectrum,
+            "Recycled snapshot did not receive the new spectrum");
+
+    // Every publication is numbered; the display version only moves when the
+    // display spectrum does.
+    const auto latest = engine.getAnalysisSnapshot();
+    require(latest->sequence == engine.getSnapshotSequence() && latest->sequence > kept->sequence
+                && latest->display.version > kept->display.version,
+            "Snapshot sequence numbers did not advance");
+    engine.setNonRealtime(false);
+    processBlocks(engine, 4);
+    engine.waitForAnalysisIdle();
+    require(engine.getSnapshotSequence() > latest->sequence
+                && engine.getAnalysisSnapshot()->display.version == latest->display.version,
+            "A scope-only publication changed the display version");
+}
+
 void testFifoAndSmoke()
 {
     AnalyzerEngine engine;
     engine.prepare(testSampleRate, testBlockSize);
-    std::array<float, 512> source {};
-    std::array<float, 512> destination {};
-    for (size_t i = 0; i < source.size(); ++i)
-        source[i] = static_cast<float>(i);
-    engine.addToScopeFifo(source.data(), static_cast<int>(source.size()));
-    require(engine.readFromScopeFifo(destination.data(), 512) == 512,
-            "Scope FIFO returned the wrong sample count");
-    require(std::equal(source.begin(), source.end(), destination.begin()),
-            "Scope FIFO changed sample order");
+    plugin_analyzer::domain::ScopeSettings scopeSettings;
+    scopeSettings.trigger = plugin_analyzer::domain::ScopeTrigger::Free;
+    scopeSettings.columns = 100;
+    engine.setScopeSettings(scopeSettings);
+    processBlocks(engine, 20);
+    require(waitFor([&engine] { return engine.getAnalysisSnapshot()->scope.sequence > 0; }),
+            "Scope did not publish a frame");
+    const auto scope = engine.getAnalysisSnapshot()->scope;
+    require(scope.windowSamples == 480 && scope.minimumL.size() == 100 && scope.maximumR.size() == 100
+                && scope.xyLeft.size() == 480 && !scope.triggered,
+            "Scope frame has the wrong layout");
 
     for (int mode = static_cast<int>(AnalyzerEngine::AnalysisMode::Linear);
          mode <= static_cast<int>(AnalyzerEngine::AnalysisMode::Performance); ++mode)
@@ -360,6 +1597,29 @@ void testFifoAndSmoke()
     engine.releaseResources();
 }
 
+void testAnalysisTagOverflow()
+{
+    // Small blocks run out of tag slots long before the sample rings fill.
+    constexpr int blockSize = 16;
+    constexpr int blocks = 4096;
+    AnalyzerEngine engine;
+    engine.prepare(testSampleRate, blockSize);
+    engine.setFFTOrder(AnalyzerEngine::minFFTOrder);
+    engine.setAnalysisMode(AnalyzerEngine::AnalysisMode::WhiteNoise);
+    engine.suspendAnalysis();
+    processBlocks(engine, blocks, blockSize);
+    engine.resumeAnalysis();
+    require(engine.waitForAnalysisIdle(5000), "Queued blocks left samples without a tag");
+
+    const auto snapshot = engine.getAnalysisSnapshot();
+    const auto dropped = snapshot->performance.droppedAnalysisSamples;
+    const auto queued = static_cast<uint64_t>(blocks * blockSize) - dropped;
+    require(dropped > 0 && dropped % blockSize == 0,
+            "A full tag FIFO should drop and count whole blocks");
+    require(snapshot->frameCount == queued / static_cast<uint64_t>(engine.getFFTSize()),
+            "The worker analysed samples outside the tagged blocks");
+}
+
 void testAnalysisSessionPresentationPolicy()
 {
     using plugin_analyzer::application::AnalysisSession;
@@ -375,12 +1635,17 @@ void testAnalysisSessionPresentationPolicy()
         AnalysisMode getAnalysisMode() const override { return mode; }
         void setInputAmplitude(float) override {}
         void setTestFrequency(double) override {}
+        void setDisplayResolution(int) override {}
+        void setSpectrumSmoothing(int) override {}
+        void setScopeSettings(const plugin_analyzer::domain::ScopeSettings&) override {}
         std::shared_ptr<const AnalysisSnapshot> getAnalysisSnapshot() const override
         {
             return std::make_shared<const AnalysisSnapshot>();
         }
+        std::uint64_t getSnapshotSequence() const override { return 0; }
+        void addSnapshotListener(plugin_analyzer::application::SnapshotListener*) override {}
+        void removeSnapshotListener(plugin_analyzer::application::SnapshotListener*) override {}
         std::string getPluginDisplayName() const override { return {}; }
-        int readFromScopeFifo(float*, int) override { return 0; }
 
         AnalysisMode mode = AnalysisMode::Linear;
     };
@@ -401,6 +1666,8 @@ void testAnalysisSessionPresentationPolicy()
             "Oscilloscope tab should use the scope view");
 
     const auto performance = AnalysisSession::selectionForTab(9);
+    require(harmonic.controls.smoothing && !scope.controls.smoothing,
+            "Smoothing control visibility is incorrect");
     require(performance.controls.performance && !performance.controls.phase,
             "Performance analysis controls are incorrect");
 
@@ -451,7 +1718,29 @@ int main(int argc, char** argv)
         testFakeProcessors();
         testLinearFFTAndLifecycle();
         testDistortionMeasurements();
+        testOfflineRendering();
+        testLowFrequencyTHD();
+        testHarmonicTracking();
+        testHighResolutionFFT();
+        testSpectrumKernels();
+        testFFTBackends();
+        testHammersteinSweep();
+        testMultitoneDistortion();
+        testBatchAnalysis();
+        testPluginScanIndex();
+        testPluginScanProtocol();
+        testScanDeadline();
+        testTurtleGraph();
+        testPluginMetadataReader();
+        testLogSpectrumResampler();
+        testCurvePyramid();
+        testScopeCapture();
+        testEnvelopeTracker();
+        testLatencyHistogram();
+        testBlockTimer();
+        testSnapshotPublishing();
         testFifoAndSmoke();
+        testAnalysisTagOverflow();
         testAnalysisSessionPresentationPolicy();
         std::cout << "PluginAnalyzer Phase 6 tests passed\n";
         return 0;
@@ -0,0 +1,54 @@
+#include <JuceHeader.h>
+#include "../Source/FFTBackend.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+// Times one real forward FFT per backend and order. Each transform runs on a
+// fresh copy of the same noise so every backend sees identical input.
+int main(int argc, char** argv)
+{
+    const auto minimumSeconds = argc > 1 ? juce::String(argv[1]).getDoubleValue() : 0.2;
+    constexpr FFTBackend::Kind kinds[] { FFTBackend::Kind::Juce, FFTBackend::Kind::Stockham,
+                                         FFTBackend::Kind::FFTW };
+
+    std::printf("%-6s", "order");
+    for (const auto kind : kinds)
+        if (FFTBackend::isAvailable(kind))
+            std::printf("%14s", FFTBackend::getKindName(kind));
+    std::printf("   (ns per transform)\n");
+
+    juce::Random random(1);
+    for (int order = 8; order <= FFTPlanCache::maxOrder; ++order)
+    {
+        const auto size = 1 << order;
+        std::vector<float> input(static_cast<size_t>(size * 2), 0.0f);
+        for (int i = 0; i < size; ++i)
+            input[static_cast<size_t>(i)] = random.nextFloat() * 2.0f - 1.0f;
+        std::vector<float> data(input.size());
+
+        std::printf("%-6d", order);
+        for (const auto kind : kinds)
+        {
+            if (!FFTBackend::isAvailable(kind))
+                continue;
+            const auto fft = FFTBackend::create(kind, order);
+            using Clock = std::chrono::steady_clock;
+            long long iterations = 0;
+            Clock::duration elapsed {};
+            while (std::chrono::duration<double>(elapsed).count() < minimumSeconds)
+            {
+                std::copy(input.begin(), input.end(), data.begin());
+                const auto start = Clock::now();
+                fft->performRealForward(data.data());
+                elapsed += Clock::now() - start;
+                ++iterations;
+            }
+            const auto nanoseconds = std::chrono::duration<double, std::nano>(elapsed).count();
+            std::printf("%14.0f", nanoseconds / static_cast<double>(iterations));
+        }
+        std::printf("\n");
+    }
+    return 0;
+}